@@ -0,0 +1,192 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "batchexporter.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QProcess>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+using namespace Qt::StringLiterals;
+
+class BatchExporter::Private
+{
+public:
+    Private(BatchExporter *parent);
+
+    void startNext();
+    void processFinished(QProcess *process, int index);
+    QStringList outputs(const QStringList &fileNames) const;
+
+private:
+    BatchExporter *q;
+
+public:
+    QByteArray key;
+    QString outputDirectory = u"."_s;
+    QStringList hints;
+    int jobs = QThread::idealThreadCount();
+    int timeout = 0;
+    bool quiet = false;
+
+    QStringList fileNames;
+    QStringList outputPaths;
+    QList<ExportResult> results;
+    QList<QElapsedTimer> timers;
+    int next = 0;
+    int running = 0;
+    int done = 0;
+};
+
+BatchExporter::Private::Private(BatchExporter *parent)
+    : q(parent)
+{}
+
+QStringList BatchExporter::Private::outputs(const QStringList &fileNames) const
+{
+    // <output directory>/<base name>, numbered when base names collide
+    QStringList ret;
+    QHash<QString, int> used;
+    const QDir dir(outputDirectory);
+    for (const auto &fileName : fileNames) {
+        const QString baseName = QFileInfo(fileName).completeBaseName();
+        const int count = used[baseName]++;
+        ret.append(dir.absoluteFilePath(count == 0 ? baseName : u"%1-%2"_s.arg(baseName).arg(count + 1)));
+    }
+    return ret;
+}
+
+void BatchExporter::Private::startNext()
+{
+    while (running < jobs && next < fileNames.size()) {
+        const int index = next++;
+        running++;
+
+        QStringList arguments { u"--worker"_s, u"--exporter"_s, QString::fromLatin1(key), u"--output"_s, outputPaths.at(index) };
+        for (const auto &hint : hints)
+            arguments << u"--hint"_s << hint;
+        arguments << fileNames.at(index);
+
+        auto *process = new QProcess(q);
+        process->setProcessChannelMode(quiet ? QProcess::SeparateChannels : QProcess::ForwardedErrorChannel);
+        if (quiet)
+            process->setStandardErrorFile(QProcess::nullDevice());
+
+        timers[index].start();
+        QObject::connect(process, &QProcess::finished, q, [this, process, index]() {
+            processFinished(process, index);
+        });
+        QObject::connect(process, &QProcess::errorOccurred, q, [this, process, index](QProcess::ProcessError error) {
+            // finished() is not emitted if the process could not start
+            if (error == QProcess::FailedToStart)
+                processFinished(process, index);
+        });
+        if (timeout > 0) {
+            QTimer::singleShot(timeout, process, [process]() {
+                process->setProperty("timedOut", true);
+                process->kill();
+            });
+        }
+        process->start(QCoreApplication::applicationFilePath(), arguments);
+    }
+}
+
+void BatchExporter::Private::processFinished(QProcess *process, int index)
+{
+    auto &result = results[index];
+    bool reported = false;
+    const auto lines = process->readAllStandardOutput().split('\n');
+    for (const auto &line : lines) {
+        if (!line.startsWith(ResultPrefix))
+            continue;
+        result = ExportResult::fromJson(QJsonDocument::fromJson(line.mid(ResultPrefix.size())).object());
+        reported = true;
+    }
+    result.fileName = fileNames.at(index);
+    result.wallTime = timers.at(index).elapsed();
+    if (process->property("timedOut").toBool()) {
+        result.ok = false;
+        result.errorMessage = u"timed out after %1 ms"_s.arg(timeout);
+    } else if (process->error() == QProcess::FailedToStart) {
+        result.ok = false;
+        result.errorMessage = process->errorString();
+    } else if (process->exitStatus() == QProcess::CrashExit) {
+        result.ok = false;
+        result.errorMessage = u"worker crashed"_s;
+    } else if (!reported) {
+        result.ok = false;
+        result.errorMessage = u"worker exited with %1 without a result"_s.arg(process->exitCode());
+    }
+    process->deleteLater();
+
+    running--;
+    done++;
+    emit q->resultReady(result, done, fileNames.size());
+    if (done == fileNames.size())
+        emit q->finished();
+    else
+        startNext();
+}
+
+BatchExporter::BatchExporter(QObject *parent)
+    : QObject(parent)
+    , d(new Private(this))
+{}
+
+BatchExporter::~BatchExporter() = default;
+
+void BatchExporter::setExporter(const QByteArray &key)
+{
+    d->key = key;
+}
+
+void BatchExporter::setOutputDirectory(const QString &directory)
+{
+    d->outputDirectory = directory;
+}
+
+void BatchExporter::setHints(const QStringList &hints)
+{
+    d->hints = hints;
+}
+
+void BatchExporter::setJobs(int jobs)
+{
+    d->jobs = qMax(1, jobs);
+}
+
+void BatchExporter::setTimeout(int timeout)
+{
+    d->timeout = timeout;
+}
+
+void BatchExporter::setQuiet(bool quiet)
+{
+    d->quiet = quiet;
+}
+
+void BatchExporter::start(const QStringList &fileNames)
+{
+    d->fileNames = fileNames;
+    d->outputPaths = d->outputs(fileNames);
+    d->results = QList<ExportResult>(fileNames.size());
+    d->timers = QList<QElapsedTimer>(fileNames.size());
+    d->next = 0;
+    d->running = 0;
+    d->done = 0;
+    if (fileNames.isEmpty()) {
+        QTimer::singleShot(0, this, &BatchExporter::finished);
+        return;
+    }
+    d->startNext();
+}
+
+QList<ExportResult> BatchExporter::results() const
+{
+    return d->results;
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef BATCHEXPORTER_H
+#define BATCHEXPORTER_H
+
+#include "worker.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
+
+// Exports files in worker processes, jobs of them at a time. Exporter
+// plugins keep per-export state, so each file is exported by its own process,
+// which also keeps a crash or a leak in one file from affecting the others.
+class BatchExporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BatchExporter(QObject *parent = nullptr);
+    ~BatchExporter() override;
+
+    void setExporter(const QByteArray &key);
+    void setOutputDirectory(const QString &directory);
+    void setHints(const QStringList &hints);
+    void setJobs(int jobs);
+    // milliseconds, 0 means no timeout
+    void setTimeout(int timeout);
+    void setQuiet(bool quiet);
+
+    // starts exporting fileNames, finished() is emitted when all are done
+    void start(const QStringList &fileNames);
+
+    QList<ExportResult> results() const;
+
+Q_SIGNALS:
+    void resultReady(const ExportResult &result, int done, int total);
+    void finished();
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+#endif // BATCHEXPORTER_H
@@ -0,0 +1,263 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "batchexporter.h"
+#include "worker.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtGui/QGuiApplication>
+#include <QtPsdExporter/QPsdExporterPlugin>
+
+#include <cstdio>
+
+using namespace Qt::StringLiterals;
+
+namespace {
+
+enum ExitCode {
+    Success = 0,
+    ExportFailed = 1,
+    UsageError = 2,
+};
+
+QString seconds(qint64 milliseconds)
+{
+    return QString::number(milliseconds / 1000.0, 'f', 2);
+}
+
+QString mebibytes(qint64 bytes)
+{
+    return bytes < 0 ? u"?"_s : QString::number(bytes / (1024.0 * 1024.0), 'f', 1);
+}
+
+// expands directories and wildcards in arguments to .psd files
+QStringList collectFiles(const QStringList &arguments, bool recursive)
+{
+    QStringList ret;
+    const QStringList psdFilter { u"*.psd"_s };
+    for (const auto &argument : arguments) {
+        const QFileInfo info(argument);
+        if (info.isDir()) {
+            QDirIterator it(argument, psdFilter, QDir::Files, recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+            QStringList files;
+            while (it.hasNext())
+                files.append(it.next());
+            files.sort();
+            ret.append(files);
+        } else if (argument.contains(u'*') || argument.contains(u'?') || argument.contains(u'[')) {
+            const QDir dir = info.absoluteDir();
+            const auto entries = dir.entryList({ info.fileName() }, QDir::Files, QDir::Name);
+            for (const auto &entry : entries)
+                ret.append(dir.filePath(entry));
+        } else {
+            ret.append(argument);
+        }
+    }
+    return ret;
+}
+
+QStringList readFileList(const QString &fileName, QString *errorMessage)
+{
+    QFile file;
+    if (fileName == "-"_L1) {
+        if (!file.open(stdin, QIODevice::ReadOnly | QIODevice::Text)) {
+            *errorMessage = file.errorString();
+            return {};
+        }
+    } else {
+        file.setFileName(fileName);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            *errorMessage = u"%1: %2"_s.arg(fileName, file.errorString());
+            return {};
+        }
+    }
+    QStringList ret;
+    QTextStream stream(&file);
+    QString line;
+    while (stream.readLineInto(&line)) {
+        line = line.trimmed();
+        if (!line.isEmpty() && !line.startsWith(u'#'))
+            ret.append(line);
+    }
+    return ret;
+}
+
+int runWorker(const QCommandLineParser &parser)
+{
+    QString errorMessage;
+    const auto hints = parseHints(parser.values(u"hint"_s), &errorMessage);
+    const auto positional = parser.positionalArguments();
+
+    ExportResult result;
+    if (positional.size() != 1) {
+        result.errorMessage = u"a worker exports exactly one file"_s;
+    } else if (!errorMessage.isEmpty()) {
+        result.fileName = positional.first();
+        result.errorMessage = errorMessage;
+    } else {
+        result = exportFile(positional.first(), parser.value(u"exporter"_s).toLatin1(), parser.value(u"output"_s), hints);
+    }
+    result.peakMemory = peakMemoryUsage();
+
+    QTextStream out(stdout);
+    out << ResultPrefix.toByteArray() << QJsonDocument(result.toJson()).toJson(QJsonDocument::Compact) << Qt::endl;
+    return result.ok ? Success : ExportFailed;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // workers lay out text, which needs the font database of QGuiApplication,
+    // the driver only starts processes
+    bool worker = false;
+    for (int i = 1; i < argc; i++) {
+        if (qstrcmp(argv[i], "--worker") == 0)
+            worker = true;
+    }
+    QScopedPointer<QCoreApplication> app;
+    if (worker) {
+        if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        app.reset(new QGuiApplication(argc, argv));
+    } else {
+        app.reset(new QCoreApplication(argc, argv));
+    }
+    QCoreApplication::setApplicationName(u"psdexportercli"_s);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Exports PSD files with a psdexporter plugin, several at a time."_s);
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"files"_s, u"PSD files, directories or wildcards to export."_s, u"[files...]"_s);
+
+    const QCommandLineOption exporterOption({ u"e"_s, u"exporter"_s }, u"Exporter plugin to use, see --list-exporters."_s, u"key"_s);
+    const QCommandLineOption outputOption({ u"o"_s, u"output"_s }, u"Directory to export to, defaults to the current directory. Each file is exported to <directory>/<base name>."_s, u"directory"_s, u"."_s);
+    const QCommandLineOption hintOption({ u"H"_s, u"hint"_s }, u"Overrides an export hint, e.g. resolution=1920x1080 or makeCompact=true. Can be given several times."_s, u"name=value"_s);
+    const QCommandLineOption jobsOption({ u"j"_s, u"jobs"_s }, u"Number of files exported at the same time, defaults to the number of cores."_s, u"count"_s, QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption fileListOption({ u"l"_s, u"file-list"_s }, u"Reads the files to export from a file, one per line, - for stdin."_s, u"file"_s);
+    const QCommandLineOption recursiveOption({ u"r"_s, u"recursive"_s }, u"Looks for PSD files in subdirectories of the given directories."_s);
+    const QCommandLineOption timeoutOption(u"timeout"_s, u"Fails files that take longer than this to export."_s, u"seconds"_s);
+    const QCommandLineOption reportOption(u"report"_s, u"Writes the results as JSON to a file."_s, u"file"_s);
+    const QCommandLineOption quietOption({ u"q"_s, u"quiet"_s }, u"Discards the messages of the exporters."_s);
+    const QCommandLineOption listOption(u"list-exporters"_s, u"Lists the available exporters and exits."_s);
+    QCommandLineOption workerOption(u"worker"_s, u"Exports a single file and reports the result."_s);
+    workerOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOptions({ exporterOption, outputOption, hintOption, jobsOption, fileListOption, recursiveOption,
+                        timeoutOption, reportOption, quietOption, listOption, workerOption });
+    parser.process(*app);
+
+    if (parser.isSet(workerOption))
+        return runWorker(parser);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (parser.isSet(listOption)) {
+        for (const auto &key : QPsdExporterPlugin::keys())
+            out << key << Qt::endl;
+        return Success;
+    }
+
+    const QByteArray key = parser.value(exporterOption).toLatin1();
+    if (key.isEmpty() || !QPsdExporterPlugin::keys().contains(key)) {
+        err << "Specify an exporter with --exporter, one of: " << QPsdExporterPlugin::keys().join(", ") << Qt::endl;
+        return UsageError;
+    }
+
+    QString errorMessage;
+    parseHints(parser.values(hintOption), &errorMessage);
+    if (!errorMessage.isEmpty()) {
+        err << errorMessage << Qt::endl;
+        return UsageError;
+    }
+
+    bool ok = true;
+    const int jobs = parser.value(jobsOption).toInt(&ok);
+    if (!ok || jobs < 1) {
+        err << "Invalid number of jobs " << parser.value(jobsOption) << Qt::endl;
+        return UsageError;
+    }
+    int timeout = 0;
+    if (parser.isSet(timeoutOption)) {
+        const double value = parser.value(timeoutOption).toDouble(&ok);
+        if (!ok || value <= 0) {
+            err << "Invalid timeout " << parser.value(timeoutOption) << Qt::endl;
+            return UsageError;
+        }
+        timeout = qRound(value * 1000);
+    }
+
+    QStringList arguments = parser.positionalArguments();
+    if (parser.isSet(fileListOption)) {
+        arguments.append(readFileList(parser.value(fileListOption), &errorMessage));
+        if (!errorMessage.isEmpty()) {
+            err << errorMessage << Qt::endl;
+            return UsageError;
+        }
+    }
+    const QStringList fileNames = collectFiles(arguments, parser.isSet(recursiveOption));
+    if (fileNames.isEmpty()) {
+        err << "No PSD files to export" << Qt::endl;
+        return UsageError;
+    }
+
+    BatchExporter exporter;
+    exporter.setExporter(key);
+    exporter.setOutputDirectory(parser.value(outputOption));
+    exporter.setHints(parser.values(hintOption));
+    exporter.setJobs(jobs);
+    exporter.setTimeout(timeout);
+    exporter.setQuiet(parser.isSet(quietOption));
+
+    const int width = QString::number(fileNames.size()).size();
+    QObject::connect(&exporter, &BatchExporter::resultReady, app.data(), [&](const ExportResult &result, int done, int total) {
+        out << u"[%1/%2] "_s.arg(done, width).arg(total)
+            << (result.ok ? "ok    " : "FAILED")
+            << "  load " << seconds(result.loadTime) << " s"
+            << "  export " << seconds(result.exportTime) << " s"
+            << "  wall " << seconds(result.wallTime) << " s"
+            << "  peak " << mebibytes(result.peakMemory) << " MiB  "
+            << result.fileName;
+        if (!result.ok)
+            out << ": " << result.errorMessage;
+        out << Qt::endl;
+    });
+    QObject::connect(&exporter, &BatchExporter::finished, app.data(), &QCoreApplication::quit);
+
+    QElapsedTimer timer;
+    timer.start();
+    exporter.start(fileNames);
+    app->exec();
+
+    const auto results = exporter.results();
+    int failed = 0;
+    qint64 peakMemory = -1;
+    for (const auto &result : results) {
+        if (!result.ok)
+            failed++;
+        peakMemory = qMax(peakMemory, result.peakMemory);
+    }
+    out << results.size() << " files, " << failed << " failed in " << seconds(timer.elapsed()) << " s"
+        << " with " << jobs << " jobs, largest peak " << mebibytes(peakMemory) << " MiB" << Qt::endl;
+
+    if (parser.isSet(reportOption)) {
+        QJsonArray array;
+        for (const auto &result : results)
+            array.append(result.toJson());
+        QFile report(parser.value(reportOption));
+        if (!report.open(QIODevice::WriteOnly) || report.write(QJsonDocument(array).toJson()) < 0) {
+            err << "Failed to write " << report.fileName() << ": " << report.errorString() << Qt::endl;
+            return ExportFailed;
+        }
+    }
+
+    return failed > 0 ? ExportFailed : Success;
+}
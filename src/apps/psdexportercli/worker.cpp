@@ -0,0 +1,162 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "worker.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSize>
+#include <QtPsdExporter/QPsdExporterPlugin>
+#include <QtPsdExporter/QPsdExporterTreeItemModel>
+#include <QtPsdGui/QPsdGuiLayerTreeItemModel>
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+using namespace Qt::StringLiterals;
+
+QJsonObject ExportResult::toJson() const
+{
+    QJsonObject ret;
+    ret.insert("file"_L1, fileName);
+    ret.insert("output"_L1, output);
+    ret.insert("ok"_L1, ok);
+    if (!errorMessage.isEmpty())
+        ret.insert("error"_L1, errorMessage);
+    ret.insert("loadTime"_L1, loadTime);
+    ret.insert("exportTime"_L1, exportTime);
+    ret.insert("wallTime"_L1, wallTime);
+    ret.insert("peakMemory"_L1, peakMemory);
+    return ret;
+}
+
+ExportResult ExportResult::fromJson(const QJsonObject &object)
+{
+    ExportResult ret;
+    ret.fileName = object.value("file"_L1).toString();
+    ret.output = object.value("output"_L1).toString();
+    ret.ok = object.value("ok"_L1).toBool();
+    ret.errorMessage = object.value("error"_L1).toString();
+    ret.loadTime = object.value("loadTime"_L1).toInteger();
+    ret.exportTime = object.value("exportTime"_L1).toInteger();
+    ret.wallTime = object.value("wallTime"_L1).toInteger();
+    ret.peakMemory = object.value("peakMemory"_L1).toInteger(-1);
+    return ret;
+}
+
+QVariantMap parseHints(const QStringList &hints, QString *errorMessage)
+{
+    static const QRegularExpression sizePattern(u"^(\\d+)x(\\d+)$"_s);
+    QVariantMap ret;
+    for (const auto &hint : hints) {
+        const auto pos = hint.indexOf('='_L1);
+        if (pos < 1) {
+            *errorMessage = u"invalid hint %1, expected name=value"_s.arg(hint);
+            return {};
+        }
+        const auto name = hint.left(pos);
+        const auto value = hint.mid(pos + 1);
+        bool ok = false;
+        if (value == "true"_L1 || value == "false"_L1) {
+            ret.insert(name, value == "true"_L1);
+            continue;
+        }
+        if (const auto match = sizePattern.match(value); match.hasMatch()) {
+            ret.insert(name, QSize(match.captured(1).toInt(), match.captured(2).toInt()));
+            continue;
+        }
+        if (const int i = value.toInt(&ok); ok) {
+            ret.insert(name, i);
+            continue;
+        }
+        if (const double d = value.toDouble(&ok); ok) {
+            ret.insert(name, d);
+            continue;
+        }
+        ret.insert(name, value);
+    }
+    return ret;
+}
+
+qint64 peakMemoryUsage()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize);
+    return -1;
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#  if defined(Q_OS_DARWIN)
+    return qint64(usage.ru_maxrss);
+#  else
+    return qint64(usage.ru_maxrss) * 1024;
+#  endif
+#else
+    return -1;
+#endif
+}
+
+ExportResult exportFile(const QString &fileName, const QByteArray &exporterKey, const QString &output, const QVariantMap &hints)
+{
+    ExportResult ret;
+    ret.fileName = fileName;
+
+    auto *exporter = QPsdExporterPlugin::plugin(exporterKey);
+    if (!exporter) {
+        ret.errorMessage = u"unknown exporter %1"_s.arg(QString::fromLatin1(exporterKey));
+        return ret;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QPsdGuiLayerTreeItemModel guiModel;
+    QPsdExporterTreeItemModel model;
+    model.setSourceModel(&guiModel);
+    model.load(fileName);
+    ret.loadTime = timer.restart();
+    if (!model.errorMessage().isEmpty()) {
+        ret.errorMessage = model.errorMessage();
+        return ret;
+    }
+
+    // the hint saved by the GUI for this document, then the command line
+    QVariantMap hint = model.exportHint(QString::fromLatin1(exporterKey));
+    if (!hint.value("resolution"_L1).toSize().isValid()) {
+        const QSize size(hint.value("width"_L1).toInt(), hint.value("height"_L1).toInt());
+        hint.insert("resolution"_L1, size.isEmpty() ? model.size() : size);
+    }
+    if (!hint.contains("fontScaleFactor"_L1))
+        hint.insert("fontScaleFactor"_L1, 1.0);
+    if (!hint.contains("imageScaling"_L1))
+        hint.insert("imageScaling"_L1, false);
+    if (!hint.contains("makeCompact"_L1))
+        hint.insert("makeCompact"_L1, false);
+    hint.insert(hints);
+
+    switch (exporter->exportType()) {
+    case QPsdExporterPlugin::File: {
+        const auto suffixes = exporter->filters().values();
+        ret.output = output + (suffixes.isEmpty() ? QString() : suffixes.first());
+        QDir().mkpath(QFileInfo(ret.output).absolutePath());
+        break; }
+    case QPsdExporterPlugin::Directory:
+        ret.output = output;
+        QDir().mkpath(ret.output);
+        break;
+    }
+
+    ret.ok = exporter->exportTo(&model, ret.output, hint);
+    ret.exportTime = timer.elapsed();
+    if (!ret.ok)
+        ret.errorMessage = u"%1 exporter failed"_s.arg(QString::fromLatin1(exporterKey));
+    return ret;
+}
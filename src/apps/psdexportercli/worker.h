@@ -0,0 +1,42 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+
+struct ExportResult
+{
+    QString fileName;
+    QString output;
+    bool ok = false;
+    QString errorMessage;
+    // milliseconds
+    qint64 loadTime = 0;
+    qint64 exportTime = 0;
+    qint64 wallTime = 0;
+    // bytes, -1 if unknown
+    qint64 peakMemory = -1;
+
+    QJsonObject toJson() const;
+    static ExportResult fromJson(const QJsonObject &object);
+};
+
+// workers write their result to stdout on a line starting with this
+inline constexpr QByteArrayView ResultPrefix = "psdexportercli-result: ";
+
+// parses name=value pairs, values are converted to bool, int, double or
+// QSize ("1920x1080") when they look like one
+QVariantMap parseHints(const QStringList &hints, QString *errorMessage);
+
+// the peak resident memory of this process in bytes, -1 if unknown
+qint64 peakMemoryUsage();
+
+// exports fileName with the exporter to output, which is a directory for
+// directory exporters and the file name without suffix for file exporters
+ExportResult exportFile(const QString &fileName, const QByteArray &exporterKey, const QString &output, const QVariantMap &hints);
+
+#endif // WORKER_H
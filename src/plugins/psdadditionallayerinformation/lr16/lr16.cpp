@@ -11,9 +11,12 @@ class QPsdAdditionalLayerInformationLr16Plugin : public QPsdAdditionalLayerInfor
     Q_OBJECT
     Q_PLUGIN_METADATA(IID "org.qt-project.Qt.QPsdAdditionalLayerInformationFactoryInterface" FILE "lr16.json")
 public:
-    // Color Balance
+    // 16-bit and 32-bit layer info
     QVariant parse(QIODevice *source , quint32 length) const override {
-        const auto layerInfo = QPsdLayerInfo(source, length);
+        return parse(QPsdFileHeader(), source, length);
+    }
+    QVariant parse(const QPsdFileHeader &header, QIODevice *source, quint64 length) const override {
+        const auto layerInfo = QPsdLayerInfo(header, source, length);
         Q_UNUSED(layerInfo);
 
         return {};
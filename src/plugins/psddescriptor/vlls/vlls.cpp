@@ -17,13 +17,13 @@ public:
         QVariantList ret;
         for (int i = 0; i < count; ++i) {
             // OSType key for type to use. See See Descriptor structure for types.
-            QByteArray osType = readByteArray(source, 4, length);
+            const auto osType = readU32(source, length);
             auto plugin = QPsdDescriptorPlugin::plugin(osType);
             if (plugin) {
                 auto value = plugin->parse(source, length);
                 ret.append(value);
             } else {
-                qWarning() << osType << "not supported";
+                qWarning() << fromFourCC(osType) << "not supported";
                 break;
             }
         }
@@ -4,6 +4,7 @@
 #include <QtPsdExporter/qpsdexporterplugin.h>
 #include <QtPsdExporter/qpsdimagestore.h>
 
+#include <QtCore/QBuffer>
 #include <QtCore/QCborMap>
 #include <QtCore/QDir>
 #include <QtCore/QQueue>
@@ -269,10 +270,9 @@ bool QPsdExporterFlutterPlugin::traverseElement(QTextStream &out, const Element
 
 bool QPsdExporterFlutterPlugin::saveTo(const QString &baseName, Element *element, const ImportData &imports, const ExportData &exports) const
 {
-    QFile file(dir.absoluteFilePath(toSnakeCase(baseName) + ".dart"));
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return false;
-    QTextStream out(&file);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream out(&buffer);
 
     if (!licenseText.isEmpty()) {
         const QStringList lines = licenseText.split('\n');
@@ -333,7 +333,8 @@ bool QPsdExporterFlutterPlugin::saveTo(const QString &baseName, Element *element
     out << indentString(1) << "}\n";
     out << "}\n";
 
-    return true;
+    out.flush();
+    return writeFile(dir.absoluteFilePath(toSnakeCase(baseName) + ".dart"), buffer.data());
 }
 
 bool QPsdExporterFlutterPlugin::outputRectProp(const QRectF &rect, Element *element, bool skipEmpty, bool outputPos) const
@@ -748,15 +749,15 @@ bool QPsdExporterFlutterPlugin::outputShape(const QModelIndex &shapeIndex, Eleme
 bool QPsdExporterFlutterPlugin::outputImage(const QModelIndex &imageIndex, Element *element) const
 {
     const auto *image = dynamic_cast<const QPsdImageLayerItem *>(model()->layerItem(imageIndex));
-    QString name;
-    bool done = false;
+    // the file written for the layer by the previous export, if the layer is unchanged
+    QString name = imageStore.reuse(cachedImageName(imageIndex));
+    bool done = !name.isEmpty();
     const auto linkedFile = image->linkedFile();
-    if (!linkedFile.type.isEmpty()) {
-        QImage qimage = image->linkedImage();
+    if (!done && !linkedFile.type.isEmpty()) {
+        const QImage qimage = imageScaling
+            ? image->linkedImage(QSize(image->rect().width() * horizontalScale, image->rect().height() * verticalScale))
+            : image->linkedImage();
         if (!qimage.isNull()) {
-            if (imageScaling) {
-                qimage = qimage.scaled(image->rect().width() * horizontalScale, image->rect().height() * verticalScale, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            }
             QByteArray format = linkedFile.type.trimmed();
             name = imageStore.save(imageFileName(linkedFile.name, QString::fromLatin1(format.constData())), qimage, format.constData());
             done = !name.isEmpty();
@@ -769,6 +770,7 @@ bool QPsdExporterFlutterPlugin::outputImage(const QModelIndex &imageIndex, Eleme
         }
         name = imageStore.save(imageFileName(image->name(), "PNG"_L1), qimage, "PNG");
     }
+    setCachedImageName(imageIndex, name);
 
     element->type = "Image.asset";
     element->noNamedParam = u"\"%1\""_s.arg(imagePath(name));
@@ -1067,6 +1069,7 @@ bool QPsdExporterFlutterPlugin::exportTo(const QPsdExporterTreeItemModel *model,
     if (!generateMaps()) {
         return false;
     }
+    loadFingerprints(to, hint);
 
     ImportData imports;
     imports.insert("package:flutter/material.dart");
@@ -1091,7 +1094,8 @@ bool QPsdExporterFlutterPlugin::exportTo(const QPsdExporterTreeItemModel *model,
     window.type = "MainWindow";
     window.properties.insert("child", QVariant::fromValue(sizedBox));
 
-    return saveTo("MainWindow", &window, imports, exports);
+    const bool saved = saveTo("MainWindow", &window, imports, exports);
+    return imageStore.waitForDone() && saveFingerprints() && saved;
 }
 
 QT_END_NAMESPACE
@@ -3,7 +3,6 @@
 
 #include <QtPsdExporter/qpsdexporterplugin.h>
 #include <QtPsdCore/QPsdTypeToolObjectSetting>
-#include <QtPsdCore/QPsdEngineDataParser>
 
 #include <QtCore/QJsonDocument>
 
@@ -119,11 +118,7 @@ bool QPsdExporterJsonPlugin::exportTo(const QPsdExporterTreeItemModel *model, co
             const QPsdLayerRecord record = text->record();
             const auto additionalLayerInformation = record.additionalLayerInformation();
             const auto tysh = additionalLayerInformation.value("TySh").value<QPsdTypeToolObjectSetting>();
-            const auto textData = tysh.textData();
-            const auto engineDataData = textData.data().value("EngineData").toByteArray();
-            const auto engineData = QPsdEngineDataParser::parseEngineData(engineDataData);
-
-            const auto engineDict = engineData.value("EngineDict"_L1).toMap();
+            const auto engineDict = tysh.engineData().value(u"EngineDict").toMap();
 
             QJsonObject textDataJson;
             textDataJson.insert("engineDict", engineDict.toJsonObject());
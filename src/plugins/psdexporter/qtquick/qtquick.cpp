@@ -4,6 +4,7 @@
 #include <QtPsdExporter/qpsdexporterplugin.h>
 #include <QtPsdExporter/qpsdimagestore.h>
 
+#include <QtCore/QBuffer>
 #include <QtCore/QCborMap>
 #include <QtCore/QDir>
 #include <QtCore/QQueue>
@@ -99,6 +100,7 @@ bool QPsdExporterQtQuickPlugin::exportTo(const QPsdExporterTreeItemModel *model,
     if (!generateMaps()) {
         return false;
     }
+    loadFingerprints(to, hint);
 
     ImportData imports;
     imports.insert("QtQuick");
@@ -115,7 +117,8 @@ bool QPsdExporterQtQuickPlugin::exportTo(const QPsdExporterTreeItemModel *model,
             return false;
     }
 
-    return saveTo("MainWindow.ui", &window, imports, exports);
+    const bool saved = saveTo("MainWindow.ui", &window, imports, exports);
+    return imageStore.waitForDone() && saveFingerprints() && saved;
 }
 
 bool QPsdExporterQtQuickPlugin::outputBase(const QModelIndex &index, Element *element, ImportData *imports, QRect rectBounds) const
@@ -650,15 +653,15 @@ bool QPsdExporterQtQuickPlugin::outputShape(const QModelIndex &shapeIndex, Eleme
 bool QPsdExporterQtQuickPlugin::outputImage(const QModelIndex &imageIndex, Element *element, ImportData *imports) const
 {
     const QPsdImageLayerItem *image = dynamic_cast<const QPsdImageLayerItem *>(model()->layerItem(imageIndex));
-    QString name;
-    bool done = false;
+    // the file written for the layer by the previous export, if the layer is unchanged
+    QString name = imageStore.reuse(cachedImageName(imageIndex));
+    bool done = !name.isEmpty();
     const auto linkedFile = image->linkedFile();
-    if (!linkedFile.type.isEmpty()) {
-        QImage qimage = image->linkedImage();
+    if (!done && !linkedFile.type.isEmpty()) {
+        const QImage qimage = imageScaling
+            ? image->linkedImage(QSize(image->rect().width() * horizontalScale, image->rect().height() * verticalScale))
+            : image->linkedImage();
         if (!qimage.isNull()) {
-            if (imageScaling) {
-                qimage = qimage.scaled(image->rect().width() * horizontalScale, image->rect().height() * verticalScale, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            }
             QByteArray format = linkedFile.type.trimmed();
             name = imageStore.save(imageFileName(linkedFile.name, QString::fromLatin1(format.constData())), qimage, format.constData());
             done = !name.isEmpty();
@@ -671,6 +674,7 @@ bool QPsdExporterQtQuickPlugin::outputImage(const QModelIndex &imageIndex, Eleme
         }
         name = imageStore.save(imageFileName(image->name(), "PNG"_L1), qimage, "PNG");
     }
+    setCachedImageName(imageIndex, name);
 
     element->type = "Image";
     if (!outputBase(imageIndex, element, imports))
@@ -850,10 +854,9 @@ bool QPsdExporterQtQuickPlugin::traverseTree(const QModelIndex &index, Element *
 
 bool QPsdExporterQtQuickPlugin::saveTo(const QString &baseName, Element *element, const ImportData &imports, const ExportData &exports) const
 {
-    QFile file(dir.absoluteFilePath(baseName + ".qml"));
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return false;
-    QTextStream out(&file);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream out(&buffer);
 
     if (!licenseText.isEmpty()) {
         const QStringList lines = licenseText.split('\n');
@@ -953,7 +956,10 @@ bool QPsdExporterQtQuickPlugin::saveTo(const QString &baseName, Element *element
         out << QByteArray(level * 4, ' ') << "}\n";
         return true;
     };
-    return traverseElement(element, 0);
+    if (!traverseElement(element, 0))
+        return false;
+    out.flush();
+    return writeFile(dir.absoluteFilePath(baseName + ".qml"), buffer.data());
 }
 
 QT_END_NAMESPACE
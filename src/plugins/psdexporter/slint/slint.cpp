@@ -4,6 +4,7 @@
 #include <QtPsdExporter/qpsdexporterplugin.h>
 #include <QtPsdExporter/qpsdimagestore.h>
 
+#include <QtCore/QBuffer>
 #include <QtCore/QCborMap>
 #include <QtCore/QDir>
 #include <QtGui/QBrush>
@@ -44,6 +45,7 @@ private:
     mutable bool makeCompact = false;
     mutable bool imageScaling = false;
     mutable QDir dir;
+    mutable QPsdImageStore imageStore;
     mutable QString licenseText;
 
     using ImportData = QHash<QString, QSet<QString>>;
@@ -72,6 +74,7 @@ bool QPsdExporterSlintPlugin::exportTo(const QPsdExporterTreeItemModel *model, c
 {
     setModel(model);
     dir = QDir(to);
+    imageStore = { dir, "images"_L1 };
 
     const QSize originalSize = model->size();
     const QSize targetSize = hint.value("resolution", originalSize).toSize();
@@ -84,6 +87,7 @@ bool QPsdExporterSlintPlugin::exportTo(const QPsdExporterTreeItemModel *model, c
     licenseText = hint.value("licenseText").toString();
 
     generateMaps();
+    loadFingerprints(to, hint);
 
     ImportData imports;
     ExportData exports;
@@ -99,7 +103,8 @@ bool QPsdExporterSlintPlugin::exportTo(const QPsdExporterTreeItemModel *model, c
             return false;
     }
 
-    return saveTo("MainWindow", &window, imports, exports);
+    const bool saved = saveTo("MainWindow", &window, imports, exports);
+    return imageStore.waitForDone() && saveFingerprints() && saved;
 }
 
 bool QPsdExporterSlintPlugin::outputBase(const QModelIndex &index, Element *element, ImportData *imports, QRect rectBounds) const
@@ -698,17 +703,16 @@ bool QPsdExporterSlintPlugin::outputShape(const QModelIndex &shapeIndex, Element
 bool QPsdExporterSlintPlugin::outputImage(const QModelIndex &imageIndex, Element *element, ImportData *imports) const
 {
     const auto *image = dynamic_cast<const QPsdImageLayerItem *>(model()->layerItem(imageIndex));
-    QPsdImageStore imageStore(dir, "images"_L1);
 
-    QString name;
-    bool done = false;
+    // the file written for the layer by the previous export, if the layer is unchanged
+    QString name = imageStore.reuse(cachedImageName(imageIndex));
+    bool done = !name.isEmpty();
     const auto linkedFile = image->linkedFile();
-    if (!linkedFile.type.isEmpty()) {
-        QImage qimage = image->linkedImage();
+    if (!done && !linkedFile.type.isEmpty()) {
+        const QImage qimage = imageScaling
+            ? image->linkedImage(QSize(image->rect().width() * horizontalScale, image->rect().height() * verticalScale))
+            : image->linkedImage();
         if (!qimage.isNull()) {
-            if (imageScaling) {
-                qimage = qimage.scaled(image->rect().width() * horizontalScale, image->rect().height() * verticalScale, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            }
             QByteArray format = linkedFile.type.trimmed();
             name = imageStore.save(imageFileName(linkedFile.name, QString::fromLatin1(format.constData())), qimage, format.constData());
             done = !name.isEmpty();
@@ -721,6 +725,7 @@ bool QPsdExporterSlintPlugin::outputImage(const QModelIndex &imageIndex, Element
         }
         name = imageStore.save(imageFileName(image->name(), "PNG"_L1), qimage, "PNG");
     }
+    setCachedImageName(imageIndex, name);
 
     element->type = "Image";
     if (!outputBase(imageIndex, element, imports))
@@ -809,10 +814,9 @@ bool QPsdExporterSlintPlugin::outputPath(const QPainterPath &path, Element *elem
 
 bool QPsdExporterSlintPlugin::saveTo(const QString &baseName, Element *element, const ImportData &imports, const ExportData &exports) const
 {
-    QFile file(dir.absoluteFilePath(baseName + ".slint"));
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return false;
-    QTextStream out(&file);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream out(&buffer);
 
     if (!licenseText.isEmpty()) {
         const QStringList lines = licenseText.split('\n');
@@ -916,7 +920,10 @@ bool QPsdExporterSlintPlugin::saveTo(const QString &baseName, Element *element,
         return true;
     };
 
-    return traverseElement(element, 0);
+    if (!traverseElement(element, 0))
+        return false;
+    out.flush();
+    return writeFile(dir.absoluteFilePath(baseName + ".slint"), buffer.data());
 };
 
 QT_END_NAMESPACE
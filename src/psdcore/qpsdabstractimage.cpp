@@ -2,9 +2,22 @@
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qpsdabstractimage.h"
+#include "qpsdcompression_p.h"
 #include "qpsdfileheader.h"
+#include "qpsdimageconversion_p.h"
 
-#include <cmath>
+#include <QtCore/QScopeGuard>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtEndian>
+#include <QtCore/private/qsimd_p.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#include <zlib.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -85,353 +98,595 @@ void QPsdAbstractImage::setHeader(const QPsdFileHeader &header)
     d->header = header;
 }
 
-QByteArray QPsdAbstractImage::readRLE(QIODevice *source, int height, quint32 *length)
+namespace {
+
+// Returns the number of bytes a PackBits compressed scan line expands to
+qsizetype unpackedSize(const uchar *src, qsizetype size)
 {
-    QByteArray ret;
-    QList<qint16> byteCounts;
-    for (int y = 0; y < height; y++) {
-        byteCounts.append(readS16(source, length));
+    const uchar *const end = src + size;
+    qsizetype ret = 0;
+    while (src < end) {
+        const auto n = static_cast<qint8>(*src++);
+        if (n >= 0) {
+            ret += n + 1;
+            src += n + 1;
+        } else if (n != -128) {
+            ret += 1 - n;
+            src++;
+        }
+    }
+    return ret;
+}
+
+}
+
+namespace QPsdCompression {
+
+bool unpackBits(const uchar *src, qsizetype srcSize, uchar *dst, qsizetype dstSize)
+{
+    const uchar *const srcEnd = src + srcSize;
+    uchar *const dstEnd = dst + dstSize;
+    bool ok = true;
+    while (src < srcEnd) {
+        const auto n = static_cast<qint8>(*src++);
+        if (n >= 0) {
+            // n + 1 literal bytes
+            qsizetype count = n + 1;
+            if (count > srcEnd - src || count > dstEnd - dst) {
+                ok = false;
+                count = std::min(srcEnd - src, dstEnd - dst);
+            }
+            std::memcpy(dst, src, count);
+            src += count;
+            dst += count;
+        } else if (n != -128) {
+            // the next byte repeated 1 - n times, -128 is a no-op
+            qsizetype count = 1 - n;
+            if (src == srcEnd || count > dstEnd - dst) {
+                ok = false;
+                if (src == srcEnd)
+                    break;
+                count = dstEnd - dst;
+            }
+            std::memset(dst, *src++, count);
+            dst += count;
+        }
+        if (!ok)
+            break;
     }
-    for (qint16 byteCount : byteCounts) {
-        EnsureSeek es(source, byteCount);
-        while (es.bytesAvailable() > 0) {
-            auto size = readS8(source, length);
-            if (size == -128) {
-                // ignore size == -128 for padding
-            } else if (size < 0) {
-                ret.append(-size + 1, readByteArray(source, 1, length).at(0));
-            } else if (size >= 0) {
-                ret.append(readByteArray(source, size + 1, length));
+    if (dst < dstEnd)
+        std::memset(dst, 0, dstEnd - dst);
+    return ok;
+}
+
+}
+
+namespace {
+
+enum class InflateResult {
+    Complete,
+    Truncated,
+    Overrun,
+    Error,
+};
+
+// Inflates the zlib stream in data into out. With grow, out is enlarged as needed and
+// trimmed to the inflated size, otherwise out must already have the expected size.
+InflateResult inflateTo(QByteArrayView data, QByteArray *out, bool grow)
+{
+    z_stream stream = {};
+    if (inflateInit(&stream) != Z_OK)
+        return InflateResult::Error;
+    auto cleanup = qScopeGuard([&] {
+        inflateEnd(&stream);
+    });
+
+    constexpr qsizetype maxChunk = std::numeric_limits<uInt>::max();
+    const auto *in = reinterpret_cast<const Bytef *>(data.data());
+    qsizetype inAvailable = data.size();
+    qsizetype written = 0;
+    int status = Z_OK;
+    auto result = InflateResult::Complete;
+    while (status != Z_STREAM_END) {
+        if (stream.avail_in == 0) {
+            if (inAvailable == 0) {
+                result = InflateResult::Truncated;
+                break;
             }
+            stream.next_in = const_cast<Bytef *>(in);
+            stream.avail_in = uInt(std::min(inAvailable, maxChunk));
+            in += stream.avail_in;
+            inAvailable -= stream.avail_in;
+        }
+
+        if (written == out->size()) {
+            if (!grow) {
+                // the stream may still end without producing anything
+                Bytef scratch;
+                stream.next_out = &scratch;
+                stream.avail_out = 1;
+                status = inflate(&stream, Z_NO_FLUSH);
+                if (status != Z_STREAM_END)
+                    result = InflateResult::Overrun;
+                break;
+            }
+            out->resize(std::max<qsizetype>(out->size() * 2, 64 * 1024));
+        }
+
+        stream.next_out = reinterpret_cast<Bytef *>(out->data()) + written;
+        stream.avail_out = uInt(std::min(out->size() - written, maxChunk));
+        const auto available = stream.avail_out;
+        status = inflate(&stream, Z_NO_FLUSH);
+        written += available - stream.avail_out;
+        if (status != Z_OK && status != Z_STREAM_END) {
+            result = status == Z_BUF_ERROR ? InflateResult::Truncated : InflateResult::Error;
+            break;
         }
     }
+
+    if (grow)
+        out->resize(written);
+    else if (written < out->size())
+        std::memset(out->data() + written, 0, out->size() - written);
+    return result;
+}
+
+}
+
+namespace QPsdCompression {
+
+void unpredict8(uchar *p, qsizetype size)
+{
+    qsizetype i = 0;
+    uchar sum = 0;
+#ifdef __SSE2__
+    // prefix sum of 16 bytes in four shifted adds, plus the last sum of the previous block
+    __m128i carry = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        auto *block = reinterpret_cast<__m128i *>(p + i);
+        __m128i v = _mm_loadu_si128(block);
+        v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+        v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+        v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi8(v, carry);
+        _mm_storeu_si128(block, v);
+        carry = _mm_set1_epi8(char(p[i + 15]));
+    }
+    if (i > 0)
+        sum = p[i - 1];
+#endif
+    for (; i < size; i++) {
+        sum += p[i];
+        p[i] = sum;
+    }
+}
+
+void unpredict16(uchar *p, qsizetype width)
+{
+    if (width == 0)
+        return;
+    quint16 sum = qFromBigEndian<quint16>(p);
+    for (qsizetype x = 1; x < width; x++) {
+        sum += qFromBigEndian<quint16>(p + x * 2);
+        qToBigEndian<quint16>(sum, p + x * 2);
+    }
+}
+
+void unpredict32(uchar *p, qsizetype width, uchar *scratch)
+{
+    unpredict8(p, width * 4);
+    std::memcpy(scratch, p, width * 4);
+    const uchar *planes[4] = { scratch, scratch + width, scratch + width * 2, scratch + width * 3 };
+    for (qsizetype x = 0; x < width; x++) {
+        *p++ = planes[0][x];
+        *p++ = planes[1][x];
+        *p++ = planes[2][x];
+        *p++ = planes[3][x];
+    }
+}
+
+}
+
+using namespace QPsdCompression;
+
+QByteArray QPsdAbstractImage::readRLE(QIODevice *source, int height, quint32 *length)
+{
+    // read the byte counts and all the scan lines in two reads and decode them in memory
+    QByteArray data = readByteArray(source, height * 2, length);
+    const auto *byteCounts = reinterpret_cast<const uchar *>(data.constData());
+    quint32 size = 0;
+    for (int y = 0; y < data.size() / 2; y++)
+        size += qFromBigEndian<quint16>(byteCounts + y * 2);
+    data.append(readByteArray(source, size, length));
+    return decodeRLE(data, height);
+}
+
+// calls work(from, to) for ranges of rows covering [0, rows), spread over pool
+// when the bytes they produce are worth it
+template <typename Work>
+static void forEachRowRange(QThreadPool *pool, int rows, qsizetype bytes, Work &&work)
+{
+    if (rows <= 0)
+        return;
+
+    // below this a task costs more than the rows it produces
+    constexpr qsizetype minimumBytesPerTask = 64 * 1024;
+    const int maxTasks = pool ? pool->maxThreadCount() * 4 : 1;
+    const int tasks = std::clamp<qsizetype>(bytes / minimumBytesPerTask, 1, std::min(maxTasks, rows));
+    if (tasks == 1) {
+        work(0, rows);
+        return;
+    }
+
+    // tryStart() never queues, busy pools run the rows on this thread instead of waiting
+    QSemaphore finished;
+    int started = 0;
+    for (int i = 1; i < tasks; i++) {
+        const int from = qsizetype(rows) * i / tasks;
+        const int to = qsizetype(rows) * (i + 1) / tasks;
+        if (pool->tryStart([&, from, to] { work(from, to); finished.release(); }))
+            started++;
+        else
+            work(from, to);
+    }
+    work(0, rows / tasks);
+    finished.acquire(started);
+}
+
+QByteArray QPsdAbstractImage::decodeRLE(QByteArrayView data, int height, qsizetype bytesPerLine, QThreadPool *pool, int byteCountSize)
+{
+    // data starts with the byte counts for all the scan lines, each stored as a two-byte value
+    // (**PSB** four-byte value), followed by the scan lines, each compressed separately with PackBits
+    Q_ASSERT(byteCountSize == 2 || byteCountSize == 4);
+    const qsizetype tableSize = qsizetype(height) * byteCountSize;
+    if (height <= 0)
+        return {};
+    if (data.size() < tableSize) {
+        qWarning() << "RLE byte counts are truncated";
+        return {};
+    }
+
+    // the byte counts index every scan line, so any range of them can be decoded on its own
+    const auto *src = reinterpret_cast<const uchar *>(data.data());
+    QList<qsizetype> offsets(height + 1);
+    offsets[0] = tableSize;
+    for (int y = 0; y < height; y++) {
+        const qsizetype byteCount = byteCountSize == 4 ? qFromBigEndian<quint32>(src + y * 4)
+                                                       : qFromBigEndian<quint16>(src + y * 2);
+        offsets[y + 1] = offsets.at(y) + byteCount;
+    }
+    if (offsets.last() > data.size()) {
+        qWarning() << "RLE data is truncated," << offsets.last() << "bytes expected," << data.size() << "available";
+        for (auto &offset : offsets)
+            offset = std::min(offset, data.size());
+    }
+
+    if (bytesPerLine < 0)
+        bytesPerLine = unpackedSize(src + offsets.at(0), offsets.at(1) - offsets.at(0));
+
+    QByteArray ret(qsizetype(height) * bytesPerLine, Qt::Uninitialized);
+    auto *dst = reinterpret_cast<uchar *>(ret.data());
+    std::atomic_bool ok = true;
+    auto decodeLines = [&](int from, int to) {
+        for (int y = from; y < to; y++) {
+            if (!unpackBits(src + offsets.at(y), offsets.at(y + 1) - offsets.at(y), dst + y * bytesPerLine, bytesPerLine))
+                ok = false;
+        }
+    };
+
+    forEachRowRange(pool, height, ret.size(), decodeLines);
+
+    if (!ok)
+        qWarning() << "RLE data is malformed";
     return ret;
 }
 
 QByteArray QPsdAbstractImage::readZip(QIODevice *source, quint32 *length)
 {
-    quint32 beLength = qToBigEndian(*length);
-    QByteArray zipData = readByteArray(source, *length, length);
-    zipData.prepend(reinterpret_cast<char *>(&beLength), sizeof(quint32));
+    const QByteArray data = readByteArray(source, *length, length);
+    QByteArray ret;
+    if (inflateTo(data, &ret, true) != InflateResult::Complete)
+        qWarning() << "ZIP data is malformed";
+    return ret;
+}
+
+QByteArray QPsdAbstractImage::decodeZip(QByteArrayView data, int width, int height, int depth, bool prediction)
+{
+    if (width <= 0 || height <= 0)
+        return {};
+
+    QByteArray ret;
+    bool grow = false;
+    if (depth > 0) {
+        // inflate straight into the final buffer
+        const qsizetype bytesPerLine = depth == 1 ? (qsizetype(width) + 7) / 8 : qsizetype(width) * depth / 8;
+        ret = QByteArray(bytesPerLine * height, Qt::Uninitialized);
+    } else {
+        // the depth is unknown without a file header, it follows from the inflated size
+        grow = true;
+    }
+
+    switch (inflateTo(data, &ret, grow)) {
+    case InflateResult::Complete:
+        break;
+    case InflateResult::Truncated:
+        qWarning() << "ZIP data is truncated";
+        break;
+    case InflateResult::Overrun:
+        qWarning() << "ZIP data is larger than" << width << "x" << height << "at depth" << depth;
+        break;
+    case InflateResult::Error:
+        qWarning() << "ZIP data is malformed";
+        break;
+    }
+
+    if (!prediction)
+        return ret;
+
+    if (grow)
+        depth = ret.size() * 8 / (qsizetype(width) * height);
+    const qsizetype bytesPerLine = qsizetype(width) * depth / 8;
+    if (ret.size() < bytesPerLine * height) {
+        qWarning() << "ZIP data is too small for prediction at depth" << depth;
+        return ret;
+    }
 
-    return qUncompress(zipData);
+    auto *p = reinterpret_cast<uchar *>(ret.data());
+    switch (depth) {
+    case 8:
+        for (int y = 0; y < height; y++)
+            unpredict8(p + y * bytesPerLine, width);
+        break;
+    case 16:
+        for (int y = 0; y < height; y++)
+            unpredict16(p + y * bytesPerLine, width);
+        break;
+    case 32: {
+        QByteArray scratch(bytesPerLine, Qt::Uninitialized);
+        auto *s = reinterpret_cast<uchar *>(scratch.data());
+        for (int y = 0; y < height; y++)
+            unpredict32(p + y * bytesPerLine, width, s);
+        break; }
+    default:
+        qWarning() << "ZIP prediction is not supported at depth" << depth;
+        break;
+    }
+    return ret;
 }
 
+// pixels converted at a time, small enough for per chunk scratch buffers on the stack
+static constexpr qsizetype ChunkSize = 4096;
+
 QByteArray QPsdAbstractImage::toImage(QPsdFileHeader::ColorMode colorMode) const
 {
-    QByteArray ret;
-    const auto size = width() * height();
-    const auto bytesPerChannel = depth() / 8;
     switch (colorMode) {
     case QPsdFileHeader::Bitmap:
     case QPsdFileHeader::Grayscale:
     case QPsdFileHeader::Indexed:
         // For bitmap and grayscale, imageData() contains the raw pixel data
         // For indexed, this returns palette indices that need to be converted to RGB using the color table
-        // but we should verify it matches the expected size
-        ret = imageData();
+        return imageData();
+    default:
         break;
+    }
+
+    const auto bytesPerLine = toImageBytesPerLine(colorMode);
+    QByteArray ret(bytesPerLine * height(), Qt::Uninitialized);
+    if (ret.isEmpty() || !toImage(colorMode, reinterpret_cast<uchar *>(ret.data()), bytesPerLine))
+        return QByteArray();
+    return ret;
+}
+
+qsizetype QPsdAbstractImage::toImageBytesPerLine(QPsdFileHeader::ColorMode colorMode) const
+{
+    const qsizetype w = width();
+    const auto bytesPerChannel = depth() / 8;
+    switch (colorMode) {
+    case QPsdFileHeader::Bitmap:
+    case QPsdFileHeader::Grayscale:
+    case QPsdFileHeader::Indexed:
+        return depth() == 1 ? (w + 7) / 8 : w * bytesPerChannel;
+    case QPsdFileHeader::RGB:
+        // BGR(A)
+        if (bytesPerChannel != 1 && bytesPerChannel != 2 && bytesPerChannel != 4)
+            return 0;
+        return w * (a() ? 4 : 3) * bytesPerChannel;
+    case QPsdFileHeader::CMYK:
+        // CMYK, 16-bit is narrowed to 8-bit
+        return bytesPerChannel == 1 || bytesPerChannel == 2 ? w * 4 : 0;
+    case QPsdFileHeader::Lab:
+        // RGB from 8-bit, RGBA64 from 16-bit
+        if (bytesPerChannel == 1)
+            return w * 3;
+        return bytesPerChannel == 2 ? w * 8 : 0;
+    case QPsdFileHeader::Multichannel:
+    case QPsdFileHeader::Duotone:
+        // the first channel as 8-bit grayscale
+        return bytesPerChannel == 1 || bytesPerChannel == 2 ? w : 0;
+    default:
+        return 0;
+    }
+}
+
+bool QPsdAbstractImage::toImage(QPsdFileHeader::ColorMode colorMode, uchar *bits, qsizetype bytesPerLine, int firstRow, int rowCount) const
+{
+    const qsizetype w = width();
+    const int h = height();
+    if (rowCount < 0)
+        rowCount = h - firstRow;
+    if (firstRow < 0 || rowCount < 0 || firstRow > h - rowCount) {
+        qWarning() << "rows" << firstRow << "to" << firstRow + rowCount << "are out of range, the image has" << h;
+        return false;
+    }
+    if (w == 0 || rowCount == 0)
+        return true;
+
+    const auto lineSize = toImageBytesPerLine(colorMode);
+    if (lineSize == 0) {
+        qWarning() << "depth" << depth() << "is not supported for color mode" << colorMode;
+        return false;
+    }
+    if (bytesPerLine < lineSize) {
+        qWarning() << "bytesPerLine" << bytesPerLine << "is smaller than" << lineSize;
+        return false;
+    }
+
+    // rows of a tightly packed destination are contiguous and converted as one run
+    const bool packed = bytesPerLine == lineSize;
+    const int runs = packed ? 1 : rowCount;
+    const qsizetype runLength = packed ? w * rowCount : w;
+    const qsizetype pixelSize = lineSize / w;
+    // calls convert(out, pixel, count) for chunks of at most ChunkSize pixels,
+    // pixel is the index of the first one in the source planes
+    auto forEachChunk = [&](auto &&convert) {
+        for (int run = 0; run < runs; run++) {
+            auto *line = bits + run * bytesPerLine;
+            const qsizetype first = (qsizetype(firstRow) + run) * w;
+            for (qsizetype i = 0; i < runLength; i += ChunkSize) {
+                const qsizetype count = std::min(ChunkSize, runLength - i);
+                convert(line + i * pixelSize, first + i, count);
+            }
+        }
+    };
+
+    const auto bytesPerChannel = depth() / 8;
+    switch (colorMode) {
+    case QPsdFileHeader::Bitmap:
+    case QPsdFileHeader::Grayscale:
+    case QPsdFileHeader::Indexed: {
+        const auto data = imageData();
+        bool complete = true;
+        for (int row = 0; row < rowCount; row++) {
+            auto *out = bits + row * bytesPerLine;
+            const qsizetype offset = (qsizetype(firstRow) + row) * lineSize;
+            const qsizetype available = std::clamp<qsizetype>(data.size() - offset, 0, lineSize);
+            std::memcpy(out, data.constData() + offset, available);
+            if (available < lineSize) {
+                std::memset(out + available, 0, lineSize - available);
+                complete = false;
+            }
+        }
+        if (!complete) {
+            qWarning() << "image data is too small," << data.size() << "bytes for" << h << "rows of" << lineSize;
+            return false;
+        }
+        break; }
     case QPsdFileHeader::RGB: {
-        auto pr = r();
-        auto pg = g();
-        auto pb = b();
-        auto pa = a();
-        double o = opacity();
-
-        if (bytesPerChannel == 0 || bytesPerChannel == 1) {
-            // 8-bit per channel
-            for (quint32 i = 0; i < size; i++) {
-                ret.append(*pb++);
-                ret.append(*pg++);
-                ret.append(*pr++);
+        const auto pr = r();
+        const auto pg = g();
+        const auto pb = b();
+        const auto pa = a();
+        const quint8 o = opacity();
+
+        // BGR(A) for every pixel, the alpha channel is scaled by the opacity
+        uchar alpha[ChunkSize * 4];
+        forEachChunk([&](uchar *out, qsizetype pixel, qsizetype count) {
+            const qsizetype offset = pixel * bytesPerChannel;
+            switch (bytesPerChannel) {
+            case 1:
                 if (pa) {
-                    ret.append(*pa++ * o / 0xff);
+                    QPsdImageConversion::scaleAlpha8(alpha, pa + offset, count, o);
+                    QPsdImageConversion::interleave4x8(out, pb + offset, pg + offset, pr + offset, alpha, count);
+                } else {
+                    QPsdImageConversion::interleave3x8(out, pb + offset, pg + offset, pr + offset, count);
                 }
-            }
-        } else if (bytesPerChannel == 2) {
-            // 16-bit per channel
-            for (quint32 i = 0; i < size; i++) {
-                // Append 2 bytes for each channel
-                ret.append(reinterpret_cast<const char*>(pb), 2);
-                pb += 2;
-                ret.append(reinterpret_cast<const char*>(pg), 2);
-                pg += 2;
-                ret.append(reinterpret_cast<const char*>(pr), 2);
-                pr += 2;
+                break;
+            case 2:
                 if (pa) {
-                    // For 16-bit, we need to scale opacity differently
-                    quint16 alpha = *reinterpret_cast<const quint16*>(pa);
-                    alpha = static_cast<quint16>(alpha * o / 0xff);
-                    ret.append(reinterpret_cast<const char*>(&alpha), 2);
-                    pa += 2;
+                    QPsdImageConversion::scaleAlpha16(alpha, pa + offset, count, o);
+                    QPsdImageConversion::interleave4x16(out, pb + offset, pg + offset, pr + offset, alpha, count);
+                } else {
+                    QPsdImageConversion::interleave3x16(out, pb + offset, pg + offset, pr + offset, count);
                 }
-            }
-        } else if (bytesPerChannel == 4) {
-            // 32-bit per channel (float)
-            for (quint32 i = 0; i < size; i++) {
-                ret.append(reinterpret_cast<const char*>(pb), 4);
-                pb += 4;
-                ret.append(reinterpret_cast<const char*>(pg), 4);
-                pg += 4;
-                ret.append(reinterpret_cast<const char*>(pr), 4);
-                pr += 4;
+                break;
+            case 4:
                 if (pa) {
-                    float alpha = *reinterpret_cast<const float*>(pa);
-                    alpha = alpha * static_cast<float>(o / 0xff);
-                    ret.append(reinterpret_cast<const char*>(&alpha), 4);
-                    pa += 4;
+                    QPsdImageConversion::scaleAlpha32(alpha, pa + offset, count, o);
+                    QPsdImageConversion::interleave4x32(out, pb + offset, pg + offset, pr + offset, alpha, count);
+                } else {
+                    QPsdImageConversion::interleave3x32(out, pb + offset, pg + offset, pr + offset, count);
                 }
+                break;
             }
-        } else {
-            qWarning() << "bytesPerChannel" << bytesPerChannel << "not supported";
-        }
+        });
         break; }
     case QPsdFileHeader::CMYK: {
+        // CMYK order for QImage::Format_CMYK8888, PSD stores CMYK inverted
         if (bytesPerChannel == 1) {
             const auto data = imageData();
-            if (data.size() == static_cast<qsizetype>(size)) {
+            if (data.size() == qsizetype(w) * h) {
                 // Data is already unpacked to 1 byte per pixel
-                for (quint32 i = 0; i < size; i++) {
-                    quint8 value = static_cast<quint8>(data[i]);
-                    // For 1-bit CMYK, treat as grayscale and convert to CMYK
-                    // Black (0) -> full CMYK, White (1) -> no CMYK
-                    quint8 cmykValue = value ? 0 : 255;
-                    ret.append(cmykValue);  // C
-                    ret.append(cmykValue);  // M
-                    ret.append(cmykValue);  // Y
-                    ret.append(cmykValue);  // K
-                }
+                // For 1-bit CMYK, treat as grayscale and convert to CMYK
+                // Black (0) -> full CMYK, White (1) -> no CMYK
+                const auto *src = data.constData();
+                forEachChunk([&](uchar *out, qsizetype pixel, qsizetype count) {
+                    for (qsizetype i = 0; i < count; i++)
+                        std::memset(out + i * 4, src[pixel + i] ? 0 : 0xff, 4);
+                });
             } else {
-                auto pc = c();  // Channel 0 = Cyan
-                auto pm = m();  // Channel 1 = Magenta
-                auto py = y();  // Channel 2 = Yellow
-                auto pk = k();  // Channel 3 = Black (K) - might be null
-
-                const auto size = width() * height();
-                for (quint32 i = 0; i < size; i++) {
-                    // CMYK order for QImage::Format_CMYK8888
-                    ret.append(255 - *pc++);  // C
-                    ret.append(255 - *pm++);  // M
-                    ret.append(255 - *py++);  // Y
-                    ret.append(255 - *pk++);  // K
-                }
-            }
-        } else if (bytesPerChannel == 2) {
-            // 16-bit CMYK - convert to 8-bit
-            auto pc = c();  // Channel 0 = Cyan
-            auto pm = m();  // Channel 1 = Magenta
-            auto py = y();  // Channel 2 = Yellow
-            auto pk = k();  // Channel 3 = Black (K)
-
-            const auto size = width() * height();
-            for (quint32 i = 0; i < size; i++) {
-                // Read 16-bit values and convert to 8-bit
-                quint16 c16 = *reinterpret_cast<const quint16*>(pc);
-                quint16 m16 = *reinterpret_cast<const quint16*>(pm);
-                quint16 y16 = *reinterpret_cast<const quint16*>(py);
-                quint16 k16 = *reinterpret_cast<const quint16*>(pk);
-
-                // Convert 16-bit to 8-bit by taking high byte
-                // PSD stores CMYK inverted, so we need to invert back
-                ret.append(255 - (c16 >> 8));  // C
-                ret.append(255 - (m16 >> 8));  // M
-                ret.append(255 - (y16 >> 8));  // Y
-                ret.append(255 - (k16 >> 8));  // K
-
-                pc += 2;
-                pm += 2;
-                py += 2;
-                pk += 2;
+                const auto pc = c();  // Channel 0 = Cyan
+                const auto pm = m();  // Channel 1 = Magenta
+                const auto py = y();  // Channel 2 = Yellow
+                const auto pk = k();  // Channel 3 = Black (K) - might be null
+                // without a black channel there is no black ink, which is stored as 255
+                const QByteArray noInk(pk ? 0 : ChunkSize, char(0xff));
+
+                forEachChunk([&](uchar *out, qsizetype pixel, qsizetype count) {
+                    const auto *black = pk ? pk + pixel : reinterpret_cast<const uchar *>(noInk.constData());
+                    QPsdImageConversion::interleave4x8(out, pc + pixel, pm + pixel, py + pixel, black, count, 0xff);
+                });
             }
         } else {
-            qWarning() << "bytesPerChannel" << bytesPerChannel << "not supported";
+            // 16-bit CMYK - convert to 8-bit by taking the high byte
+            const auto pc = c();  // Channel 0 = Cyan
+            const auto pm = m();  // Channel 1 = Magenta
+            const auto py = y();  // Channel 2 = Yellow
+            const auto pk = k();  // Channel 3 = Black (K)
+
+            uchar narrowed[4][ChunkSize];
+            forEachChunk([&](uchar *out, qsizetype pixel, qsizetype count) {
+                QPsdImageConversion::narrow16to8(narrowed[0], pc + pixel * 2, count);
+                QPsdImageConversion::narrow16to8(narrowed[1], pm + pixel * 2, count);
+                QPsdImageConversion::narrow16to8(narrowed[2], py + pixel * 2, count);
+                QPsdImageConversion::narrow16to8(narrowed[3], pk + pixel * 2, count);
+                QPsdImageConversion::interleave4x8(out, narrowed[0], narrowed[1], narrowed[2], narrowed[3], count, 0xff);
+            });
         }
         break; }
     case QPsdFileHeader::Lab: {
-        if (bytesPerChannel == 1) {
-            // 8-bit Lab
-            auto pL = b();  // Lightness channel
-            auto pa = r();     // a channel (green-red)
-            auto pb = g();     // b channel (blue-yellow)
-
-            const auto size = width() * height();
-            for (quint32 i = 0; i < size; i++) {
-                // Convert Lab to RGB
-                // L: 0-255 maps to 0-100
-                // a,b: 0-255 maps to -128 to +127 (128 is neutral)
-                float L = (*pL++) * 100.0f / 255.0f;
-                float a = (*pa++) - 128.0f;
-                float b = (*pb++) - 128.0f;
-
-                // Lab to XYZ conversion
-                float fy = (L + 16.0f) / 116.0f;
-                float fx = a / 500.0f + fy;
-                float fz = fy - b / 200.0f;
-
-                // Helper function for f^-1
-                auto finv = [](float t) -> float {
-                    const float delta = 6.0f / 29.0f;
-                    if (t > delta) {
-                        return t * t * t;
-                    } else {
-                        return 3.0f * delta * delta * (t - 4.0f / 29.0f);
-                    }
-                };
-
-                // D65 illuminant
-                const float Xn = 0.95047f;
-                const float Yn = 1.00000f;
-                const float Zn = 1.08883f;
-
-                float X = Xn * finv(fx);
-                float Y = Yn * finv(fy);
-                float Z = Zn * finv(fz);
-
-                // XYZ to RGB (sRGB matrix)
-                float R = 3.2404542f * X - 1.5371385f * Y - 0.4985314f * Z;
-                float G = -0.9692660f * X + 1.8760108f * Y + 0.0415560f * Z;
-                float B = 0.0556434f * X - 0.2040259f * Y + 1.0572252f * Z;
-
-                // Apply gamma correction and clamp
-                auto gammaCorrect = [](float c) -> quint8 {
-                    if (c <= 0.0031308f) {
-                        c = 12.92f * c;
-                    } else {
-                        c = 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
-                    }
-                    c = qBound(0.0f, c, 1.0f);
-                    return static_cast<quint8>(c * 255.0f);
-                };
-
-                ret.append(gammaCorrect(R));
-                ret.append(gammaCorrect(G));
-                ret.append(gammaCorrect(B));
-            }
-        } else if (bytesPerChannel == 2) {
-            // 16-bit Lab
-            auto pL = gray();  // Lightness channel
-            auto pa = r();     // a channel
-            auto pb = g();     // b channel
-
-            const auto size = width() * height();
-            for (quint32 i = 0; i < size; i++) {
-                // Read 16-bit values
-                quint16 L16 = *reinterpret_cast<const quint16*>(pL);
-                quint16 a16 = *reinterpret_cast<const quint16*>(pa);
-                quint16 b16 = *reinterpret_cast<const quint16*>(pb);
-
-                // Convert to 8-bit for now (can be improved later)
-                quint8 L8 = L16 >> 8;
-                quint8 a8 = a16 >> 8;
-                quint8 b8 = b16 >> 8;
-
-                // Convert Lab to RGB using same logic as 8-bit
-                float L = L8 * 100.0f / 255.0f;
-                float a = a8 - 128.0f;
-                float b = b8 - 128.0f;
-
-                // Lab to XYZ conversion
-                float fy = (L + 16.0f) / 116.0f;
-                float fx = a / 500.0f + fy;
-                float fz = fy - b / 200.0f;
-
-                // Helper function for f^-1
-                auto finv = [](float t) -> float {
-                    const float delta = 6.0f / 29.0f;
-                    if (t > delta) {
-                        return t * t * t;
-                    } else {
-                        return 3.0f * delta * delta * (t - 4.0f / 29.0f);
-                    }
-                };
-
-                // D65 illuminant
-                const float Xn = 0.95047f;
-                const float Yn = 1.00000f;
-                const float Zn = 1.08883f;
-
-                float X = Xn * finv(fx);
-                float Y = Yn * finv(fy);
-                float Z = Zn * finv(fz);
-
-                // XYZ to RGB (sRGB matrix)
-                float R = 3.2404542f * X - 1.5371385f * Y - 0.4985314f * Z;
-                float G = -0.9692660f * X + 1.8760108f * Y + 0.0415560f * Z;
-                float B = 0.0556434f * X - 0.2040259f * Y + 1.0572252f * Z;
-
-                // Apply gamma correction and clamp
-                auto gammaCorrect = [](float c) -> quint8 {
-                    if (c <= 0.0031308f) {
-                        c = 12.92f * c;
-                    } else {
-                        c = 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
-                    }
-                    c = qBound(0.0f, c, 1.0f);
-                    return static_cast<quint8>(c * 255.0f);
-                };
-
-                ret.append(gammaCorrect(R));
-                ret.append(gammaCorrect(G));
-                ret.append(gammaCorrect(B));
-
-                pL += 2;
-                pa += 2;
-                pb += 2;
+        // L, a and b are the first three channels
+        const auto pL = r();
+        const auto pa = g();
+        const auto pb = b();
+
+        // the conversion is costly enough per pixel to spread rows over threads
+        const auto convert = bytesPerChannel == 1 ? QPsdImageConversion::labToRgb8 : QPsdImageConversion::labToRgba64;
+        forEachRowRange(QThreadPool::globalInstance(), rowCount, lineSize * rowCount, [&](int from, int to) {
+            for (int row = from; row < to; row++) {
+                const qsizetype offset = (qsizetype(firstRow) + row) * w * bytesPerChannel;
+                convert(bits + row * bytesPerLine, pL + offset, pa + offset, pb + offset, w);
             }
-        } else {
-            qWarning() << "bytesPerChannel" << bytesPerChannel << "not supported for Lab color mode";
-        }
+        });
         break; }
-    case QPsdFileHeader::Multichannel: {
+    case QPsdFileHeader::Multichannel:
+    case QPsdFileHeader::Duotone: {
         // Multichannel mode - convert first channel to grayscale
         // This mode is typically used for spot colors in printing
-        if (bytesPerChannel == 1) {
-            // 8-bit multichannel
-            auto pChan0 = gray();  // Use first channel
-            const auto size = width() * height();
-            for (quint32 i = 0; i < size; i++) {
-                ret.append(*pChan0++);
-            }
-        } else if (bytesPerChannel == 2) {
-            // 16-bit multichannel - convert to 8-bit
-            auto pChan0 = gray();  // Use first channel
-            const auto size = width() * height();
-            for (quint32 i = 0; i < size; i++) {
-                quint16 val16 = *reinterpret_cast<const quint16*>(pChan0);
-                ret.append(val16 >> 8);  // Take high byte
-                pChan0 += 2;
-            }
-        } else {
-            qWarning() << "bytesPerChannel" << bytesPerChannel << "not supported for Multichannel mode";
-        }
-        break; }
-    case QPsdFileHeader::Duotone: {
         // Duotone mode - treat as grayscale for display
         // The actual duotone colors are stored in the color mode data section
-        if (bytesPerChannel == 1) {
-            // 8-bit duotone
-            auto pGray = gray();
-            const auto size = width() * height();
-            for (quint32 i = 0; i < size; i++) {
-                ret.append(*pGray++);
-            }
-        } else if (bytesPerChannel == 2) {
-            // 16-bit duotone - convert to 8-bit
-            auto pGray = gray();
-            const auto size = width() * height();
-            for (quint32 i = 0; i < size; i++) {
-                quint16 val16 = *reinterpret_cast<const quint16*>(pGray);
-                ret.append(val16 >> 8);  // Take high byte
-                pGray += 2;
-            }
-        } else {
-            qWarning() << "bytesPerChannel" << bytesPerChannel << "not supported for Duotone mode";
-        }
+        const auto pg = gray();
+        forEachChunk([&](uchar *out, qsizetype pixel, qsizetype count) {
+            if (bytesPerChannel == 1)
+                std::memcpy(out, pg + pixel, count);
+            else // 16-bit - convert to 8-bit by taking the high byte
+                QPsdImageConversion::narrow16to8(out, pg + pixel * 2, count);
+        });
         break; }
     default:
-        qFatal("Color mode %d not supported", colorMode);
+        break;
     }
-    return ret;
+    return true;
 }
 
 QT_END_NAMESPACE
@@ -10,6 +10,7 @@
 QT_BEGIN_NAMESPACE
 
 class QPsdFileHeader;
+class QThreadPool;
 
 class Q_PSDCORE_EXPORT QPsdAbstractImage : public QPsdSection
 {
@@ -32,6 +33,22 @@ public:
     virtual bool hasAlpha() const { return false; }
     QByteArray toImage(QPsdFileHeader::ColorMode colorMode) const;
 
+    /*!
+     * Returns the size of a row of pixels converted by toImage() for
+     * \a colorMode, or 0 if the depth is not supported in that mode.
+     */
+    qsizetype toImageBytesPerLine(QPsdFileHeader::ColorMode colorMode) const;
+
+    /*!
+     * Converts \a rowCount rows starting at \a firstRow the same way as
+     * toImage(), but writes them to \a bits, \a bytesPerLine apart, instead of
+     * allocating a buffer. A \a rowCount of -1 converts up to the last row.
+     * \a bits points to the first converted row, e.g. QImage::scanLine(firstRow),
+     * and \a bytesPerLine must be at least toImageBytesPerLine().
+     * Returns false if nothing or not all of the rows could be converted.
+     */
+    bool toImage(QPsdFileHeader::ColorMode colorMode, uchar *bits, qsizetype bytesPerLine, int firstRow = 0, int rowCount = -1) const;
+
 protected:
     void setWidth(quint32 width);
     void setHeight(quint32 height);
@@ -54,7 +71,9 @@ protected:
         ZipWithPrediction = 3,
     };
     static QByteArray readRLE(QIODevice *source, int height, quint32 *length);
+    static QByteArray decodeRLE(QByteArrayView data, int height, qsizetype bytesPerLine = -1, QThreadPool *pool = nullptr, int byteCountSize = 2);
     static QByteArray readZip(QIODevice *source, quint32 *length);
+    static QByteArray decodeZip(QByteArrayView data, int width, int height, int depth, bool prediction);
 
 private:
     class Private;
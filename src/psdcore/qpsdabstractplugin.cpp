@@ -1,11 +1,23 @@
 // Copyright (C) 2024 Signal Slot Inc.
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
-#include "qpsdabstractplugin.h"
+#include "qpsdabstractplugin_p.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMap>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
 
 class QPsdAbstractPlugin::Private
 {
 public:
+    // plugins are shared by all threads
+    mutable QMutex mutex;
     QByteArray key;
 };
 
@@ -18,12 +30,197 @@ QPsdAbstractPlugin::~QPsdAbstractPlugin() = default;
 
 QByteArray QPsdAbstractPlugin::key() const
 {
+    QMutexLocker locker(&d->mutex);
     return d->key;
 }
 
 void QPsdAbstractPlugin::setKey(const QByteArray &key)
 {
-    if (d->key == key) return;
-    d->key = key;
+    {
+        QMutexLocker locker(&d->mutex);
+        if (d->key == key) return;
+        d->key = key;
+    }
     emit keyChanged(key);
 }
+
+QByteArray QPsdAbstractPlugin::fromFourCC(quint32 key)
+{
+    const auto bigEndian = qToBigEndian(key);
+    return QByteArray(reinterpret_cast<const char *>(&bigEndian), sizeof(bigEndian));
+}
+
+namespace {
+QByteArrayList metaDataKeys(const QJsonObject &json)
+{
+    QByteArrayList ret;
+    const auto metaData = json.value("MetaData"_L1).toObject();
+    const auto jsonKeys = metaData.value("Keys"_L1).toArray();
+    for (const QJsonValue &jsonKey : jsonKeys)
+        ret.append(jsonKey.toString().toLatin1());
+    return ret;
+}
+}
+
+QPsdAbstractPlugin::Registry::Registry(const char *iid, const QDir &dir)
+    : iid(iid)
+{
+    // plugins of a static build, imported with Q_IMPORT_PLUGIN
+    const auto staticPlugins = QPluginLoader::staticPlugins();
+    for (const QStaticPlugin &plugin : staticPlugins) {
+        const auto json = plugin.metaData();
+        if (json.value("IID"_L1).toString() != this->iid)
+            continue;
+        plugins.append({ metaDataKeys(json), plugin, {} });
+    }
+
+    readDirectory(dir);
+
+    instances.reset(new QAtomicPointer<QObject>[plugins.size()]);
+    QMap<quint32, qsizetype> fourCCs;
+    for (qsizetype i = 0; i < plugins.size(); i++) {
+        for (const QByteArray &key : plugins.at(i).keys) {
+            keys.append(key);
+            byKey.insert(key, i);
+            if (key.size() == 4)
+                fourCCs.insert(fourCC(key), i);
+        }
+    }
+    byFourCC.reserve(fourCCs.size());
+    for (auto it = fourCCs.cbegin(); it != fourCCs.cend(); ++it)
+        byFourCC.append({ it.key(), it.value() });
+}
+
+QString QPsdAbstractPlugin::Registry::indexFileName(const QDir &dir, QLatin1StringView iid)
+{
+    const auto cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheDir.isEmpty() || qEnvironmentVariableIsSet("QTPSD_NO_PLUGIN_INDEX"))
+        return {};
+    const auto id = QCryptographicHash::hash(dir.absolutePath().toUtf8() + '\0' + iid.latin1(),
+                                             QCryptographicHash::Sha1).toHex().left(16);
+    return cacheDir + "/qtpsd/plugins-"_L1 + QLatin1StringView(id) + ".json"_L1;
+}
+
+// Reading the metadata of a plugin means opening and scanning the library,
+// for every plugin on every start. The keys are kept in an index instead,
+// which is read again for the plugins whose size or modification time changed.
+void QPsdAbstractPlugin::Registry::readDirectory(const QDir &dir)
+{
+    const auto entries = dir.entryInfoList(
+#ifdef Q_OS_LINUX
+        QStringList() << "*.so"_L1,
+#endif
+#ifdef Q_OS_WIN
+        QStringList() << "*.dll"_L1,
+#endif
+        QDir::Files);
+    if (entries.isEmpty())
+        return;
+
+    const auto indexFileName = Registry::indexFileName(dir, iid);
+    QJsonObject index;
+    if (!indexFileName.isEmpty()) {
+        QFile file(indexFileName);
+        if (file.open(QIODevice::ReadOnly))
+            index = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    QJsonObject updated;
+    for (const QFileInfo &entry : entries) {
+        const auto size = entry.size();
+        const auto lastModified = entry.lastModified().toMSecsSinceEpoch();
+        auto cached = index.value(entry.fileName()).toObject();
+        if (cached.value("size"_L1).toInteger() != size
+            || cached.value("lastModified"_L1).toInteger() != lastModified) {
+            QPluginLoader loader(entry.absoluteFilePath());
+            const auto json = loader.metaData();
+            cached = QJsonObject {
+                { "size"_L1, size },
+                { "lastModified"_L1, lastModified },
+                { "iid"_L1, json.value("IID"_L1) },
+                { "keys"_L1, json.value("MetaData"_L1).toObject().value("Keys"_L1) },
+            };
+        }
+        updated.insert(entry.fileName(), cached);
+
+        if (cached.value("iid"_L1).toString() != iid) {
+            qWarning() << entry.absoluteFilePath() << "is not a plugin of" << iid;
+            continue;
+        }
+        QByteArrayList keys;
+        const auto jsonKeys = cached.value("keys"_L1).toArray();
+        for (const QJsonValue &jsonKey : jsonKeys)
+            keys.append(jsonKey.toString().toLatin1());
+        plugins.append({ keys, std::nullopt, entry.absoluteFilePath() });
+    }
+
+    if (!indexFileName.isEmpty() && updated != index) {
+        QDir().mkpath(QFileInfo(indexFileName).absolutePath());
+        QSaveFile file(indexFileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(updated).toJson(QJsonDocument::Compact));
+            file.commit();
+        }
+    }
+}
+
+QObject *QPsdAbstractPlugin::Registry::instance(qsizetype index)
+{
+    auto ret = instances[index].loadAcquire();
+    if (ret)
+        return ret;
+
+    QMutexLocker locker(&mutex);
+    ret = instances[index].loadRelaxed();
+    if (ret)
+        return ret;
+
+    const auto &plugin = plugins.at(index);
+    if (plugin.staticPlugin) {
+        ret = plugin.staticPlugin->instance();
+    } else {
+        QPluginLoader loader(plugin.fileName);
+        ret = loader.instance();
+        if (!ret) {
+            qFatal() << loader.errorString();
+        }
+    }
+    instances[index].storeRelease(ret);
+    return ret;
+}
+
+QPsdAbstractPlugin::Registry *QPsdAbstractPlugin::registry(const char *iid, const char *subdir)
+{
+    // one registry per interface, alive until the process ends like the plugins
+    static QMutex mutex;
+    static QHash<QByteArray, Registry *> registries;
+    QMutexLocker locker(&mutex);
+    auto &ret = registries[iid];
+    if (!ret)
+        ret = new Registry(iid, qpsdPluginDir(QLatin1StringView(subdir)));
+    return ret;
+}
+
+QByteArrayList QPsdAbstractPlugin::registryKeys(Registry *registry)
+{
+    return registry->keys;
+}
+
+QObject *QPsdAbstractPlugin::lookup(Registry *registry, const QByteArray &key)
+{
+    const auto it = registry->byKey.constFind(key);
+    if (it == registry->byKey.constEnd())
+        return nullptr;
+    return registry->instance(it.value());
+}
+
+QObject *QPsdAbstractPlugin::lookup(Registry *registry, quint32 key)
+{
+    const auto &byFourCC = registry->byFourCC;
+    const auto it = std::lower_bound(byFourCC.cbegin(), byFourCC.cend(), key, [](const auto &entry, quint32 key) {
+        return entry.first < key;
+    });
+    if (it == byFourCC.cend() || it->first != key)
+        return nullptr;
+    return registry->instance(it->second);
+}
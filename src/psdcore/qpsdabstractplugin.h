@@ -31,69 +31,53 @@ public Q_SLOTS:
 Q_SIGNALS:
     void keyChanged(const QByteArray &key);
 
+public:
+    /*!
+     * Returns the 4-character code \a key as a big-endian integer, so that
+     * keys can be compared and switched on as integers. Returns 0 if \a key
+     * is not 4 bytes long.
+     */
+    static constexpr quint32 fourCC(QByteArrayView key) noexcept {
+        return key.size() != 4 ? 0
+                                : quint32(uchar(key[0])) << 24 | quint32(uchar(key[1])) << 16
+                                      | quint32(uchar(key[2])) << 8 | quint32(uchar(key[3]));
+    }
+    static QByteArray fromFourCC(quint32 key);
+
 protected:
+    // The plugins of an interface, those linked in statically and those in
+    // the plugin directory subdir. The keys of the plugins in the directory
+    // come from an index cached next to other caches of the user, a plugin
+    // is only loaded when one of its keys is looked up for the first time.
+    class Registry;
+    static Registry *registry(const char *iid, const char *subdir);
+    static QByteArrayList registryKeys(Registry *registry);
+    static QObject *lookup(Registry *registry, const QByteArray &key);
+    static QObject *lookup(Registry *registry, quint32 key);
+
     template <typename T>
     static QByteArrayList keys(const char *iid, const char *subdir) {
-        static QByteArrayList ret = [&]() {
-            QByteArrayList keys;
-            QDir pluginsDir = qpsdPluginDir(QLatin1StringView(subdir));
-            for (const QString &fileName : pluginsDir.entryList(
-#ifdef Q_OS_LINUX
-                     QStringList() << "*.so"_L1,
-#endif
-#ifdef Q_OS_WIN
-                     QStringList() << "*.dll"_L1,
-#endif
-                     QDir::Files)) {
-                QPluginLoader loader(pluginsDir.absoluteFilePath(fileName));
-                const auto json = loader.metaData();
-                Q_ASSERT(json.value("IID"_L1).toString() == QLatin1StringView(iid));
-                const auto metaData = json.value("MetaData"_L1).toObject();
-                const auto jsonKeys = metaData.value("Keys"_L1).toArray();
-                for (const QJsonValue &jsonKey : jsonKeys) {
-                    keys.append(jsonKey.toString().toUtf8());
-                }
-            }
-            return keys;
-        }();
-        return ret;
+        static Registry *const plugins = registry(iid, subdir);
+        return registryKeys(plugins);
     }
 
     template <typename T>
     static T *plugin(const char *iid, const char *subdir, const QByteArray &key) {
-        static QHash<QByteArray, T *> plugins = [&]() {
-            QHash<QByteArray, T *> ret;
-            QDir pluginsDir = qpsdPluginDir(QLatin1StringView(subdir));
-            for (const QString &fileName : pluginsDir.entryList(
-#ifdef Q_OS_LINUX
-                     QStringList() << "*.so"_L1,
-#endif
-#ifdef Q_OS_WIN
-                     QStringList() << "*.dll"_L1,
-#endif
-                     QDir::Files)) {
-                QPluginLoader loader(pluginsDir.absoluteFilePath(fileName));
-                const auto json = loader.metaData();
-                Q_ASSERT(json.value("IID"_L1).toString() == QLatin1StringView(iid));
-                const auto metaData = json.value("MetaData"_L1).toObject();
-                const auto jsonKeys = metaData.value("Keys"_L1).toArray();
-                QObject *object = loader.instance();
-                if (!object) {
-                    qFatal() << loader.errorString();
-                }
-                auto plugin = qobject_cast<T *>(object);
-                Q_ASSERT(plugin);
-                for (const QJsonValue &jsonKey : jsonKeys) {
-                    ret.insert(jsonKey.toString().toLatin1(), plugin);
-                }
-            }
-            return ret;
-        }();
-
-        auto ret = plugins.value(key);
+        static Registry *const plugins = registry(iid, subdir);
+        auto ret = qobject_cast<T *>(lookup(plugins, key));
         if (ret)
             ret->setKey(key);
-        return qobject_cast<T *>(ret);
+        return ret;
+    }
+
+    // for the parsers of 4-character keys, a binary search over the sorted keys
+    // that leaves the plugin untouched, its key() is not set
+    template <typename T>
+    static T *plugin(const char *iid, const char *subdir, quint32 key) {
+        static Registry *const plugins = registry(iid, subdir);
+        auto ret = lookup(plugins, key);
+        Q_ASSERT(!ret || qobject_cast<T *>(ret));
+        return static_cast<T *>(ret);
     }
 
 private:
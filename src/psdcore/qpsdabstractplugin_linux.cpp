@@ -7,34 +7,39 @@
 
 QDir QPsdAbstractPlugin::qpsdPluginDir(const QString &type)
 {
-    Dl_info info;
-    if (dladdr((void*)&qpsdPluginDir, &info)) {
-        const auto path = info.dli_fname;
-        QFileInfo fi(QString::fromUtf8(path));
-        QDir pluginsDir = fi.absoluteDir();
+    // the search below walks the directories next to the library, once is enough
+    static const QDir root = []() -> QDir {
+        Dl_info info;
+        if (dladdr((void*)&qpsdPluginDir, &info)) {
+            const auto path = info.dli_fname;
+            QFileInfo fi(QString::fromUtf8(path));
+            QDir pluginsDir = fi.absoluteDir();
 
-        std::function<QDir(QDir)> findPluginsDir;
-        findPluginsDir = [&](QDir dir) -> QDir{
-            if (dir.exists("plugins"_L1)) {
-                dir.cd("plugins"_L1);
-                return dir;
-            }
+            std::function<QDir(QDir)> findPluginsDir;
+            findPluginsDir = [&](QDir dir) -> QDir{
+                if (dir.exists("plugins"_L1)) {
+                    dir.cd("plugins"_L1);
+                    return dir;
+                }
 
-            const auto subDirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-            for (const auto &subDir : subDirs) {
-                QDir newDir = dir.absoluteFilePath(subDir);
-                auto ret = findPluginsDir(newDir);
-                if (ret.dirName() == "plugins"_L1)
-                    return ret;
-            }
-            return QDir();
-        };
-        pluginsDir.cdUp();
-        pluginsDir = findPluginsDir(pluginsDir);
-        pluginsDir.cd(type);
-        return pluginsDir;
-    } else {
-        qWarning() << u"dladdrに失敗しました。"_s;
-    }
-    return QDir();
+                const auto subDirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+                for (const auto &subDir : subDirs) {
+                    QDir newDir = dir.absoluteFilePath(subDir);
+                    auto ret = findPluginsDir(newDir);
+                    if (ret.dirName() == "plugins"_L1)
+                        return ret;
+                }
+                return QDir();
+            };
+            pluginsDir.cdUp();
+            return findPluginsDir(pluginsDir);
+        } else {
+            qWarning() << u"dladdrに失敗しました。"_s;
+        }
+        return QDir();
+    }();
+
+    QDir pluginsDir = root;
+    pluginsDir.cd(type);
+    return pluginsDir;
 }
@@ -0,0 +1,63 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDABSTRACTPLUGIN_P_H
+#define QPSDABSTRACTPLUGIN_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtPsdCore/qpsdabstractplugin.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+class Q_PSDCORE_EXPORT QPsdAbstractPlugin::Registry
+{
+public:
+    // the plugins of iid linked in statically and those in dir
+    Registry(const char *iid, const QDir &dir);
+
+    // the index of the keys of the plugins in dir, empty if there is no cache
+    // directory or QTPSD_NO_PLUGIN_INDEX is set
+    static QString indexFileName(const QDir &dir, QLatin1StringView iid);
+
+    QByteArrayList keys;
+    QHash<QByteArray, qsizetype> byKey;
+    // sorted by the 4-character code
+    QList<std::pair<quint32, qsizetype>> byFourCC;
+
+    QObject *instance(qsizetype index);
+
+private:
+    struct Plugin {
+        QByteArrayList keys;
+        // either linked in statically or the path of a library
+        std::optional<QStaticPlugin> staticPlugin;
+        QString fileName;
+    };
+    void readDirectory(const QDir &dir);
+
+    QLatin1StringView iid;
+    QList<Plugin> plugins;
+    // written once under the mutex, read without it
+    std::unique_ptr<QAtomicPointer<QObject>[]> instances;
+    QMutex mutex;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPSDABSTRACTPLUGIN_P_H
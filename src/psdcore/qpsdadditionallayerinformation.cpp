@@ -21,6 +21,10 @@ QPsdAdditionalLayerInformation::QPsdAdditionalLayerInformation()
 {}
 
 QPsdAdditionalLayerInformation::QPsdAdditionalLayerInformation(QIODevice *source, int padding)
+    : QPsdAdditionalLayerInformation(QPsdFileHeader(), source, padding)
+{}
+
+QPsdAdditionalLayerInformation::QPsdAdditionalLayerInformation(const QPsdFileHeader &header, QIODevice *source, int padding)
     : QPsdAdditionalLayerInformation()
 {
     // Additional Layer Information
@@ -43,13 +47,34 @@ QPsdAdditionalLayerInformation::QPsdAdditionalLayerInformation(QIODevice *source
 
     // Length data below, rounded up to an even byte count.
     // (**PSB**, the following keys have a length count of 8 bytes: LMsk, Lr16, Lr32, Layr, Mt16, Mt32, Mtrn, Alph, FMsk, lnk2, FEid, FXid, PxSD.
-    auto length = readU32(source);
+    const quint32 key = QPsdAbstractPlugin::fourCC(d->key);
+    bool longLength = false;
+    switch (key) {
+    case QPsdAbstractPlugin::fourCC("LMsk"):
+    case QPsdAbstractPlugin::fourCC("Lr16"):
+    case QPsdAbstractPlugin::fourCC("Lr32"):
+    case QPsdAbstractPlugin::fourCC("Layr"):
+    case QPsdAbstractPlugin::fourCC("Mt16"):
+    case QPsdAbstractPlugin::fourCC("Mt32"):
+    case QPsdAbstractPlugin::fourCC("Mtrn"):
+    case QPsdAbstractPlugin::fourCC("Alph"):
+    case QPsdAbstractPlugin::fourCC("FMsk"):
+    case QPsdAbstractPlugin::fourCC("lnk2"):
+    case QPsdAbstractPlugin::fourCC("FEid"):
+    case QPsdAbstractPlugin::fourCC("FXid"):
+    case QPsdAbstractPlugin::fourCC("PxSD"):
+        longLength = true;
+        break;
+    default:
+        break;
+    }
+    auto length = readLength(source, header.isPsb() && longLength);
     EnsureSeek es(source, length, padding);
 
-    auto plugin = QPsdAdditionalLayerInformationPlugin::plugin(d->key);
+    auto plugin = QPsdAdditionalLayerInformationPlugin::plugin(key);
     if (plugin) {
         qCDebug(lcQPsdAdditionalLayerInformation) << (void *)source->pos() << d->key << length;
-        d->data = plugin->parse(source, length);
+        d->data = plugin->parse(header, source, length);
         qCDebug(lcQPsdAdditionalLayerInformation) << (void *)source->pos() << d->key << d->data;
     } else {
         QByteArray data;
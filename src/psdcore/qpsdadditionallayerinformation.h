@@ -5,6 +5,7 @@
 #define QPSDADDITIONALLAYERINFORMATION_H
 
 #include <QtPsdCore/qpsdsection.h>
+#include <QtPsdCore/qpsdfileheader.h>
 #include <QtCore/QVariant>
 #include <QtCore/qplugin.h>
 #include <QtCore/qfactoryinterface.h>
@@ -16,6 +17,7 @@ class Q_PSDCORE_EXPORT QPsdAdditionalLayerInformation : public QPsdSection
 public:
     QPsdAdditionalLayerInformation();
     QPsdAdditionalLayerInformation(QIODevice *source, int padding = 0);
+    QPsdAdditionalLayerInformation(const QPsdFileHeader &header, QIODevice *source, int padding = 0);
     QPsdAdditionalLayerInformation(const QPsdAdditionalLayerInformation &other);
     QPsdAdditionalLayerInformation &operator=(const QPsdAdditionalLayerInformation &other);
     ~QPsdAdditionalLayerInformation() override;
@@ -3,6 +3,18 @@
 
 #include "qpsdadditionallayerinformationplugin.h"
 
+#include <limits>
+
 QPsdAdditionalLayerInformationPlugin::QPsdAdditionalLayerInformationPlugin(QObject *parent)
     : QPsdAbstractPlugin(parent)
 {}
+
+QVariant QPsdAdditionalLayerInformationPlugin::parse(const QPsdFileHeader &header, QIODevice *source, quint64 length) const
+{
+    Q_UNUSED(header);
+    if (length > std::numeric_limits<quint32>::max()) {
+        qWarning() << length << "bytes of additional layer information are too large to parse";
+        return {};
+    }
+    return parse(source, quint32(length));
+}
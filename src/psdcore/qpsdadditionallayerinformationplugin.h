@@ -5,6 +5,7 @@
 #define QPSDADDITIONALLAYERINFORMATIONPLUGIN_H
 
 #include <QtPsdCore/qpsdabstractplugin.h>
+#include <QtPsdCore/qpsdfileheader.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -17,6 +18,8 @@ public:
     explicit QPsdAdditionalLayerInformationPlugin(QObject *parent = nullptr);
 
     virtual QVariant parse(QIODevice *source , quint32 length) const = 0;
+    // Override to parse data that depends on the file header, like PSB lengths
+    virtual QVariant parse(const QPsdFileHeader &header, QIODevice *source, quint64 length) const;
 
     static QByteArrayList keys() {
         return QPsdAbstractPlugin::keys<QPsdAdditionalLayerInformationPlugin>(QPsdAdditionalLayerInformationFactoryInterface_iid, "psdadditionallayerinformation");
@@ -24,6 +27,9 @@ public:
     static QPsdAdditionalLayerInformationPlugin *plugin(const QByteArray &key) {
         return QPsdAbstractPlugin::plugin<QPsdAdditionalLayerInformationPlugin>(QPsdAdditionalLayerInformationFactoryInterface_iid, "psdadditionallayerinformation", key);
     }
+    static QPsdAdditionalLayerInformationPlugin *plugin(quint32 key) {
+        return QPsdAbstractPlugin::plugin<QPsdAdditionalLayerInformationPlugin>(QPsdAdditionalLayerInformationFactoryInterface_iid, "psdadditionallayerinformation", key);
+    }
 };
 
 QT_END_NAMESPACE
@@ -3,34 +3,115 @@
 
 #include "qpsdchannelimagedata.h"
 #include "qpsdlayerrecord.h"
+#include "qpsdmappeddevice.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QMutex>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
 class QPsdChannelImageData::Private : public QSharedData
 {
 public:
+    struct Channel {
+        Compression compression = RawData;
+        int width = 0;
+        int height = 0;
+        // 0 if unknown, the channel was parsed without a file header
+        int depth = 0;
+        // size of the RLE byte counts (**PSB** 4 bytes)
+        int byteCountSize = 2;
+        // compressed payload, refers to the file mapping when parsed from a QPsdMappedDevice
+        QByteArray data;
+    };
+
     Private();
-    QHash<QPsdChannelInfo::ChannelID, QByteArray> imageData;
+    Private(const Private &other);
+
+    QByteArray decoded(QPsdChannelInfo::ChannelID channelID) const;
+    QByteArray decode(const Channel &channel) const;
 
     const unsigned char *data(QPsdChannelInfo::ChannelID channelID) const {
-        if (!imageData.contains(channelID))
+        if (!channels.contains(channelID))
             return nullptr;
-        return reinterpret_cast<const unsigned char *>(imageData.value(channelID).constData());
+        return reinterpret_cast<const unsigned char *>(decoded(channelID).constData());
     }
 
+    QHash<QPsdChannelInfo::ChannelID, Channel> channels;
+    // keeps the file mapping alive while channels refer to it
+    QSharedPointer<QFile> mappedFile;
+
+    // channels are decompressed on first access
+    mutable QMutex mutex;
+    mutable QHash<QPsdChannelInfo::ChannelID, QByteArray> imageData;
 };
 
 QPsdChannelImageData::Private::Private()
 {}
 
+QPsdChannelImageData::Private::Private(const Private &other)
+    : QSharedData(other)
+    , channels(other.channels)
+    , mappedFile(other.mappedFile)
+{
+    QMutexLocker locker(&other.mutex);
+    imageData = other.imageData;
+}
+
+QByteArray QPsdChannelImageData::Private::decoded(QPsdChannelInfo::ChannelID channelID) const
+{
+    {
+        QMutexLocker locker(&mutex);
+        auto it = imageData.constFind(channelID);
+        if (it != imageData.constEnd())
+            return it.value();
+    }
+
+    // decode without holding the lock so that channels can be decoded concurrently
+    const auto ret = decode(channels.value(channelID));
+
+    QMutexLocker locker(&mutex);
+    // another thread may have finished the same channel first, keep the cached one
+    // the cached payload is never modified, so pointers into it stay valid
+    auto it = imageData.constFind(channelID);
+    if (it != imageData.constEnd())
+        return it.value();
+    imageData.insert(channelID, ret);
+    return ret;
+}
+
+QByteArray QPsdChannelImageData::Private::decode(const Channel &channel) const
+{
+    switch (channel.compression) {
+    case RawData:
+        return channel.data;
+    case RLE:
+        return decodeRLE(channel.data, channel.height, channel.depth > 0 ? qsizetype(channel.width) * channel.depth / 8 : -1,
+                         nullptr, channel.byteCountSize);
+    case ZipWithPrediction:
+    case ZipWithoutPrediction:
+        return decodeZip(channel.data, channel.width, channel.height, channel.depth, channel.compression == ZipWithPrediction);
+    default:
+        break;
+    }
+    return {};
+}
+
 QPsdChannelImageData::QPsdChannelImageData()
     : QPsdAbstractImage()
     , d(new Private)
 {}
 
 QPsdChannelImageData::QPsdChannelImageData(const QPsdLayerRecord &record, QIODevice *source)
+    : QPsdChannelImageData(QPsdFileHeader(), record, source)
+{}
+
+QPsdChannelImageData::QPsdChannelImageData(const QPsdFileHeader &header, const QPsdLayerRecord &record, QIODevice *source)
     : QPsdChannelImageData()
 {
+    setHeader(header);
     setWidth(record.rect().width());
     setHeight(record.rect().height());
     setOpacity(record.opacity());
@@ -38,9 +119,14 @@ QPsdChannelImageData::QPsdChannelImageData(const QPsdLayerRecord &record, QIODev
     // Channel image data
     // https://www.adobe.com/devnet-apps/photoshop/fileformatashtml/#50577409_26431
 
+    // Only the compressed payload of each channel is kept here.
+    // Decompression happens on first access to the channel.
+    auto mapped = QPsdMappedDevice::fromDevice(source);
+
     for (const auto &channelInfo : record.channelInfo()) {
         auto id = channelInfo.id();
-        auto length = channelInfo.length();
+        // (**PSB** channels can be larger than 4GB)
+        quint64 length = channelInfo.length();
         EnsureSeek es(source, length);
         auto cleanup = qScopeGuard([&] {
             Q_ASSERT(length == 0);
@@ -50,20 +136,34 @@ QPsdChannelImageData::QPsdChannelImageData(const QPsdLayerRecord &record, QIODev
             qWarning() << record.name() << record.blendMode() << id << length << "not supported";
         }
         // Compression. 0 = Raw Data, 1 = RLE compressed, 2 = ZIP without prediction, 3 = ZIP with prediction.
-        Compression compression = static_cast<Compression>(readU16(source, &length));
+        Compression compression = static_cast<Compression>(readU16(source));
+        length = length > 2 ? length - 2 : 0;
 
         if (es.bytesAvailable() <= 0)
             continue;
 
+        Private::Channel channel;
+        channel.compression = compression;
+        // mask channels have a rectangle of their own
+        QRect rect = record.rect();
+        if (id == QPsdChannelInfo::UserSuppliedLayerMask) {
+            rect = record.layerMaskAdjustmentLayerData().rect();
+        } else if (id == QPsdChannelInfo::RealUserSuppliedLayerMask) {
+            rect = record.layerMaskAdjustmentLayerData().realUserMaskRect();
+        }
+        channel.width = rect.width();
+        channel.height = rect.height();
+        channel.depth = header.depth();
+        channel.byteCountSize = header.isPsb() ? 4 : 2;
+
         // Image data.
         switch (compression) {
         case RawData:
             // If the compression code is 0, the image data is just the raw image data,
             // whose size is calculated as (LayerBottom-LayerTop)* (LayerRight-LayerLeft)
             // (from the first field in See Layer records).
-            d->imageData.insert(id, readByteArray(source, length, &length));
             break;
-        case RLE: {
+        case RLE:
             // If the compression code is 1,
             // the image data starts with the byte counts for all the scan lines in the channel
             // (LayerBottom-LayerTop) , with each count stored as a two-byte value.
@@ -71,22 +171,25 @@ QPsdChannelImageData::QPsdChannelImageData(const QPsdLayerRecord &record, QIODev
             // The RLE compressed data follows, with each scan line compressed separately.
             // The RLE compression is the same compression algorithm used by the Macintosh
             // ROM routine PackBits, and the TIFF standard.
-            auto height = record.rect().height();
-            if (id == QPsdChannelInfo::UserSuppliedLayerMask) {
-                height = record.layerMaskAdjustmentLayerData().rect().height();
-            } else if (id == QPsdChannelInfo::RealUserSuppliedLayerMask) {
-                height = record.layerMaskAdjustmentLayerData().realUserMaskRect().height();
-            }
-
-            d->imageData.insert(id, readRLE(source, height, &length));
-            break; }
+            break;
         case ZipWithPrediction:
         case ZipWithoutPrediction:
-            d->imageData.insert(id, readZip(source, &length));
+            // If the compression code is 2 or 3, the image data is a zlib stream. With prediction,
+            // each row is stored as the difference to the previous sample of the row.
             break;
         default:
             qFatal("Compression %d not supported", compression);
         }
+
+        if (mapped) {
+            channel.data = mapped->readRawData(length);
+            d->mappedFile = mapped->mappedFile();
+            length = 0;
+        } else {
+            channel.data = source->read(length);
+            length = 0;
+        }
+        d->channels.insert(id, channel);
         // If the layer's size, and therefore the data, is odd, a pad byte will be inserted at the end of the row.
         // If the layer is an adjustment layer, the channel data is undefined (probably all white.)
     }
@@ -108,19 +211,67 @@ QPsdChannelImageData &QPsdChannelImageData::operator=(const QPsdChannelImageData
 
 QPsdChannelImageData::~QPsdChannelImageData() = default;
 
+QByteArray QPsdChannelImageData::fingerprint() const
+{
+    auto ids = d->channels.keys();
+    std::sort(ids.begin(), ids.end());
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    for (const auto id : ids) {
+        const auto channel = d->channels.value(id);
+        const qint32 header[] = { qint32(id), qint32(channel.compression), channel.width, channel.height, channel.depth };
+        hash.addData(QByteArrayView(reinterpret_cast<const char *>(header), sizeof(header)));
+        hash.addData(channel.data);
+    }
+    return hash.result();
+}
+
 QByteArray QPsdChannelImageData::imageData() const
 {
-    return d->imageData.value(QPsdChannelInfo::Red);
+    return d->channels.contains(QPsdChannelInfo::Red) ? d->decoded(QPsdChannelInfo::Red) : QByteArray();
+}
+
+QList<QPsdChannelInfo::ChannelID> QPsdChannelImageData::channelIds() const
+{
+    return d->channels.keys();
+}
+
+QPsdChannelImageData QPsdChannelImageData::compressedCopy() const
+{
+    QPsdChannelImageData ret(*this);
+    ret.d.reset(new Private);
+    ret.d->channels = d->channels;
+    ret.d->mappedFile = d->mappedFile;
+    return ret;
+}
+
+qsizetype QPsdChannelImageData::decompressedSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    qsizetype ret = 0;
+    for (const auto &data : std::as_const(d->imageData))
+        ret += data.size();
+    return ret;
+}
+
+void QPsdChannelImageData::decompress(QPsdChannelInfo::ChannelID channelID) const
+{
+    if (d->channels.contains(channelID))
+        d->decoded(channelID);
+}
+
+bool QPsdChannelImageData::hasAlpha() const
+{
+    return d->channels.contains(QPsdChannelInfo::TransparencyMask) || d->channels.contains(QPsdChannelInfo::Alpha);
 }
 
 QByteArray QPsdChannelImageData::transparencyMaskData() const
 {
-    return d->imageData.contains(QPsdChannelInfo::TransparencyMask) ? d->imageData.value(QPsdChannelInfo::TransparencyMask) : QByteArray();
+    return d->channels.contains(QPsdChannelInfo::TransparencyMask) ? d->decoded(QPsdChannelInfo::TransparencyMask) : QByteArray();
 }
 
 QByteArray QPsdChannelImageData::userSuppliedLayerMask() const
 {
-    return d->imageData.contains(QPsdChannelInfo::UserSuppliedLayerMask) ? d->imageData.value(QPsdChannelInfo::UserSuppliedLayerMask) : QByteArray();
+    return d->channels.contains(QPsdChannelInfo::UserSuppliedLayerMask) ? d->decoded(QPsdChannelInfo::UserSuppliedLayerMask) : QByteArray();
 }
 
 const unsigned char *QPsdChannelImageData::gray() const
@@ -6,6 +6,7 @@
 
 #include <QtPsdCore/qpsdabstractimage.h>
 #include <QtPsdCore/qpsdfileheader.h>
+#include <QtPsdCore/qpsdchannelinfo.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -16,16 +17,38 @@ class Q_PSDCORE_EXPORT QPsdChannelImageData : public QPsdAbstractImage
 public:
     QPsdChannelImageData();
     QPsdChannelImageData(const QPsdLayerRecord &record, QIODevice *source);
+    QPsdChannelImageData(const QPsdFileHeader &header, const QPsdLayerRecord &record, QIODevice *source);
     QPsdChannelImageData(const QPsdChannelImageData &other);
     QPsdChannelImageData &operator=(const QPsdChannelImageData &other);
     ~QPsdChannelImageData() override;
     void swap(QPsdChannelImageData &other) noexcept { d.swap(other.d); }
 
+    /*!
+     * Returns a copy that shares the compressed channels but none of the
+     * decompressed ones. Channels decompressed through it are kept by the
+     * copy only and freed with it.
+     */
+    QPsdChannelImageData compressedCopy() const;
+
+    /*!
+     * Returns the size in bytes of the decompressed channels kept by this
+     * image data and the copies sharing them.
+     */
+    qsizetype decompressedSize() const;
+
+    QList<QPsdChannelInfo::ChannelID> channelIds() const;
+    void decompress(QPsdChannelInfo::ChannelID channelID) const;
+
     QByteArray imageData() const override;
-    bool hasAlpha() const override { return a(); }
+    bool hasAlpha() const override;
     QByteArray transparencyMaskData() const;
     QByteArray userSuppliedLayerMask() const;
 
+    /*!
+     * Returns a SHA-256 hash of the compressed data of all channels.
+     */
+    QByteArray fingerprint() const;
+
 protected:
     const unsigned char *gray() const override;
     const unsigned char *r() const override;
@@ -5,6 +5,7 @@
 #define QPSDCHANNELINFO_H
 
 #include <QtPsdCore/qpsdsection.h>
+#include <QtPsdCore/qpsdfileheader.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -22,12 +23,13 @@ public:
     };
     QPsdChannelInfo();
     QPsdChannelInfo(QIODevice *source);
+    QPsdChannelInfo(const QPsdFileHeader &header, QIODevice *source);
     QPsdChannelInfo(const QPsdChannelInfo &other);
     QPsdChannelInfo &operator=(const QPsdChannelInfo &other);
     ~QPsdChannelInfo() override;
 
     ChannelID id() const;
-    quint32 length() const;
+    quint64 length() const;
 
 private:
     class Private;
@@ -0,0 +1,44 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDCOMPRESSION_P_H
+#define QPSDCOMPRESSION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtPsdCore/qpsdcoreglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+// Scan line decoders shared by QPsdAbstractImage and QPsdImageDataReader
+namespace QPsdCompression {
+
+// Decompresses a PackBits compressed scan line into dst, which holds exactly dstSize bytes.
+// Bytes not covered by the scan line are zero-filled. Returns false if the scan line
+// is malformed, either reading past its own data or writing past dstSize.
+bool unpackBits(const uchar *src, qsizetype srcSize, uchar *dst, qsizetype dstSize);
+
+// Undoes the horizontal delta of a row of bytes, which is a running sum
+void unpredict8(uchar *p, qsizetype size);
+
+// 16-bit samples are big-endian and the delta is taken between whole samples
+void unpredict16(uchar *p, qsizetype width);
+
+// 32-bit rows store the bytes of all samples as four planes, most significant first,
+// and the delta is taken over the whole row of bytes, scratch holds a row
+void unpredict32(uchar *p, qsizetype width, uchar *scratch);
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QPSDCOMPRESSION_P_H
@@ -38,7 +38,7 @@ void QPsdDescriptor::Private::parse(QIODevice *source, quint32 *length)
         qCDebug(lcQPsdDescriptor) << count;
         auto size = readS32(source, length);
         QByteArray key = readByteArray(source, size == 0 ? 4 : size, length);
-        auto osType = readByteArray(source, 4, length);
+        auto osType = readU32(source, length);
         // load plugin for osType
         auto plugin = QPsdDescriptorPlugin::plugin(osType);
         if (plugin) {
@@ -47,9 +47,9 @@ void QPsdDescriptor::Private::parse(QIODevice *source, quint32 *length)
             if (value.typeId() == QMetaType::QByteArray) {
                 value = value.toByteArray().left(20);
             }
-            qCDebug(lcQPsdDescriptor) << key << osType << value;
+            qCDebug(lcQPsdDescriptor) << key << QPsdAbstractPlugin::fromFourCC(osType) << value;
         } else {
-            qCWarning(lcQPsdDescriptor) << osType << "not supported for" << key.left(4);
+            qCWarning(lcQPsdDescriptor) << QPsdAbstractPlugin::fromFourCC(osType) << "not supported for" << key.left(4);
             break;
         }
     }
@@ -25,6 +25,9 @@ public:
     static QPsdDescriptorPlugin *plugin(const QByteArray &key) {
         return QPsdAbstractPlugin::plugin<QPsdDescriptorPlugin>(QPsdDescriptorFactoryInterface_iid, "psddescriptor", key);
     }
+    static QPsdDescriptorPlugin *plugin(quint32 key) {
+        return QPsdAbstractPlugin::plugin<QPsdDescriptorPlugin>(QPsdDescriptorFactoryInterface_iid, "psddescriptor", key);
+    }
 };
 
 QT_END_NAMESPACE
@@ -40,7 +40,7 @@ QPsdEffectsLayer::QPsdEffectsLayer(QIODevice *source, quint32 *length)
         Q_ASSERT(signature == "8BIM");
         // Effects signatures: OSType key for which effects type to use:
         auto osType = readByteArray(source, 4, length);
-        auto plugin = QPsdEffectsLayerPlugin::plugin(osType);
+        auto plugin = QPsdEffectsLayerPlugin::plugin(QPsdAbstractPlugin::fourCC(osType));
         if (plugin) {
             auto value = plugin->parse(osType, source, length);
             if (value.isNull())
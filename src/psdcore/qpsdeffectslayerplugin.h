@@ -25,6 +25,9 @@ public:
     static QPsdEffectsLayerPlugin *plugin(const QByteArray &key) {
         return QPsdAbstractPlugin::plugin<QPsdEffectsLayerPlugin>(QPsdEffectsLayerPluginFactoryInterface_iid, "psdeffectslayer", key);
     }
+    static QPsdEffectsLayerPlugin *plugin(quint32 key) {
+        return QPsdAbstractPlugin::plugin<QPsdEffectsLayerPlugin>(QPsdEffectsLayerPluginFactoryInterface_iid, "psdeffectslayer", key);
+    }
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,141 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdenginedatadocument.h"
+#include "qpsdenginedatatokenizer.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QStringTokenizer>
+
+QT_BEGIN_NAMESPACE
+
+class QPsdEngineDataDocument::Private : public QSharedData
+{
+public:
+    Private() = default;
+    Private(const Private &other);
+
+    bool find(QStringView path, QPsdEngineDataTokenizer *tokenizer, QPsdEngineDataTokenizer::Token *token) const;
+
+    QByteArray data;
+
+    // values are materialized once per path and shared by all copies
+    mutable QMutex mutex;
+    mutable QHash<QString, QCborValue> values;
+};
+
+QPsdEngineDataDocument::Private::Private(const Private &other)
+    : QSharedData(other)
+    , data(other.data)
+{
+    QMutexLocker locker(&other.mutex);
+    values = other.values;
+}
+
+// leaves the tokenizer after the first token of the value at path, which is
+// returned in token
+bool QPsdEngineDataDocument::Private::find(QStringView path, QPsdEngineDataTokenizer *tokenizer, QPsdEngineDataTokenizer::Token *token) const
+{
+    *token = tokenizer->next();
+    for (const auto segment : QStringTokenizer(path, u'/', Qt::SkipEmptyParts)) {
+        switch (token->type) {
+        case QPsdEngineDataTokenizer::DictionaryStart: {
+            for (;;) {
+                const auto key = tokenizer->next();
+                if (key.type != QPsdEngineDataTokenizer::Name)
+                    return false;
+                *token = tokenizer->next();
+                if (QLatin1StringView(key.data) == segment)
+                    break;
+                if (!tokenizer->skipValue(*token))
+                    return false;
+            }
+            break;
+        }
+        case QPsdEngineDataTokenizer::ArrayStart: {
+            bool ok = false;
+            const int index = segment.toInt(&ok);
+            if (!ok || index < 0)
+                return false;
+            for (int i = 0; i <= index; i++) {
+                *token = tokenizer->next();
+                if (token->type == QPsdEngineDataTokenizer::ArrayEnd)
+                    return false;
+                if (i < index && !tokenizer->skipValue(*token))
+                    return false;
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return token->type != QPsdEngineDataTokenizer::Invalid && token->type != QPsdEngineDataTokenizer::End;
+}
+
+QPsdEngineDataDocument::QPsdEngineDataDocument()
+    : d(new Private)
+{}
+
+QPsdEngineDataDocument::QPsdEngineDataDocument(const QByteArray &data)
+    : QPsdEngineDataDocument()
+{
+    d->data = data;
+}
+
+QPsdEngineDataDocument::QPsdEngineDataDocument(const QPsdEngineDataDocument &other)
+    : d(other.d)
+{}
+
+QPsdEngineDataDocument &QPsdEngineDataDocument::operator=(const QPsdEngineDataDocument &other)
+{
+    if (this != &other)
+        d.operator=(other.d);
+    return *this;
+}
+
+QPsdEngineDataDocument::~QPsdEngineDataDocument() = default;
+
+QByteArray QPsdEngineDataDocument::data() const
+{
+    return d->data;
+}
+
+QCborValue QPsdEngineDataDocument::value(QStringView path) const
+{
+    const QString key = path.toString();
+    {
+        QMutexLocker locker(&d->mutex);
+        const auto it = d->values.constFind(key);
+        if (it != d->values.constEnd())
+            return it.value();
+    }
+
+    // parse without holding the lock so that other paths can be read concurrently
+    QCborValue ret;
+    QPsdEngineDataTokenizer tokenizer(d->data);
+    QPsdEngineDataTokenizer::Token token;
+    if (d->find(path, &tokenizer, &token)) {
+        ret = tokenizer.readValue(token);
+        if (tokenizer.hasError())
+            ret = QCborValue();
+    }
+
+    QMutexLocker locker(&d->mutex);
+    // another thread may have read the same path first, keep the cached one
+    const auto it = d->values.constFind(key);
+    if (it != d->values.constEnd())
+        return it.value();
+    d->values.insert(key, ret);
+    return ret;
+}
+
+bool QPsdEngineDataDocument::contains(QStringView path) const
+{
+    QPsdEngineDataTokenizer tokenizer(d->data);
+    QPsdEngineDataTokenizer::Token token;
+    return d->find(path, &tokenizer, &token);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,49 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDENGINEDATADOCUMENT_H
+#define QPSDENGINEDATADOCUMENT_H
+
+#include <QtPsdCore/qpsdcoreglobal.h>
+#include <QtCore/QCborValue>
+#include <QtCore/QSharedDataPointer>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+ * Gives access to values of EngineData by path without parsing all of it.
+ * A lookup tokenizes the data up to the value, skipping the values before it,
+ * and materializes only that value, which keeps reading a few properties of a
+ * large text layer cheap compared to QPsdEngineDataParser::parseEngineData().
+ *
+ * Values are materialized once per path and shared by all copies of the
+ * document, a value read a second time is returned from the cache.
+ */
+class Q_PSDCORE_EXPORT QPsdEngineDataDocument
+{
+public:
+    QPsdEngineDataDocument();
+    explicit QPsdEngineDataDocument(const QByteArray &data);
+    QPsdEngineDataDocument(const QPsdEngineDataDocument &other);
+    QPsdEngineDataDocument &operator=(const QPsdEngineDataDocument &other);
+    ~QPsdEngineDataDocument();
+
+    QByteArray data() const;
+
+    /*!
+     * Returns the value at \a path, property names separated by '/' such as
+     * "EngineDict/Editor/Text", where a number indexes an array. Returns an
+     * undefined value if there is no such value or the data is invalid up to
+     * it.
+     */
+    QCborValue value(QStringView path) const;
+    bool contains(QStringView path) const;
+
+private:
+    class Private;
+    QSharedDataPointer<Private> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPSDENGINEDATADOCUMENT_H
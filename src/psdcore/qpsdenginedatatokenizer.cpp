@@ -0,0 +1,277 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdenginedatatokenizer.h"
+
+#include <QtCore/QCborArray>
+#include <QtCore/QCborMap>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// the same characters as QChar::isSpace() for Latin-1
+bool isSpace(uchar ch)
+{
+    return ch == ' ' || (ch >= '\t' && ch <= '\r') || ch == 0x85 || ch == 0xa0;
+}
+
+bool isDigit(uchar ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+}
+
+QPsdEngineDataTokenizer::QPsdEngineDataTokenizer(QByteArrayView data)
+    : m_data(data)
+{}
+
+void QPsdEngineDataTokenizer::skipWhitespace()
+{
+    while (m_pos < m_data.size() && isSpace(uchar(m_data.at(m_pos))))
+        ++m_pos;
+}
+
+bool QPsdEngineDataTokenizer::atEnd() const
+{
+    qsizetype pos = m_pos;
+    while (pos < m_data.size() && isSpace(uchar(m_data.at(pos))))
+        ++pos;
+    return pos == m_data.size();
+}
+
+QPsdEngineDataTokenizer::Token QPsdEngineDataTokenizer::error(const QString &message)
+{
+    if (m_errorString.isEmpty())
+        m_errorString = message;
+    return { Invalid, m_data.sliced(m_pos, 0) };
+}
+
+QPsdEngineDataTokenizer::Token QPsdEngineDataTokenizer::next()
+{
+    skipWhitespace();
+    if (m_pos >= m_data.size())
+        return { End, {} };
+
+    const qsizetype start = m_pos;
+    const uchar ch = m_data.at(m_pos);
+    auto token = [&](TokenType type, qsizetype size) {
+        m_pos += size;
+        return Token { type, m_data.sliced(start, size) };
+    };
+
+    switch (ch) {
+    case '<':
+        if (m_data.sliced(m_pos).startsWith("<<"))
+            return token(DictionaryStart, 2);
+        return error("Invalid dictionary start '<<'"_L1);
+    case '>':
+        if (m_data.sliced(m_pos).startsWith(">>"))
+            return token(DictionaryEnd, 2);
+        return error("Invalid dictionary end '>>'"_L1);
+    case '[':
+        return token(ArrayStart, 1);
+    case ']':
+        return token(ArrayEnd, 1);
+    case '/': {
+        qsizetype end = m_pos + 1;
+        while (end < m_data.size() && QChar::fromLatin1(m_data.at(end)).isLetterOrNumber())
+            ++end;
+        if (end == m_pos + 1)
+            return error("Property name is empty"_L1);
+        m_pos = end;
+        return { Name, m_data.sliced(start + 1, end - start - 1) };
+    }
+    case '(': {
+        // the string ends at the first unescaped ')', escaped bytes are kept as they are
+        qsizetype end = m_pos + 1;
+        bool escaped = false;
+        for (; end < m_data.size(); ++end) {
+            const char c = m_data.at(end);
+            if (escaped)
+                escaped = false;
+            else if (c == '\\')
+                escaped = true;
+            else if (c == ')')
+                break;
+        }
+        m_pos = std::min(end + 1, m_data.size());
+        return { String, m_data.sliced(start + 1, end - start - 1) };
+    }
+    default:
+        break;
+    }
+
+    if (ch == 't' || ch == 'T' || ch == 'f' || ch == 'F') {
+        qsizetype end = m_pos;
+        while (end < m_data.size() && QChar::fromLatin1(m_data.at(end)).isLetter())
+            ++end;
+        const auto text = m_data.sliced(start, end - start);
+        if (text.compare("true", Qt::CaseInsensitive) != 0 && text.compare("false", Qt::CaseInsensitive) != 0)
+            return error("Invalid boolean value"_L1);
+        m_pos = end;
+        return { Boolean, text };
+    }
+
+    qsizetype end = m_pos;
+    if (ch == '-')
+        ++end;
+    while (end < m_data.size() && (isDigit(m_data.at(end)) || m_data.at(end) == '.'))
+        ++end;
+    if (end == m_pos || (end == m_pos + 1 && ch == '-'))
+        return error("Number expected but not found"_L1);
+    m_pos = end;
+    return { Number, m_data.sliced(start, end - start) };
+}
+
+bool QPsdEngineDataTokenizer::skipValue(const Token &first)
+{
+    switch (first.type) {
+    case DictionaryStart:
+    case ArrayStart:
+        break;
+    case Name:
+        error("Invalid value type"_L1);
+        return false;
+    case String:
+    case Number:
+    case Boolean:
+        return true;
+    case End:
+        error("Unexpected end of data while parsing value"_L1);
+        return false;
+    default:
+        error("Invalid value type"_L1);
+        return false;
+    }
+
+    // nesting is all that matters, values are not checked against their keys
+    int depth = 1;
+    while (depth > 0) {
+        const auto token = next();
+        switch (token.type) {
+        case DictionaryStart:
+        case ArrayStart:
+            ++depth;
+            break;
+        case DictionaryEnd:
+        case ArrayEnd:
+            --depth;
+            break;
+        case End:
+            error("Unexpected end of data"_L1);
+            return false;
+        case Invalid:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+QCborValue QPsdEngineDataTokenizer::readValue(const Token &first)
+{
+    switch (first.type) {
+    case DictionaryStart: {
+        QCborMap map;
+        for (;;) {
+            const auto key = next();
+            if (key.type == DictionaryEnd)
+                return map;
+            if (key.type == End) {
+                error("Unexpected end of data while parsing dictionary"_L1);
+                return {};
+            }
+            if (key.type != Name) {
+                error("Property name must start with '/'"_L1);
+                return {};
+            }
+            const auto value = readValue(next());
+            if (hasError())
+                return {};
+            map.insert(QString::fromUtf8(key.data), value);
+        }
+    }
+    case ArrayStart: {
+        QCborArray array;
+        for (;;) {
+            const auto token = next();
+            if (token.type == ArrayEnd)
+                return array;
+            if (token.type == End) {
+                error("Unexpected end of data while parsing array"_L1);
+                return {};
+            }
+            const auto value = readValue(token);
+            if (hasError())
+                return {};
+            array.append(value);
+        }
+    }
+    case String:
+        return decodeString(first.data);
+    case Boolean:
+        return first.data.compare("true", Qt::CaseInsensitive) == 0;
+    case Number: {
+        bool ok = false;
+        const double number = first.data.toDouble(&ok);
+        if (!ok) {
+            error("Invalid number format: '%1'"_L1.arg(QLatin1StringView(first.data)));
+            return {};
+        }
+        if (first.data.contains('.'))
+            return number;
+        const qint64 integer = first.data.toLongLong(&ok);
+        return ok ? QCborValue(integer) : QCborValue(number);
+    }
+    case End:
+        error("Unexpected end of data while parsing value"_L1);
+        return {};
+    case Invalid:
+        return {};
+    default:
+        error("Invalid value type"_L1);
+        return {};
+    }
+}
+
+QString QPsdEngineDataTokenizer::decodeString(QByteArrayView data)
+{
+    // ˛ˇ, a byte order mark that went through Mac Roman and UTF-8
+    if (data.startsWith("\xCB\x9B\xCB\x87"))
+        data = data.sliced(4);
+
+    const bool utf16 = data.startsWith("\xFE\xFF");
+    if (utf16)
+        data = data.sliced(2);
+
+    QString ret;
+    ret.reserve(utf16 ? data.size() / 2 : data.size());
+    bool escaped = false;
+    bool odd = false;
+    char16_t unit = 0;
+    for (const char c : data) {
+        if (!escaped && c == '\\') {
+            escaped = true;
+            continue;
+        }
+        escaped = false;
+        if (!utf16) {
+            ret.append(QLatin1Char(c));
+        } else if (!odd) {
+            unit = char16_t(uchar(c)) << 8;
+            odd = true;
+        } else {
+            ret.append(QChar(char16_t(unit | uchar(c))));
+            odd = false;
+        }
+    }
+    // like QStringDecoder, a second byte order mark is dropped too
+    if (utf16 && ret.startsWith(QChar::ByteOrderMark))
+        ret.remove(0, 1);
+    return ret;
+}
+
+QT_END_NAMESPACE
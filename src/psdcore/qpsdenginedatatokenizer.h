@@ -0,0 +1,90 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDENGINEDATATOKENIZER_H
+#define QPSDENGINEDATATOKENIZER_H
+
+#include <QtPsdCore/qpsdcoreglobal.h>
+#include <QtCore/QByteArrayView>
+#include <QtCore/QCborValue>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+ * Splits EngineData, the PostScript-like text of text layers, into tokens
+ * one at a time. Tokens refer to the data passed to the constructor, which
+ * must outlive the tokenizer, and nothing is allocated until a value is
+ * materialized with readValue() or decodeString().
+ */
+class Q_PSDCORE_EXPORT QPsdEngineDataTokenizer
+{
+public:
+    enum TokenType {
+        Invalid,
+        End,
+        DictionaryStart,
+        DictionaryEnd,
+        ArrayStart,
+        ArrayEnd,
+        Name,
+        String,
+        Number,
+        Boolean,
+    };
+
+    struct Token {
+        TokenType type = End;
+        // the name without '/', the string between the parentheses with its
+        // escapes, or the text of a number or boolean
+        QByteArrayView data;
+    };
+
+    explicit QPsdEngineDataTokenizer(QByteArrayView data);
+
+    /*!
+     * Returns the next token and advances past it. Returns an End token at
+     * the end of the data and an Invalid token, setting errorString(), for
+     * anything that does not start a token.
+     */
+    Token next();
+
+    qsizetype position() const { return m_pos; }
+    bool atEnd() const;
+
+    /*!
+     * Skips the rest of the value starting with \a first, which is a whole
+     * dictionary or array if \a first opens one. Returns false on an error.
+     */
+    bool skipValue(const Token &first);
+
+    /*!
+     * Reads the rest of the value starting with \a first. Dictionaries become
+     * QCborMap, arrays QCborArray, strings QString, numbers with a decimal
+     * point double and other numbers integers. Returns an undefined value and
+     * sets errorString() on an error.
+     */
+    QCborValue readValue(const Token &first);
+
+    bool hasError() const { return !m_errorString.isEmpty(); }
+    QString errorString() const { return m_errorString; }
+
+    /*!
+     * Decodes the data of a String token, unescaping it and decoding UTF-16
+     * if it starts with a byte order mark, Latin-1 otherwise.
+     */
+    static QString decodeString(QByteArrayView data);
+
+private:
+    void skipWhitespace();
+    Token error(const QString &message);
+
+    QByteArrayView m_data;
+    qsizetype m_pos = 0;
+    QString m_errorString;
+};
+
+Q_DECLARE_TYPEINFO(QPsdEngineDataTokenizer::Token, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QPSDENGINEDATATOKENIZER_H
@@ -9,6 +9,7 @@ class QPsdFileHeader::Private : public QSharedData
 {
 public:
     Private();
+    quint16 version;
     quint16 channels;
     quint32 height;
     quint32 width;
@@ -17,7 +18,8 @@ public:
 };
 
 QPsdFileHeader::Private::Private()
-    : channels(0)
+    : version(1)
+    , channels(0)
     , height(0)
     , width(0)
     , depth(0)
@@ -44,9 +46,9 @@ QPsdFileHeader::QPsdFileHeader(QIODevice *source)
     }
 
     // Version: always equal to 1. Do not try to read the file if the version does not match this value. (**PSB** version is 2.)
-    const auto version = readU16(source);
-    if (version != 1) {
-        qWarning() << version;
+    d->version = readU16(source);
+    if (d->version != 1 && d->version != 2) {
+        qWarning() << d->version;
         source->close();
         setErrorString("Version error"_L1);
         return;
@@ -58,10 +60,10 @@ QPsdFileHeader::QPsdFileHeader(QIODevice *source)
     // The number of channels in the image, including any alpha channels. Supported range is 1 to 56.
     d->channels = readU16(source);
 
-    // The height of the image in pixels. Supported range is 1 to 30,000.
+    // The height of the image in pixels. Supported range is 1 to 30,000. (**PSB** max of 300,000.)
     d->height = readU32(source);
 
-    // The width of the image in pixels. Supported range is 1 to 30,000
+    // The width of the image in pixels. Supported range is 1 to 30,000. (**PSB** max of 300,000.)
     d->width = readU32(source);
 
     // Depth: the number of bits per channel. Supported values are 1, 8, 16 and 32.
@@ -87,6 +89,16 @@ QPsdFileHeader &QPsdFileHeader::operator=(const QPsdFileHeader &other)
 
 QPsdFileHeader::~QPsdFileHeader() = default;
 
+quint16 QPsdFileHeader::version() const
+{
+    return d->version;
+}
+
+bool QPsdFileHeader::isPsb() const
+{
+    return d->version == 2;
+}
+
 quint16 QPsdFileHeader::channels() const
 {
     return d->channels;
@@ -27,6 +27,8 @@ public:
     QPsdFileHeader &operator=(const QPsdFileHeader &other);
     ~QPsdFileHeader() override;
 
+    quint16 version() const;
+    bool isPsb() const;
     quint16 channels() const;
     quint32 height() const;
     quint32 width() const;
@@ -0,0 +1,407 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdimageconversion_p.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QtEndian>
+#include <QtCore/private/qsimd_p.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+namespace QPsdImageConversion {
+
+namespace {
+
+QAtomicInt maximumSimd(int(Simd::Avx2));
+
+bool useSimd(Simd simd)
+{
+    return maximumSimd.loadRelaxed() >= int(simd);
+}
+
+#ifdef __SSE2__
+void interleave4x8_sse2(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count, uchar xorMask, qsizetype *done)
+{
+    const __m128i mask = _mm_set1_epi8(char(xorMask));
+    qsizetype i = *done;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + i)), mask);
+        const __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(c1 + i)), mask);
+        const __m128i c = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(c2 + i)), mask);
+        const __m128i d = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(c3 + i)), mask);
+        const __m128i abLo = _mm_unpacklo_epi8(a, b);
+        const __m128i abHi = _mm_unpackhi_epi8(a, b);
+        const __m128i cdLo = _mm_unpacklo_epi8(c, d);
+        const __m128i cdHi = _mm_unpackhi_epi8(c, d);
+        auto *out = reinterpret_cast<__m128i *>(dst + i * 4);
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(abLo, cdLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(abLo, cdLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(abHi, cdHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(abHi, cdHi));
+    }
+    *done = i;
+}
+
+void interleave4x16_sse2(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count, qsizetype *done)
+{
+    qsizetype i = *done;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + i * 2));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c1 + i * 2));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c2 + i * 2));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c3 + i * 2));
+        const __m128i abLo = _mm_unpacklo_epi16(a, b);
+        const __m128i abHi = _mm_unpackhi_epi16(a, b);
+        const __m128i cdLo = _mm_unpacklo_epi16(c, d);
+        const __m128i cdHi = _mm_unpackhi_epi16(c, d);
+        auto *out = reinterpret_cast<__m128i *>(dst + i * 8);
+        _mm_storeu_si128(out, _mm_unpacklo_epi32(abLo, cdLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi32(abLo, cdLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi32(abHi, cdHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi32(abHi, cdHi));
+    }
+    *done = i;
+}
+
+void interleave4x32_sse2(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count, qsizetype *done)
+{
+    qsizetype i = *done;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + i * 4));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c1 + i * 4));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c2 + i * 4));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c3 + i * 4));
+        const __m128i abLo = _mm_unpacklo_epi32(a, b);
+        const __m128i abHi = _mm_unpackhi_epi32(a, b);
+        const __m128i cdLo = _mm_unpacklo_epi32(c, d);
+        const __m128i cdHi = _mm_unpackhi_epi32(c, d);
+        auto *out = reinterpret_cast<__m128i *>(dst + i * 16);
+        _mm_storeu_si128(out, _mm_unpacklo_epi64(abLo, cdLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi64(abLo, cdLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi64(abHi, cdHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi64(abHi, cdHi));
+    }
+    *done = i;
+}
+
+void scaleAlpha8_sse2(uchar *dst, const uchar *src, qsizetype count, quint8 opacity, qsizetype *done)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i o = _mm_set1_epi16(opacity);
+    // x / 255 == (x + 1 + (x >> 8)) >> 8 for every product of two bytes
+    auto div255 = [&](__m128i x) {
+        return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+    };
+    qsizetype i = *done;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i lo = div255(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), o));
+        const __m128i hi = div255(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), o));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    *done = i;
+}
+#endif
+
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+QT_FUNCTION_TARGET(SSSE3)
+void interleave3x8_ssse3(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, qsizetype count, qsizetype *done)
+{
+    // every 16 pixels become three blocks of 16 bytes, each gathering bytes from all three sources
+    const __m128i m00 = _mm_setr_epi8(0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128, 5);
+    const __m128i m01 = _mm_setr_epi8(-128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128);
+    const __m128i m02 = _mm_setr_epi8(-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128);
+    const __m128i m10 = _mm_setr_epi8(-128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10, -128);
+    const __m128i m11 = _mm_setr_epi8(5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10);
+    const __m128i m12 = _mm_setr_epi8(-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128);
+    const __m128i m20 = _mm_setr_epi8(-128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128, -128);
+    const __m128i m21 = _mm_setr_epi8(-128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128);
+    const __m128i m22 = _mm_setr_epi8(10, -128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15);
+    qsizetype i = *done;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c1 + i));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c2 + i));
+        auto *out = reinterpret_cast<__m128i *>(dst + i * 3);
+        _mm_storeu_si128(out, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m00), _mm_shuffle_epi8(b, m01)), _mm_shuffle_epi8(c, m02)));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m10), _mm_shuffle_epi8(b, m11)), _mm_shuffle_epi8(c, m12)));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m20), _mm_shuffle_epi8(b, m21)), _mm_shuffle_epi8(c, m22)));
+    }
+    *done = i;
+}
+#endif
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+void interleave4x8_avx2(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count, uchar xorMask, qsizetype *done)
+{
+    const __m256i mask = _mm256_set1_epi8(char(xorMask));
+    qsizetype i = *done;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i a = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c0 + i)), mask);
+        const __m256i b = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c1 + i)), mask);
+        const __m256i c = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c2 + i)), mask);
+        const __m256i d = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c3 + i)), mask);
+        // unpacking works within 128-bit lanes, the lanes are put back in order when storing
+        const __m256i abLo = _mm256_unpacklo_epi8(a, b);
+        const __m256i abHi = _mm256_unpackhi_epi8(a, b);
+        const __m256i cdLo = _mm256_unpacklo_epi8(c, d);
+        const __m256i cdHi = _mm256_unpackhi_epi8(c, d);
+        const __m256i q0 = _mm256_unpacklo_epi16(abLo, cdLo);
+        const __m256i q1 = _mm256_unpackhi_epi16(abLo, cdLo);
+        const __m256i q2 = _mm256_unpacklo_epi16(abHi, cdHi);
+        const __m256i q3 = _mm256_unpackhi_epi16(abHi, cdHi);
+        auto *out = reinterpret_cast<__m256i *>(dst + i * 4);
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(q0, q1, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(q2, q3, 0x20));
+        _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(q0, q1, 0x31));
+        _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(q2, q3, 0x31));
+    }
+    *done = i;
+}
+#endif
+
+// CIE L*a*b* (D65) to sRGB
+// L*a*b* to XYZ is separable, fx, fy and fz are linear in a, L and b, so the
+// per pixel cost is three cubes and a matrix. The sRGB transfer function is
+// the expensive part, it is looked up in a table of linear values.
+struct LabTables
+{
+    // steps of linear intensity in the transfer function tables
+    static constexpr int Gamma8Size = 16384;
+    static constexpr int Gamma16Size = 4096;
+
+    // fy for 8-bit L, and the 8-bit a and b terms of fx and fz
+    float fy8[256];
+    float fa8[256];
+    float fb8[256];
+    // sRGB encoded intensity, rounded to 8-bit, or 16-bit to be interpolated
+    uchar gamma8[Gamma8Size + 1];
+    quint16 gamma16[Gamma16Size + 2];
+
+    LabTables()
+    {
+        for (int i = 0; i < 256; i++) {
+            // L: 0-255 maps to 0-100
+            // a,b: 0-255 maps to -128 to +127 (128 is neutral)
+            fy8[i] = (i * 100.0f / 255.0f + 16.0f) / 116.0f;
+            fa8[i] = (i - 128.0f) / 500.0f;
+            fb8[i] = (i - 128.0f) / 200.0f;
+        }
+        auto encode = [](double c) {
+            return c <= 0.0031308 ? 12.92 * c : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+        };
+        for (int i = 0; i <= Gamma8Size; i++)
+            gamma8[i] = uchar(std::lround(encode(double(i) / Gamma8Size) * 255));
+        for (int i = 0; i <= Gamma16Size; i++)
+            gamma16[i] = quint16(std::lround(encode(double(i) / Gamma16Size) * 65535));
+        // interpolating at the last entry reads one past it
+        gamma16[Gamma16Size + 1] = gamma16[Gamma16Size];
+    }
+
+    static const LabTables &instance()
+    {
+        static const LabTables tables;
+        return tables;
+    }
+
+    static float finv(float t)
+    {
+        constexpr float delta = 6.0f / 29.0f;
+        const float cube = t * t * t;
+        const float line = 3.0f * delta * delta * (t - 4.0f / 29.0f);
+        return t > delta ? cube : line;
+    }
+
+    // linear sRGB from fy, fx - fy and fy - fz
+    static void toLinear(float fy, float fa, float fb, float *rgb)
+    {
+        // D65 illuminant
+        const float X = 0.95047f * finv(fy + fa);
+        const float Y = 1.00000f * finv(fy);
+        const float Z = 1.08883f * finv(fy - fb);
+
+        // XYZ to RGB (sRGB matrix)
+        rgb[0] = 3.2404542f * X - 1.5371385f * Y - 0.4985314f * Z;
+        rgb[1] = -0.9692660f * X + 1.8760108f * Y + 0.0415560f * Z;
+        rgb[2] = 0.0556434f * X - 0.2040259f * Y + 1.0572252f * Z;
+    }
+
+    uchar encode8(float c) const
+    {
+        return gamma8[int(std::clamp(c, 0.0f, 1.0f) * Gamma8Size + 0.5f)];
+    }
+
+    quint16 encode16(float c) const
+    {
+        const float x = std::clamp(c, 0.0f, 1.0f) * Gamma16Size;
+        const int i = int(x);
+        return quint16(gamma16[i] + (gamma16[i + 1] - gamma16[i]) * (x - i) + 0.5f);
+    }
+};
+
+}
+
+void setMaximumSimd(Simd simd)
+{
+    maximumSimd.storeRelaxed(int(simd));
+}
+
+void interleave3x8(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, qsizetype count)
+{
+    qsizetype i = 0;
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (useSimd(Simd::Ssse3) && qCpuHasFeature(SSSE3))
+        interleave3x8_ssse3(dst, c0, c1, c2, count, &i);
+#endif
+    for (; i < count; i++) {
+        dst[i * 3] = c0[i];
+        dst[i * 3 + 1] = c1[i];
+        dst[i * 3 + 2] = c2[i];
+    }
+}
+
+void interleave4x8(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count, uchar xorMask)
+{
+    qsizetype i = 0;
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (useSimd(Simd::Avx2) && qCpuHasFeature(AVX2))
+        interleave4x8_avx2(dst, c0, c1, c2, c3, count, xorMask, &i);
+#endif
+#ifdef __SSE2__
+    if (useSimd(Simd::Sse2))
+        interleave4x8_sse2(dst, c0, c1, c2, c3, count, xorMask, &i);
+#endif
+    for (; i < count; i++) {
+        dst[i * 4] = c0[i] ^ xorMask;
+        dst[i * 4 + 1] = c1[i] ^ xorMask;
+        dst[i * 4 + 2] = c2[i] ^ xorMask;
+        dst[i * 4 + 3] = c3[i] ^ xorMask;
+    }
+}
+
+void interleave3x16(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; i++) {
+        std::memcpy(dst + i * 6, c0 + i * 2, 2);
+        std::memcpy(dst + i * 6 + 2, c1 + i * 2, 2);
+        std::memcpy(dst + i * 6 + 4, c2 + i * 2, 2);
+    }
+}
+
+void interleave4x16(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count)
+{
+    qsizetype i = 0;
+#ifdef __SSE2__
+    if (useSimd(Simd::Sse2))
+        interleave4x16_sse2(dst, c0, c1, c2, c3, count, &i);
+#endif
+    for (; i < count; i++) {
+        std::memcpy(dst + i * 8, c0 + i * 2, 2);
+        std::memcpy(dst + i * 8 + 2, c1 + i * 2, 2);
+        std::memcpy(dst + i * 8 + 4, c2 + i * 2, 2);
+        std::memcpy(dst + i * 8 + 6, c3 + i * 2, 2);
+    }
+}
+
+void interleave3x32(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; i++) {
+        std::memcpy(dst + i * 12, c0 + i * 4, 4);
+        std::memcpy(dst + i * 12 + 4, c1 + i * 4, 4);
+        std::memcpy(dst + i * 12 + 8, c2 + i * 4, 4);
+    }
+}
+
+void interleave4x32(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count)
+{
+    qsizetype i = 0;
+#ifdef __SSE2__
+    if (useSimd(Simd::Sse2))
+        interleave4x32_sse2(dst, c0, c1, c2, c3, count, &i);
+#endif
+    for (; i < count; i++) {
+        std::memcpy(dst + i * 16, c0 + i * 4, 4);
+        std::memcpy(dst + i * 16 + 4, c1 + i * 4, 4);
+        std::memcpy(dst + i * 16 + 8, c2 + i * 4, 4);
+        std::memcpy(dst + i * 16 + 12, c3 + i * 4, 4);
+    }
+}
+
+void scaleAlpha8(uchar *dst, const uchar *src, qsizetype count, quint8 opacity)
+{
+    if (opacity == 0xff) {
+        std::memcpy(dst, src, count);
+        return;
+    }
+    qsizetype i = 0;
+#ifdef __SSE2__
+    if (useSimd(Simd::Sse2))
+        scaleAlpha8_sse2(dst, src, count, opacity, &i);
+#endif
+    for (; i < count; i++)
+        dst[i] = src[i] * opacity / 0xff;
+}
+
+void scaleAlpha16(uchar *dst, const uchar *src, qsizetype count, quint8 opacity)
+{
+    if (opacity == 0xff) {
+        std::memcpy(dst, src, count * 2);
+        return;
+    }
+    for (qsizetype i = 0; i < count; i++) {
+        const quint32 alpha = qFromUnaligned<quint16>(src + i * 2);
+        qToUnaligned<quint16>(alpha * opacity / 0xff, dst + i * 2);
+    }
+}
+
+void scaleAlpha32(uchar *dst, const uchar *src, qsizetype count, quint8 opacity)
+{
+    const float o = static_cast<float>(opacity / 255.0);
+    for (qsizetype i = 0; i < count; i++)
+        qToUnaligned<float>(qFromUnaligned<float>(src + i * 4) * o, dst + i * 4);
+}
+
+void narrow16to8(uchar *dst, const uchar *src, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; i++)
+        dst[i] = qFromUnaligned<quint16>(src + i * 2) >> 8;
+}
+
+void labToRgb8(uchar *dst, const uchar *l, const uchar *a, const uchar *b, qsizetype count)
+{
+    const auto &tables = LabTables::instance();
+    for (qsizetype i = 0; i < count; i++, dst += 3) {
+        float rgb[3];
+        LabTables::toLinear(tables.fy8[l[i]], tables.fa8[a[i]], tables.fb8[b[i]], rgb);
+        dst[0] = tables.encode8(rgb[0]);
+        dst[1] = tables.encode8(rgb[1]);
+        dst[2] = tables.encode8(rgb[2]);
+    }
+}
+
+void labToRgba64(uchar *dst, const uchar *l, const uchar *a, const uchar *b, qsizetype count)
+{
+    const auto &tables = LabTables::instance();
+    for (qsizetype i = 0; i < count; i++, dst += 8) {
+        // L: 0-65535 maps to 0-100
+        // a,b: 0-65535 maps to -128 to +128 (32768 is neutral)
+        const float fy = (qFromBigEndian<quint16>(l + i * 2) * (100.0f / 65535.0f) + 16.0f) / 116.0f;
+        const float fa = (qFromBigEndian<quint16>(a + i * 2) - 32768.0f) / (256.0f * 500.0f);
+        const float fb = (qFromBigEndian<quint16>(b + i * 2) - 32768.0f) / (256.0f * 200.0f);
+        float rgb[3];
+        LabTables::toLinear(fy, fa, fb, rgb);
+        const quint16 rgba[4] = { tables.encode16(rgb[0]), tables.encode16(rgb[1]), tables.encode16(rgb[2]), 0xffff };
+        std::memcpy(dst, rgba, sizeof(rgba));
+    }
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,64 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDIMAGECONVERSION_P_H
+#define QPSDIMAGECONVERSION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtPsdCore/qpsdcoreglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+// Kernels converting planar channel data into interleaved pixels.
+// Each writes count pixels to dst, which must not overlap the sources.
+// The SSE2, SSSE3 and AVX2 variants are selected at runtime.
+namespace QPsdImageConversion {
+
+// the widest instruction set the kernels use if the CPU has it, lowered by
+// the tests to run the narrower variants and the scalar loops on any machine
+enum class Simd {
+    None,
+    Sse2,
+    Ssse3,
+    Avx2,
+};
+Q_PSDCORE_EXPORT void setMaximumSimd(Simd simd);
+
+// 8-bit samples, xorMask is applied to every sample (0xff inverts)
+Q_PSDCORE_EXPORT void interleave3x8(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, qsizetype count);
+Q_PSDCORE_EXPORT void interleave4x8(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count, uchar xorMask = 0);
+
+// 16-bit and 32-bit samples are copied as they are
+Q_PSDCORE_EXPORT void interleave3x16(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, qsizetype count);
+Q_PSDCORE_EXPORT void interleave4x16(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count);
+Q_PSDCORE_EXPORT void interleave3x32(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, qsizetype count);
+Q_PSDCORE_EXPORT void interleave4x32(uchar *dst, const uchar *c0, const uchar *c1, const uchar *c2, const uchar *c3, qsizetype count);
+
+// alpha * opacity / 255, for 16-bit and 32-bit samples in native byte order
+Q_PSDCORE_EXPORT void scaleAlpha8(uchar *dst, const uchar *src, qsizetype count, quint8 opacity);
+Q_PSDCORE_EXPORT void scaleAlpha16(uchar *dst, const uchar *src, qsizetype count, quint8 opacity);
+Q_PSDCORE_EXPORT void scaleAlpha32(uchar *dst, const uchar *src, qsizetype count, quint8 opacity);
+
+// the high byte of 16-bit samples in native byte order
+Q_PSDCORE_EXPORT void narrow16to8(uchar *dst, const uchar *src, qsizetype count);
+
+// CIE L*a*b* (D65) planes to sRGB, to RGB888 from 8-bit samples and to
+// RGBA64 in native byte order, opaque, from 16-bit big endian samples
+Q_PSDCORE_EXPORT void labToRgb8(uchar *dst, const uchar *l, const uchar *a, const uchar *b, qsizetype count);
+Q_PSDCORE_EXPORT void labToRgba64(uchar *dst, const uchar *l, const uchar *a, const uchar *b, qsizetype count);
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QPSDIMAGECONVERSION_P_H
@@ -3,15 +3,82 @@
 
 #include "qpsdimagedata.h"
 #include "qpsdfileheader.h"
+#include "qpsdmappeddevice.h"
+
+#include <QtCore/QMutex>
 
 QT_BEGIN_NAMESPACE
 
 class QPsdImageData::Private : public QSharedData
 {
 public:
-    QByteArray imageData;
+    Private();
+    Private(const Private &other);
+
+    const QByteArray &decoded(QThreadPool *pool = nullptr) const;
+
+    Compression compression = RawData;
+    int width = 0;
+    int height = 0;
+    int depth = 8;
+    int channels = 0;
+    // size of the RLE byte counts (**PSB** 4 bytes)
+    int byteCountSize = 2;
+    // compressed payload, refers to the file mapping when parsed from a QPsdMappedDevice
+    QByteArray data;
+    // keeps the file mapping alive while data refers to it
+    QSharedPointer<QFile> mappedFile;
+
+    // the image data is decompressed on first access
+    mutable QMutex mutex;
+    mutable bool isDecoded = false;
+    mutable QByteArray imageData;
 };
 
+QPsdImageData::Private::Private()
+{}
+
+QPsdImageData::Private::Private(const Private &other)
+    : QSharedData(other)
+    , compression(other.compression)
+    , width(other.width)
+    , height(other.height)
+    , depth(other.depth)
+    , channels(other.channels)
+    , byteCountSize(other.byteCountSize)
+    , data(other.data)
+    , mappedFile(other.mappedFile)
+{
+    QMutexLocker locker(&other.mutex);
+    isDecoded = other.isDecoded;
+    imageData = other.imageData;
+}
+
+const QByteArray &QPsdImageData::Private::decoded(QThreadPool *pool) const
+{
+    QMutexLocker locker(&mutex);
+    if (isDecoded)
+        return imageData;
+
+    switch (compression) {
+    case RawData:
+        imageData = data;
+        break;
+    case RLE: {
+        // bitmap images pack 8 pixels into a byte
+        const qsizetype bytesPerLine = depth == 1 ? (qsizetype(width) + 7) / 8 : qsizetype(width) * depth / 8;
+        imageData = decodeRLE(data, height * channels, bytesPerLine, pool, byteCountSize);
+        break; }
+    case ZipWithPrediction:
+    case ZipWithoutPrediction:
+        // a single deflate stream, nothing to split between threads
+        imageData = decodeZip(data, width, height * channels, depth, compression == ZipWithPrediction);
+        break;
+    }
+    isDecoded = true;
+    return imageData;
+}
+
 QPsdImageData::QPsdImageData()
     : QPsdAbstractImage()
     , d(new Private)
@@ -26,33 +93,57 @@ QPsdImageData::QPsdImageData(const QPsdFileHeader &header, QIODevice *source)
 
     // Image Data Section
     // https://www.adobe.com/devnet-apps/photoshop/fileformatashtml/#50577409_89817
-    quint32 length = source->bytesAvailable();
+    // (**PSB** the image data can be larger than 4GB)
+    quint64 length = source->bytesAvailable();
     auto cleanup = qScopeGuard([&] {
         Q_ASSERT(length == 0);
     });
 
     // Compression method:
     // 0 = Raw image data
-    // 1 = RLE compressed the image data starts with the byte counts for all the scan lines (rows * channels), with each count stored as a two-byte value. The RLE compressed data follows, with each scan line compressed separately. The RLE compression is the same compression algorithm used by the Macintosh ROM routine PackBits , and the TIFF standard.
+    // 1 = RLE compressed the image data starts with the byte counts for all the scan lines (rows * channels), with each count stored as a two-byte value. (**PSB** four-byte value.) The RLE compressed data follows, with each scan line compressed separately. The RLE compression is the same compression algorithm used by the Macintosh ROM routine PackBits , and the TIFF standard.
     // 2 = ZIP without prediction
     // 3 = ZIP with prediction.
-    Compression compression = static_cast<Compression>(readU16(source, &length));
-    // The color data.
-    switch (compression) {
+    d->compression = static_cast<Compression>(readU16(source));
+    length = length > 2 ? length - 2 : 0;
+    switch (d->compression) {
     case RawData:
-        d->imageData = source->readAll();
-        length = 0;
-        break;
     case RLE:
-        d->imageData = readRLE(source, header.height() * header.channels(), &length);
-        break;
     case ZipWithPrediction:
     case ZipWithoutPrediction:
-        d->imageData = readZip(source, &length);
         break;
     default:
         qFatal("not supported");
     }
+    d->width = header.width();
+    d->height = header.height();
+    d->depth = header.depth();
+    d->channels = header.channels();
+    d->byteCountSize = header.isPsb() ? 4 : 2;
+
+    // The color data. It is kept compressed until it is accessed or decompress() is called.
+    if (auto mapped = QPsdMappedDevice::fromDevice(source)) {
+        d->data = mapped->readRawData(length);
+        d->mappedFile = mapped->mappedFile();
+    } else {
+        d->data = source->read(length);
+    }
+    length = 0;
+}
+
+QPsdImageData::QPsdImageData(const QPsdFileHeader &header, int height, const QByteArray &planes)
+    : QPsdImageData()
+{
+    setHeader(header);
+    setWidth(header.width());
+    setHeight(height);
+
+    d->compression = RawData;
+    d->width = header.width();
+    d->height = height;
+    d->depth = header.depth();
+    d->channels = header.channels();
+    d->data = planes;
 }
 
 QPsdImageData::QPsdImageData(const QPsdImageData &other)
@@ -71,14 +162,19 @@ QPsdImageData &QPsdImageData::operator=(const QPsdImageData &other)
 
 QPsdImageData::~QPsdImageData() = default;
 
+void QPsdImageData::decompress(QThreadPool *pool) const
+{
+    d->decoded(pool);
+}
+
 QByteArray QPsdImageData::imageData() const
 {
-    return d->imageData;
+    return d->decoded();
 }
 
 const unsigned char *QPsdImageData::gray() const
 {
-    return reinterpret_cast<const unsigned char *>(d->imageData.constData());
+    return reinterpret_cast<const unsigned char *>(d->decoded().constData());
 }
 
 const unsigned char *QPsdImageData::r() const
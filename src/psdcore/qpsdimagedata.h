@@ -9,6 +9,7 @@
 QT_BEGIN_NAMESPACE
 
 class QPsdFileHeader;
+class QThreadPool;
 
 class Q_PSDCORE_EXPORT QPsdImageData : public QPsdAbstractImage
 {
@@ -20,6 +21,8 @@ public:
     ~QPsdImageData() override;
     void swap(QPsdImageData &other) noexcept { d.swap(other.d); }
 
+    void decompress(QThreadPool *pool = nullptr) const;
+
     QByteArray imageData() const override;
 
 protected:
@@ -33,6 +36,10 @@ protected:
     const unsigned char *k() const override;
 
 private:
+    friend class QPsdImageDataReader;
+    // rows of the image already decompressed into planes, one channel after another
+    QPsdImageData(const QPsdFileHeader &header, int height, const QByteArray &planes);
+
     class Private;
     QSharedDataPointer<Private> d;
 };
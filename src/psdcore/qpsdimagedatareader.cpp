@@ -0,0 +1,426 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdimagedatareader.h"
+#include "qpsdcompression_p.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <zlib.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+enum Compression {
+    RawData = 0,
+    RLE = 1,
+    ZipWithoutPrediction = 2,
+    ZipWithPrediction = 3,
+};
+
+// input read from the file at a time by a ZIP stream
+constexpr qsizetype ZipInputSize = 64 * 1024;
+// rows inflated at a time while skipping to the first row of a band
+constexpr int ZipSkipRows = 64;
+
+}
+
+class QPsdImageDataReader::Private
+{
+public:
+    // the state of the deflate stream at the next row of one channel
+    struct ZipStream {
+        ZipStream() = default;
+        ~ZipStream() {
+            if (initialized)
+                inflateEnd(&stream);
+        }
+        Q_DISABLE_COPY_MOVE(ZipStream)
+
+        z_stream stream = {};
+        bool initialized = false;
+        qint64 inputPos = 0;
+        // next row of the stream, which holds all channels one after another
+        qsizetype row = 0;
+        QByteArray input;
+    };
+
+    template <typename T>
+    bool read(T *value);
+    bool locate();
+    bool readRows(int channel, int firstRow, int rowCount, uchar *dst) const;
+    bool inflateRows(ZipStream *zip, uchar *dst, qsizetype size) const;
+
+    QString fileName;
+    mutable QFile file;
+    QString errorString;
+    QPsdFileHeader header;
+    QPsdColorModeData colorModeData;
+    int bandHeight = 256;
+
+    Compression compression = RawData;
+    qsizetype bytesPerLine = 0;
+    // first byte of the scan lines, after the byte counts of RLE compressed data
+    qint64 dataStart = 0;
+    // RLE: file offsets of all scan lines of all channels, followed by the end of the last one
+    QList<qint64> offsets;
+    // ZIP: one stream per channel, so that a band is read without inflating other channels again
+    mutable std::vector<std::unique_ptr<ZipStream>> zip;
+};
+
+template <typename T>
+bool QPsdImageDataReader::Private::read(T *value)
+{
+    T be;
+    if (file.read(reinterpret_cast<char *>(&be), sizeof(T)) != sizeof(T))
+        return false;
+    *value = qFromBigEndian(be);
+    return true;
+}
+
+bool QPsdImageDataReader::Private::locate()
+{
+    // File Header Section
+    header = QPsdFileHeader(&file);
+    if (!header.errorString().isEmpty() || !file.isOpen()) {
+        errorString = header.errorString();
+        return false;
+    }
+    if (header.width() == 0 || header.height() == 0 || header.channels() == 0) {
+        errorString = "The image is empty"_L1;
+        return false;
+    }
+
+    // Color Mode Data Section
+    colorModeData = QPsdColorModeData(&file);
+
+    // Image Resources Section
+    quint32 resourcesLength = 0;
+    if (!read(&resourcesLength) || !file.seek(file.pos() + resourcesLength)) {
+        errorString = "Image resources are truncated"_L1;
+        return false;
+    }
+
+    // Layer and Mask Information Section (**PSB** length is 8 bytes)
+    quint64 layerAndMaskLength = 0;
+    bool ok;
+    if (header.isPsb()) {
+        ok = read(&layerAndMaskLength);
+    } else {
+        quint32 length = 0;
+        ok = read(&length);
+        layerAndMaskLength = length;
+    }
+    if (!ok || !file.seek(file.pos() + qint64(layerAndMaskLength))) {
+        errorString = "Layer and mask information is truncated"_L1;
+        return false;
+    }
+
+    // Image Data Section
+    // https://www.adobe.com/devnet-apps/photoshop/fileformatashtml/#50577409_89817
+    quint16 method = 0;
+    if (!read(&method)) {
+        errorString = "Image data is missing"_L1;
+        return false;
+    }
+    switch (method) {
+    case RawData:
+    case RLE:
+    case ZipWithoutPrediction:
+    case ZipWithPrediction:
+        compression = static_cast<Compression>(method);
+        break;
+    default:
+        errorString = "Compression method %1 is not supported"_L1.arg(method);
+        return false;
+    }
+
+    const int depth = header.depth();
+    bytesPerLine = depth == 1 ? (qsizetype(header.width()) + 7) / 8 : qsizetype(header.width()) * depth / 8;
+    dataStart = file.pos();
+    const qsizetype rows = qsizetype(header.channels()) * header.height();
+
+    switch (compression) {
+    case RLE: {
+        // the byte counts of all scan lines (**PSB** four-byte values) index every one of them
+        const int byteCountSize = header.isPsb() ? 4 : 2;
+        const QByteArray table = file.read(rows * byteCountSize);
+        if (table.size() != rows * byteCountSize) {
+            errorString = "RLE byte counts are truncated"_L1;
+            return false;
+        }
+        const auto *src = reinterpret_cast<const uchar *>(table.constData());
+        offsets.resize(rows + 1);
+        offsets[0] = file.pos();
+        for (qsizetype y = 0; y < rows; y++) {
+            const qint64 byteCount = byteCountSize == 4 ? qFromBigEndian<quint32>(src + y * 4)
+                                                        : qFromBigEndian<quint16>(src + y * 2);
+            offsets[y + 1] = offsets.at(y) + byteCount;
+        }
+        dataStart = offsets.first();
+        if (offsets.last() > file.size()) {
+            qWarning() << "RLE data is truncated," << offsets.last() - dataStart << "bytes expected,"
+                       << file.size() - dataStart << "available";
+            for (auto &offset : offsets)
+                offset = std::min(offset, file.size());
+        }
+        break; }
+    case ZipWithoutPrediction:
+    case ZipWithPrediction:
+        zip.resize(header.channels());
+        break;
+    case RawData:
+        break;
+    }
+    return true;
+}
+
+bool QPsdImageDataReader::Private::readRows(int channel, int firstRow, int rowCount, uchar *dst) const
+{
+    const qsizetype size = rowCount * bytesPerLine;
+    const qsizetype row = qsizetype(channel) * header.height() + firstRow;
+
+    switch (compression) {
+    case RawData: {
+        qint64 read = 0;
+        if (file.seek(dataStart + row * bytesPerLine))
+            read = std::max<qint64>(0, file.read(reinterpret_cast<char *>(dst), size));
+        if (read < size) {
+            std::memset(dst + read, 0, size - read);
+            return false;
+        }
+        return true; }
+    case RLE: {
+        const qint64 start = offsets.at(row);
+        const qint64 end = offsets.at(row + rowCount);
+        QByteArray packed;
+        if (file.seek(start))
+            packed = file.read(end - start);
+        packed.resize(end - start, '\0');
+        const auto *src = reinterpret_cast<const uchar *>(packed.constData());
+        bool ok = true;
+        for (int y = 0; y < rowCount; y++) {
+            const qint64 from = offsets.at(row + y);
+            if (!QPsdCompression::unpackBits(src + (from - start), offsets.at(row + y + 1) - from, dst + y * bytesPerLine, bytesPerLine))
+                ok = false;
+        }
+        return ok; }
+    case ZipWithoutPrediction:
+    case ZipWithPrediction:
+        break;
+    }
+
+    // rows before the current position of the stream are only reachable from its start
+    auto &stream = zip[channel];
+    if (!stream || stream->row > row) {
+        stream = std::make_unique<ZipStream>();
+        if (inflateInit(&stream->stream) != Z_OK) {
+            stream.reset();
+            std::memset(dst, 0, size);
+            return false;
+        }
+        stream->initialized = true;
+        stream->inputPos = dataStart;
+    }
+
+    bool ok = true;
+    if (stream->row < row) {
+        QByteArray skipped(std::min<qsizetype>(ZipSkipRows, row - stream->row) * bytesPerLine, Qt::Uninitialized);
+        while (ok && stream->row < row) {
+            const qsizetype rows = std::min<qsizetype>(ZipSkipRows, row - stream->row);
+            ok = inflateRows(stream.get(), reinterpret_cast<uchar *>(skipped.data()), rows * bytesPerLine);
+            stream->row += rows;
+        }
+    }
+    if (ok)
+        ok = inflateRows(stream.get(), dst, size);
+    else
+        std::memset(dst, 0, size);
+    stream->row += rowCount;
+    if (!ok) {
+        // start over next time instead of reading from a broken stream
+        stream.reset();
+        return false;
+    }
+
+    if (compression == ZipWithPrediction) {
+        const qsizetype width = header.width();
+        switch (header.depth()) {
+        case 8:
+            for (int y = 0; y < rowCount; y++)
+                QPsdCompression::unpredict8(dst + y * bytesPerLine, width);
+            break;
+        case 16:
+            for (int y = 0; y < rowCount; y++)
+                QPsdCompression::unpredict16(dst + y * bytesPerLine, width);
+            break;
+        case 32: {
+            QByteArray scratch(bytesPerLine, Qt::Uninitialized);
+            for (int y = 0; y < rowCount; y++)
+                QPsdCompression::unpredict32(dst + y * bytesPerLine, width, reinterpret_cast<uchar *>(scratch.data()));
+            break; }
+        default:
+            qWarning() << "ZIP prediction is not supported at depth" << header.depth();
+            break;
+        }
+    }
+    return true;
+}
+
+bool QPsdImageDataReader::Private::inflateRows(ZipStream *zip, uchar *dst, qsizetype size) const
+{
+    z_stream &stream = zip->stream;
+    qsizetype written = 0;
+    while (written < size) {
+        if (stream.avail_in == 0) {
+            zip->input.resize(ZipInputSize);
+            qint64 read = -1;
+            if (file.seek(zip->inputPos))
+                read = file.read(zip->input.data(), zip->input.size());
+            if (read <= 0) {
+                qWarning() << "ZIP data is truncated";
+                break;
+            }
+            zip->inputPos += read;
+            stream.next_in = reinterpret_cast<Bytef *>(zip->input.data());
+            stream.avail_in = uInt(read);
+        }
+
+        stream.next_out = dst + written;
+        stream.avail_out = uInt(std::min<qsizetype>(size - written, std::numeric_limits<uInt>::max()));
+        const auto available = stream.avail_out;
+        const int status = inflate(&stream, Z_NO_FLUSH);
+        written += available - stream.avail_out;
+        if (status == Z_STREAM_END && written < size) {
+            qWarning() << "ZIP data is smaller than the image";
+            break;
+        }
+        if (status != Z_OK && status != Z_STREAM_END) {
+            qWarning() << "ZIP data is malformed";
+            break;
+        }
+    }
+
+    if (written < size) {
+        std::memset(dst + written, 0, size - written);
+        return false;
+    }
+    return true;
+}
+
+QPsdImageDataReader::QPsdImageDataReader()
+    : d(new Private)
+{}
+
+QPsdImageDataReader::QPsdImageDataReader(const QString &fileName)
+    : QPsdImageDataReader()
+{
+    d->fileName = fileName;
+}
+
+QPsdImageDataReader::~QPsdImageDataReader() = default;
+
+QString QPsdImageDataReader::fileName() const
+{
+    return d->fileName;
+}
+
+void QPsdImageDataReader::setFileName(const QString &fileName)
+{
+    if (d->fileName == fileName)
+        return;
+    close();
+    d->fileName = fileName;
+}
+
+bool QPsdImageDataReader::open()
+{
+    close();
+    d->errorString.clear();
+    d->file.setFileName(d->fileName);
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        d->errorString = d->file.errorString();
+        return false;
+    }
+    if (!d->locate()) {
+        qWarning() << d->fileName << d->errorString;
+        d->file.close();
+        return false;
+    }
+    return true;
+}
+
+void QPsdImageDataReader::close()
+{
+    d->file.close();
+    d->offsets.clear();
+    d->zip.clear();
+}
+
+bool QPsdImageDataReader::isOpen() const
+{
+    return d->file.isOpen();
+}
+
+QString QPsdImageDataReader::errorString() const
+{
+    return d->errorString;
+}
+
+QPsdFileHeader QPsdImageDataReader::header() const
+{
+    return d->header;
+}
+
+QPsdColorModeData QPsdImageDataReader::colorModeData() const
+{
+    return d->colorModeData;
+}
+
+int QPsdImageDataReader::bandHeight() const
+{
+    return d->bandHeight;
+}
+
+void QPsdImageDataReader::setBandHeight(int bandHeight)
+{
+    d->bandHeight = std::max(1, bandHeight);
+}
+
+int QPsdImageDataReader::bandCount() const
+{
+    if (!isOpen())
+        return 0;
+    return int((qint64(d->header.height()) + d->bandHeight - 1) / d->bandHeight);
+}
+
+QPsdImageData QPsdImageDataReader::readBand(int index) const
+{
+    if (index < 0 || index >= bandCount())
+        return QPsdImageData();
+
+    const int firstRow = index * d->bandHeight;
+    const int rowCount = std::min<qint64>(d->bandHeight, qint64(d->header.height()) - firstRow);
+    const qsizetype planeSize = rowCount * d->bytesPerLine;
+    QByteArray planes(planeSize * d->header.channels(), Qt::Uninitialized);
+    auto *dst = reinterpret_cast<uchar *>(planes.data());
+    bool ok = true;
+    for (int channel = 0; channel < d->header.channels(); channel++) {
+        if (!d->readRows(channel, firstRow, rowCount, dst + channel * planeSize))
+            ok = false;
+    }
+    if (!ok)
+        qWarning() << "Rows" << firstRow << "to" << firstRow + rowCount << "of" << d->fileName << "are incomplete";
+
+    return QPsdImageData(d->header, rowCount, planes);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,75 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDIMAGEDATAREADER_H
+#define QPSDIMAGEDATAREADER_H
+
+#include <QtPsdCore/qpsdcolormodedata.h>
+#include <QtPsdCore/qpsdfileheader.h>
+#include <QtPsdCore/qpsdimagedata.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+ * Reads the merged image of a PSD file in bands of rows, without holding the
+ * whole image in memory. Only the scan lines of the requested band are read
+ * from the file and decompressed, so memory use depends on the band height
+ * and the width of the image, not on its height.
+ *
+ * RLE compressed and raw image data are read in any order. ZIP compressed
+ * image data is a single stream per file and is best read from the first
+ * band to the last, reading an earlier band inflates the stream again from
+ * its start.
+ */
+class Q_PSDCORE_EXPORT QPsdImageDataReader
+{
+public:
+    QPsdImageDataReader();
+    explicit QPsdImageDataReader(const QString &fileName);
+    ~QPsdImageDataReader();
+
+    QString fileName() const;
+    void setFileName(const QString &fileName);
+
+    /*!
+     * Opens the file and locates the image data section, reading the file
+     * header, the color mode data and the scan line byte counts of RLE
+     * compressed data. Returns false and sets errorString() on failure.
+     */
+    bool open();
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    QPsdFileHeader header() const;
+    QPsdColorModeData colorModeData() const;
+
+    /*!
+     * Returns the number of rows of a band. Defaults to 256.
+     */
+    int bandHeight() const;
+    void setBandHeight(int bandHeight);
+
+    /*!
+     * Returns the number of bands of the image, the last one may have fewer
+     * rows than bandHeight().
+     */
+    int bandCount() const;
+
+    /*!
+     * Returns the rows of band \a index as image data of the width of the
+     * image and the height of the band. Its toImage() converts them the same
+     * way as the rows of QPsdParser::imageData(). Returns empty image data if
+     * the reader is not open or \a index is out of range.
+     */
+    QPsdImageData readBand(int index) const;
+
+private:
+    Q_DISABLE_COPY(QPsdImageDataReader)
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPSDIMAGEDATAREADER_H
@@ -57,4 +57,16 @@ QList<QPsdImageResourceBlock> QPsdImageResources::imageResourceBlocks() const
     return d->imageResourceBlocks;
 }
 
+QPsdThumbnail QPsdImageResources::thumbnail() const
+{
+    const QPsdImageResourceBlock *legacy = nullptr;
+    for (const auto &block : std::as_const(d->imageResourceBlocks)) {
+        if (block.id() == 1036)
+            return QPsdThumbnail(block);
+        if (block.id() == 1033 && !legacy)
+            legacy = &block;
+    }
+    return legacy ? QPsdThumbnail(*legacy) : QPsdThumbnail();
+}
+
 QT_END_NAMESPACE
@@ -6,6 +6,7 @@
 
 #include <QtPsdCore/qpsdsection.h>
 #include <QtPsdCore/qpsdimageresourceblock.h>
+#include <QtPsdCore/qpsdthumbnail.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -20,6 +21,13 @@ public:
 
     QList<QPsdImageResourceBlock> imageResourceBlocks() const;
 
+    /*!
+     * Returns the thumbnail embedded in resource 1036, or in resource 1033
+     * of files written by Photoshop 4.0. The thumbnail is not valid if the
+     * file has none.
+     */
+    QPsdThumbnail thumbnail() const;
+
 private:
     class Private;
     QSharedDataPointer<Private> d;
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qpsdlayerandmaskinformation.h"
+#include "qpsdfileheader.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -23,23 +24,27 @@ QPsdLayerAndMaskInformation::QPsdLayerAndMaskInformation()
 {}
 
 QPsdLayerAndMaskInformation::QPsdLayerAndMaskInformation(QIODevice *source)
+    : QPsdLayerAndMaskInformation(QPsdFileHeader(), source)
+{}
+
+QPsdLayerAndMaskInformation::QPsdLayerAndMaskInformation(const QPsdFileHeader &header, QIODevice *source)
     : QPsdLayerAndMaskInformation()
 {
     // Layer and Mask Information Section
     // https://www.adobe.com/devnet-apps/photoshop/fileformatashtml/#50577409_75067
 
     // Length of the layer and mask information section. (**PSB** length is 8 bytes.)
-    auto length = readU32(source);
+    auto length = readLength(source, header.isPsb());
     EnsureSeek es(source, length);
 
     if (length == 0) {
         return;
     }
-    d->layerInfo = QPsdLayerInfo(source);
+    d->layerInfo = QPsdLayerInfo(header, source);
     d->globalLayerMaskInfo = QPsdGlobalLayerMaskInfo(source);
 
     while (es.bytesAvailable() > 12) {
-        QPsdAdditionalLayerInformation ali(source, 4);
+        QPsdAdditionalLayerInformation ali(header, source, 4);
         d->additionalLayerInformation.insert(ali.key(), ali.data());
     }
 }
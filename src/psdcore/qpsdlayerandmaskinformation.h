@@ -16,6 +16,7 @@ class Q_PSDCORE_EXPORT QPsdLayerAndMaskInformation : public QPsdSection
 public:
     QPsdLayerAndMaskInformation();
     QPsdLayerAndMaskInformation(QIODevice *source);
+    QPsdLayerAndMaskInformation(const QPsdFileHeader &header, QIODevice *source);
     QPsdLayerAndMaskInformation(const QPsdLayerAndMaskInformation &other);
     QPsdLayerAndMaskInformation &operator=(const QPsdLayerAndMaskInformation &other);
     ~QPsdLayerAndMaskInformation() override;
@@ -10,7 +10,7 @@ class QPsdLayerInfo::Private : public QSharedData
 {
 public:
     Private();
-    void parse(QIODevice *source, quint32 length);
+    void parse(const QPsdFileHeader &header, QIODevice *source, quint64 length);
 
     QList<QPsdLayerRecord> records;
     QList<QPsdChannelImageData> channelImageData;
@@ -19,18 +19,18 @@ public:
 QPsdLayerInfo::Private::Private()
 {}
 
-void QPsdLayerInfo::Private::parse(QIODevice *source, quint32 length)
+void QPsdLayerInfo::Private::parse(const QPsdFileHeader &header, QIODevice *source, quint64 length)
 {
     EnsureSeek es(source, length);
 
     const auto count = readS16(source);
 
     for (int i = 0; i < std::abs(count); i++) {
-        records.append(QPsdLayerRecord(source));
+        records.append(QPsdLayerRecord(header, source));
     }
 
     for (const QPsdLayerRecord &record : records) {
-        QPsdChannelImageData imageData(record, source);
+        QPsdChannelImageData imageData(header, record, source);
         channelImageData.append(imageData);
     }
 }
@@ -41,20 +41,28 @@ QPsdLayerInfo::QPsdLayerInfo()
 {}
 
 QPsdLayerInfo::QPsdLayerInfo(QIODevice *source)
+    : QPsdLayerInfo(QPsdFileHeader(), source)
+{}
+
+QPsdLayerInfo::QPsdLayerInfo(QIODevice *source, quint32 length)
+    : QPsdLayerInfo(QPsdFileHeader(), source, length)
+{}
+
+QPsdLayerInfo::QPsdLayerInfo(const QPsdFileHeader &header, QIODevice *source)
     : QPsdLayerInfo()
 {
     // Layer info
     // https://www.adobe.com/devnet-apps/photoshop/fileformatashtml/#50577409_16000
 
     // Length of the layers info section, rounded up to a multiple of 2. (**PSB** length is 8 bytes.)
-    auto length = readU32(source);
-    d->parse(source, length);
+    auto length = readLength(source, header.isPsb());
+    d->parse(header, source, length);
 }
 
-QPsdLayerInfo::QPsdLayerInfo(QIODevice *source, quint32 length)
+QPsdLayerInfo::QPsdLayerInfo(const QPsdFileHeader &header, QIODevice *source, quint64 length)
     : QPsdLayerInfo()
 {
-    d->parse(source, length);
+    d->parse(header, source, length);
 }
 
 QPsdLayerInfo::QPsdLayerInfo(const QPsdLayerInfo &other)
@@ -16,6 +16,8 @@ public:
     QPsdLayerInfo();
     QPsdLayerInfo(QIODevice *source);
     QPsdLayerInfo(QIODevice *source, quint32 length);
+    QPsdLayerInfo(const QPsdFileHeader &header, QIODevice *source);
+    QPsdLayerInfo(const QPsdFileHeader &header, QIODevice *source, quint64 length);
     QPsdLayerInfo(const QPsdLayerInfo &other);
     QPsdLayerInfo &operator=(const QPsdLayerInfo &other);
     ~QPsdLayerInfo() override;
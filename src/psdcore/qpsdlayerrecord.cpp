@@ -3,6 +3,9 @@
 
 #include "qpsdlayerrecord.h"
 #include "qpsdadditionallayerinformation.h"
+#include "qpsdmappeddevice.h"
+
+#include <QtCore/QCryptographicHash>
 
 QT_BEGIN_NAMESPACE
 
@@ -21,6 +24,10 @@ public:
     QByteArray name;
     QHash<QByteArray, QVariant> additionalLayerInformation;
     QPsdChannelImageData imageData;
+    // the record as stored in the file, hashed by fingerprint() on demand;
+    // refers to the file mapping when parsed from a QPsdMappedDevice
+    QByteArray recordData;
+    QSharedPointer<QFile> mappedFile;
 };
 
 QPsdLayerRecord::Private::Private()
@@ -35,11 +42,17 @@ QPsdLayerRecord::QPsdLayerRecord()
 {}
 
 QPsdLayerRecord::QPsdLayerRecord(QIODevice *source)
+    : QPsdLayerRecord(QPsdFileHeader(), source)
+{}
+
+QPsdLayerRecord::QPsdLayerRecord(const QPsdFileHeader &header, QIODevice *source)
     : QPsdLayerRecord()
 {
     // Layer records
     // https://www.adobe.com/devnet-apps/photoshop/fileformatashtml/#50577409_13084
 
+    const qint64 start = source->isSequential() ? -1 : source->pos();
+
     // Rectangle containing the contents of the layer. Specified as top, left, bottom, right coordinates
     d->rect = readRectangle(source);
 
@@ -48,7 +61,7 @@ QPsdLayerRecord::QPsdLayerRecord(QIODevice *source)
 
     // Channel information.
     for (int i = 0; i < channels; i++) {
-        d->channelInfo.append(QPsdChannelInfo(source));
+        d->channelInfo.append(QPsdChannelInfo(header, source));
     }
 
     // Blend mode signature: '8BIM'
@@ -81,20 +94,34 @@ QPsdLayerRecord::QPsdLayerRecord(QIODevice *source)
 
     // Length of the extra data field ( = the total length of the next five fields).
     auto length = readU32(source);
-    EnsureSeek es(source, length);
+    {
+        EnsureSeek es(source, length);
 
-    // Layer mask data: See See Layer mask / adjustment layer data for structure. Can be 40 bytes, 24 bytes, or 4 bytes if no layer mask.
-    d->layerMaskAdjustmentLayerData = QPsdLayerMaskAdjustmentLayerData(source);
+        // Layer mask data: See See Layer mask / adjustment layer data for structure. Can be 40 bytes, 24 bytes, or 4 bytes if no layer mask.
+        d->layerMaskAdjustmentLayerData = QPsdLayerMaskAdjustmentLayerData(source);
 
-    // Layer blending ranges: See See Layer blending ranges data.
-    d->layerBlendingRangesData = QPsdLayerBlendingRangesData(source);
+        // Layer blending ranges: See See Layer blending ranges data.
+        d->layerBlendingRangesData = QPsdLayerBlendingRangesData(source);
 
-    // Layer name: Pascal string, padded to a multiple of 4 bytes.
-    d->name = readPascalString(source, 4);
+        // Layer name: Pascal string, padded to a multiple of 4 bytes.
+        d->name = readPascalString(source, 4);
 
-    while (es.bytesAvailable() > 12) {
-        QPsdAdditionalLayerInformation ali(source);
-        d->additionalLayerInformation.insert(ali.key(), ali.data());
+        while (es.bytesAvailable() > 12) {
+            QPsdAdditionalLayerInformation ali(header, source);
+            d->additionalLayerInformation.insert(ali.key(), ali.data());
+        }
+    }
+
+    if (start >= 0) {
+        const qint64 end = source->pos();
+        source->seek(start);
+        if (auto mapped = QPsdMappedDevice::fromDevice(source)) {
+            d->recordData = mapped->readRawData(end - start);
+            d->mappedFile = mapped->mappedFile();
+        } else {
+            d->recordData = source->read(end - start);
+        }
+        source->seek(end);
     }
 }
 
@@ -184,6 +211,14 @@ QPsdChannelImageData QPsdLayerRecord::imageData() const
     return d->imageData;
 }
 
+QByteArray QPsdLayerRecord::fingerprint() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(d->recordData);
+    hash.addData(d->imageData.fingerprint());
+    return hash.result();
+}
+
 void QPsdLayerRecord::setImageData(const QPsdChannelImageData &imageData)
 {
     d->imageData = imageData;
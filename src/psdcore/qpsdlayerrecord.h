@@ -24,6 +24,7 @@ public:
 
     QPsdLayerRecord();
     QPsdLayerRecord(QIODevice *source);
+    QPsdLayerRecord(const QPsdFileHeader &header, QIODevice *source);
     QPsdLayerRecord(const QPsdLayerRecord &other);
     QPsdLayerRecord &operator=(const QPsdLayerRecord &other);
     ~QPsdLayerRecord() override;
@@ -46,6 +47,14 @@ public:
     QPsdChannelImageData imageData() const;
     void setImageData(const QPsdChannelImageData &imageData);
 
+    /*!
+     * Returns a SHA-256 hash of the record as stored in the file and of the
+     * compressed channel image data of the layer. It changes whenever the
+     * layer is edited. Records not read from a random access device only
+     * hash their image data. The hash is computed on every call.
+     */
+    QByteArray fingerprint() const;
+
 private:
     class Private;
     QSharedDataPointer<Private> d;
@@ -22,6 +22,7 @@ public:
         qint32 parentNodeIndex;
         enum FolderType folderType;
         bool isCloseFolder;
+        int row = -1;
     };
 
     struct IndexInfo {
@@ -33,6 +34,8 @@ public:
     ~Private();
 
     bool isValidIndex(const QModelIndex &index) const;
+    void buildChildLists();
+    const QList<qint32> &childNodes(qint32 parentNodeIndex) const;
 
     const ::QPsdLayerTreeItemModel *q;
     QString fileName;
@@ -42,6 +45,11 @@ public:
     QPsdFileHeader fileHeader;
     QList<QPsdLayerRecord> layerRecords;
     QList<Node> treeNodeList;
+    // node indexes of the children of every node in row order, topmost layer first,
+    // at parentNodeIndex + 1 so that the root is at 0
+    QList<QList<qint32>> children;
+    // rows of every node, section dividers are the last child of a folder but not a row
+    QList<int> rowCounts;
     QList<int> groupIDs;
     QMultiMap<int, IndexInfo> groupsMap;
     QList<IndexInfo> clippingMasks;
@@ -62,6 +70,37 @@ bool QPsdLayerTreeItemModel::Private::isValidIndex(const QModelIndex &index) con
     return index.isValid() && index.model() == q;
 }
 
+void QPsdLayerTreeItemModel::Private::buildChildLists()
+{
+    children = QList<QList<qint32>>(treeNodeList.size() + 1);
+    rowCounts = QList<int>(treeNodeList.size() + 1, -1);
+    // rows run from the top of the layer stack, which is the end of the record list
+    for (qint32 i = treeNodeList.size() - 1; i >= 0; i--) {
+        auto &node = treeNodeList[i];
+        if (node.parentNodeIndex < -1 || node.parentNodeIndex >= treeNodeList.size()) {
+            qWarning() << "layer" << i << "has an invalid parent" << node.parentNodeIndex;
+            continue;
+        }
+        auto &siblings = children[node.parentNodeIndex + 1];
+        node.row = siblings.size();
+        siblings.append(i);
+        if (node.isCloseFolder && rowCounts.at(node.parentNodeIndex + 1) < 0)
+            rowCounts[node.parentNodeIndex + 1] = node.row;
+    }
+    for (qsizetype i = 0; i < rowCounts.size(); i++) {
+        if (rowCounts.at(i) < 0)
+            rowCounts[i] = children.at(i).size();
+    }
+}
+
+const QList<qint32> &QPsdLayerTreeItemModel::Private::childNodes(qint32 parentNodeIndex) const
+{
+    static const QList<qint32> none;
+    if (parentNodeIndex < -1 || parentNodeIndex + 1 >= children.size())
+        return none;
+    return children.at(parentNodeIndex + 1);
+}
+
 QPsdLayerTreeItemModel::QPsdLayerTreeItemModel(QObject *parent)
     : QAbstractItemModel(parent), d(new Private(this))
 {
@@ -96,20 +135,12 @@ QModelIndex QPsdLayerTreeItemModel::index(int row, int column, const QModelIndex
         parentNodeIndex = parent.internalId();
     }
 
-    int r = -1;
-    int i = d->treeNodeList.size();
-    for (auto it = d->treeNodeList.crbegin(); it != d->treeNodeList.crend(); ++it) {
-        const auto node = *it;
-        i--;
-        if (node.parentNodeIndex == parentNodeIndex) {
-            r++;
-            if (r == row) {
-                return createIndex(row, column, i);
-            }
-        }
+    const auto &children = d->childNodes(parentNodeIndex);
+    if (row < 0 || children.size() <= row) {
+        return {};
     }
 
-    return {};
+    return createIndex(row, column, children.at(row));
 }
 
 QModelIndex QPsdLayerTreeItemModel::parent(const QModelIndex &index) const
@@ -129,23 +160,8 @@ QModelIndex QPsdLayerTreeItemModel::parent(const QModelIndex &index) const
     if (parentNodeIndex < 0 || d->treeNodeList.size() <= parentNodeIndex) {
         return {};
     }
-    const auto &parentNode = d->treeNodeList.at(parentNodeIndex);
-    qint32 grandParentNodeIndex = parentNode.parentNodeIndex;
 
-    int r = -1;
-    int i = d->treeNodeList.size();
-    for (auto it = d->treeNodeList.crbegin(); it != d->treeNodeList.crend(); ++it) {
-        const auto node = *it;
-        i--;
-        if (node.parentNodeIndex == grandParentNodeIndex) {
-            r++;
-            if (i == parentNodeIndex) {
-                return createIndex(r, 0, i);
-            }
-        }
-    }
-
-    return {};
+    return createIndex(d->treeNodeList.at(parentNodeIndex).row, 0, parentNodeIndex);
 }
 
 int QPsdLayerTreeItemModel::rowCount(const QModelIndex &parent) const
@@ -155,20 +171,11 @@ int QPsdLayerTreeItemModel::rowCount(const QModelIndex &parent) const
     }
 
     qint32 parentNodeIndex = parent.isValid() ? parent.internalId() : -1;
-    int count = 0;
-    for (auto it = d->treeNodeList.crbegin(); it != d->treeNodeList.crend(); ++it) {
-        const auto node = *it;
-
-        if (node.parentNodeIndex == parentNodeIndex) {
-            if (node.isCloseFolder) {
-                return count;
-            }
-
-            count++;
-        }
+    if (parentNodeIndex < -1 || d->rowCounts.size() <= parentNodeIndex + 1) {
+        return 0;
     }
 
-    return count;
+    return d->rowCounts.at(parentNodeIndex + 1);
 }
 
 int QPsdLayerTreeItemModel::columnCount(const QModelIndex &parent) const
@@ -240,6 +247,8 @@ void QPsdLayerTreeItemModel::fromParser(const QPsdParser &parser)
     beginResetModel();
 
     d->treeNodeList.clear();
+    d->children.clear();
+    d->rowCounts.clear();
     d->groupIDs.clear();
     d->groupsMap.clear();
     d->clippingMasks.clear();
@@ -261,6 +270,9 @@ void QPsdLayerTreeItemModel::fromParser(const QPsdParser &parser)
                 d->groupIDs.append(id);
             }
             break; }
+        case 1033: // (Photoshop 4.0) Thumbnail resource, see QPsdImageResources::thumbnail()
+        case 1036: // (Photoshop 5.0) Thumbnail resource, see QPsdImageResources::thumbnail()
+            break;
         case 1082: // (Photoshop CS5) Print Information. 4 bytes (descriptor version = 16), Descriptor (see See Descriptor structure) Information about the current print settings in the document. The color management options.
         case 1083: // (Photoshop CS5) Print Style. 4 bytes (descriptor version = 16), Descriptor (see See Descriptor structure) Information about the current print style in the document. The printing marks, labels, ornaments, etc.
         {
@@ -376,6 +388,8 @@ void QPsdLayerTreeItemModel::fromParser(const QPsdParser &parser)
         d->clippingMasks.prepend({});
     }
 
+    d->buildChildLists();
+
     const auto additionalLayerInformation = layerAndMaskInformation.additionalLayerInformation();
     if (additionalLayerInformation.contains("FMsk")) {
         d->filterMask = additionalLayerInformation.value("FMsk").value<QPsdFilterMask>();
@@ -478,7 +492,7 @@ QPsdFilterMask QPsdLayerTreeItemModel::filterMask() const
     return d->filterMask;
 }
 
-void QPsdLayerTreeItemModel::load(const QString &fileName)
+void QPsdLayerTreeItemModel::load(const QString &fileName, QPsdParser::LoadOptions options)
 {
     d->fileInfo = QFileInfo(fileName);
     d->fileName = fileName;
@@ -489,6 +503,8 @@ void QPsdLayerTreeItemModel::load(const QString &fileName)
     emit fileInfoChanged(d->fileInfo);
 
     QPsdParser parser;
+    // layer items decompress the pixels they need themselves
+    parser.setLoadOptions(options | QPsdParser::DecompressOnDemand);
     parser.load(fileName);
 
     fromParser(parser);
@@ -74,7 +74,7 @@ public:
     QPsdFilterMask filterMask() const;
 
 public slots:
-    void load(const QString &fileName);
+    void load(const QString &fileName, QPsdParser::LoadOptions options = QPsdParser::NoLoadOptions);
 
 private slots:
     void setErrorMessage(const QString &errorMessage);
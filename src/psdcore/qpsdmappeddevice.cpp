@@ -0,0 +1,116 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdmappeddevice.h"
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+class QPsdMappedDevice::Private
+{
+public:
+    QSharedPointer<QFile> file;
+    const char *data = nullptr;
+    qint64 size = 0;
+
+    bool contains(qint64 offset, qint64 length) const {
+        return offset >= 0 && length >= 0 && offset <= size && length <= size - offset;
+    }
+};
+
+QPsdMappedDevice::QPsdMappedDevice(const QString &fileName, QObject *parent)
+    : QIODevice(parent)
+    , d(new Private)
+{
+    d->file.reset(new QFile(fileName));
+}
+
+QPsdMappedDevice::~QPsdMappedDevice() = default;
+
+bool QPsdMappedDevice::open(OpenMode mode)
+{
+    if (mode & WriteOnly) {
+        setErrorString("QPsdMappedDevice is read only"_L1);
+        return false;
+    }
+
+    if (!d->file->isOpen() && !d->file->open(QIODevice::ReadOnly)) {
+        setErrorString(d->file->errorString());
+        return false;
+    }
+
+    d->size = d->file->size();
+    if (d->size > 0) {
+        // the mapping stays valid until the QFile is destroyed,
+        // which happens when the last reference returned by mappedFile() is gone
+        d->data = reinterpret_cast<const char *>(d->file->map(0, d->size));
+        if (!d->data) {
+            setErrorString(d->file->errorString());
+            d->file->close();
+            d->size = 0;
+            return false;
+        }
+    }
+
+    // reads go straight to readData(), there is nothing to gain from buffering a mapping
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void QPsdMappedDevice::close()
+{
+    QIODevice::close();
+}
+
+qint64 QPsdMappedDevice::size() const
+{
+    return d->size;
+}
+
+QByteArrayView QPsdMappedDevice::view(qint64 size) const
+{
+    const auto offset = pos();
+    if (!isOpen() || !d->contains(offset, size))
+        return {};
+    return QByteArrayView(d->data + offset, size);
+}
+
+QByteArray QPsdMappedDevice::readRawData(qint64 size)
+{
+    const auto offset = pos();
+    if (!isOpen() || !d->contains(offset, size)) {
+        qWarning() << "out of bounds read of" << size << "bytes at" << offset << "in" << d->file->fileName();
+        return read(size);
+    }
+    seek(offset + size);
+    return QByteArray::fromRawData(d->data + offset, size);
+}
+
+QSharedPointer<QFile> QPsdMappedDevice::mappedFile() const
+{
+    return d->file;
+}
+
+QPsdMappedDevice *QPsdMappedDevice::fromDevice(QIODevice *device)
+{
+    return qobject_cast<QPsdMappedDevice *>(device);
+}
+
+qint64 QPsdMappedDevice::readData(char *data, qint64 maxSize)
+{
+    const auto offset = pos();
+    if (offset >= d->size)
+        return 0;
+    const auto length = std::min(maxSize, d->size - offset);
+    std::memcpy(data, d->data + offset, length);
+    return length;
+}
+
+qint64 QPsdMappedDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,60 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDMAPPEDDEVICE_H
+#define QPSDMAPPEDDEVICE_H
+
+#include <QtPsdCore/qpsdcoreglobal.h>
+
+#include <QtCore/QByteArrayView>
+#include <QtCore/QFile>
+#include <QtCore/QIODevice>
+#include <QtCore/QSharedPointer>
+
+QT_BEGIN_NAMESPACE
+
+class Q_PSDCORE_EXPORT QPsdMappedDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit QPsdMappedDevice(const QString &fileName, QObject *parent = nullptr);
+    ~QPsdMappedDevice() override;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return false; }
+    qint64 size() const override;
+
+    /*!
+     * Returns a bounds-checked view of \a size bytes at the current position
+     * without advancing it. Returns an empty view if the range is out of bounds.
+     */
+    QByteArrayView view(qint64 size) const;
+
+    /*!
+     * Returns \a size bytes at the current position as a QByteArray that
+     * refers to the mapping without copying, and advances the position.
+     * The data stays valid as long as mappedFile() is referenced.
+     */
+    QByteArray readRawData(qint64 size);
+
+    /*!
+     * Returns the file owning the mapping. Keep a reference to it for as long
+     * as data returned by readRawData() is in use.
+     */
+    QSharedPointer<QFile> mappedFile() const;
+
+    static QPsdMappedDevice *fromDevice(QIODevice *device);
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPSDMAPPEDDEVICE_H
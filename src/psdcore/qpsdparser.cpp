@@ -2,21 +2,55 @@
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qpsdparser.h"
+#include "qpsdmappeddevice.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
 class QPsdParser::Private : public QSharedData
 {
 public:
+    void decompress() const;
+
     QPsdFileHeader fileHeader;
     QPsdColorModeData colorModeData;
     QPsdImageResources imageResources;
     QPsdLayerAndMaskInformation layerAndMaskInformation;
     QPsdImageData imageData;
+    LoadOptions loadOptions = NoLoadOptions;
+    int maxThreadCount = QThread::idealThreadCount();
 };
 
+void QPsdParser::Private::decompress() const
+{
+    const auto channelImageData = layerAndMaskInformation.layerInfo().channelImageData();
+
+    if (maxThreadCount < 2) {
+        for (const auto &data : channelImageData) {
+            for (const auto id : data.channelIds())
+                data.decompress(id);
+        }
+        imageData.decompress();
+        return;
+    }
+
+    // every channel decodes into its own buffer, so the result does not depend on scheduling
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxThreadCount);
+    // scan lines of the merged image data are split between idle threads, so it goes first
+    imageData.decompress(&pool);
+    for (const auto &data : channelImageData) {
+        for (const auto id : data.channelIds())
+            pool.start([data, id] { data.decompress(id); });
+    }
+    pool.waitForDone();
+}
+
 QPsdParser::QPsdParser()
     : d(new Private)
 {}
@@ -34,35 +68,87 @@ QPsdParser &QPsdParser::operator=(const QPsdParser &other)
 
 QPsdParser::~QPsdParser() = default;
 
+QPsdParser::LoadOptions QPsdParser::loadOptions() const
+{
+    return d->loadOptions;
+}
+
+void QPsdParser::setLoadOptions(LoadOptions options)
+{
+    d->loadOptions = options;
+}
+
+int QPsdParser::maxThreadCount() const
+{
+    return d->maxThreadCount;
+}
+
+void QPsdParser::setMaxThreadCount(int maxThreadCount)
+{
+    d->maxThreadCount = maxThreadCount;
+}
+
 void QPsdParser::load(const QString &psd)
 {
-    QFile file(psd);
-    if (!file.open(QFile::ReadOnly)) {
-        qWarning() << file.errorString();
-        return;
+    std::unique_ptr<QIODevice> source;
+    if (d->loadOptions & (MemoryMapped | StructureOnly)) {
+        source = std::make_unique<QPsdMappedDevice>(psd);
+        if (!source->open(QIODevice::ReadOnly)) {
+            qWarning() << source->errorString() << "falling back to buffered reading";
+            source.reset();
+        }
+    }
+    if (!source) {
+        source = std::make_unique<QFile>(psd);
+        if (!source->open(QIODevice::ReadOnly)) {
+            qWarning() << source->errorString();
+            return;
+        }
     }
+    QIODevice *file = source.get();
 
-    d->fileHeader = QPsdFileHeader(&file);
-    if (!file.isOpen())
+    d->fileHeader = QPsdFileHeader(file);
+    if (!file->isOpen())
         return;
 
-    d->colorModeData = QPsdColorModeData(&file);
-    if (!file.isOpen())
+    d->colorModeData = QPsdColorModeData(file);
+    if (!file->isOpen())
         return;
 
-    d->imageResources = QPsdImageResources(&file);
-    if (!file.isOpen())
+    d->imageResources = QPsdImageResources(file);
+    if (!file->isOpen())
         return;
 
-    d->layerAndMaskInformation = QPsdLayerAndMaskInformation(&file);
-    if (!file.isOpen())
+    if (d->loadOptions.testFlag(ResourcesOnly)) {
+        d->layerAndMaskInformation = QPsdLayerAndMaskInformation();
+        d->imageData = QPsdImageData();
         return;
+    }
 
-    d->imageData = QPsdImageData(d->fileHeader, &file);
-    if (!file.isOpen())
+    d->layerAndMaskInformation = QPsdLayerAndMaskInformation(d->fileHeader, file);
+    if (!file->isOpen())
         return;
 
-    file.close();
+    if (d->loadOptions.testFlag(StructureOnly)) {
+        d->imageData = QPsdImageData();
+    } else {
+        d->imageData = QPsdImageData(d->fileHeader, file);
+        if (!file->isOpen())
+            return;
+    }
+
+    file->close();
+
+    if (!(d->loadOptions & (StructureOnly | DecompressOnDemand)))
+        d->decompress();
+}
+
+QImage QPsdParser::thumbnail(const QString &source)
+{
+    QPsdParser parser;
+    parser.setLoadOptions(ResourcesOnly);
+    parser.load(source);
+    return parser.imageResources().thumbnail().image();
 }
 
 QPsdFileHeader QPsdParser::fileHeader() const
@@ -18,6 +18,15 @@ QT_BEGIN_NAMESPACE
 class Q_PSDCORE_EXPORT QPsdParser
 {
 public:
+    enum LoadOption {
+        NoLoadOptions = 0x0,
+        MemoryMapped = 0x1,
+        StructureOnly = 0x2,
+        ResourcesOnly = 0x4,
+        DecompressOnDemand = 0x8,
+    };
+    Q_DECLARE_FLAGS(LoadOptions, LoadOption)
+
     QPsdParser();
     QPsdParser(const QPsdParser &other);
     QPsdParser &operator=(const QPsdParser &other);
@@ -50,17 +59,63 @@ public:
      */
     QPsdImageData imageData() const;
 
+    /*!
+     * Returns the options used by load().
+     */
+    LoadOptions loadOptions() const;
+
+    /*!
+     * Sets the options used by load().
+     * With MemoryMapped the file is mapped into memory, sections are read
+     * from the mapping and raw channel data refers to it without copying.
+     * StructureOnly implies MemoryMapped and skips the merged image data
+     * section, for callers that only need the layer tree.
+     * Unless StructureOnly or DecompressOnDemand is set, load() decompresses
+     * every layer channel and the merged image data up front on
+     * maxThreadCount() threads and keeps the result, so the decompressed
+     * pixels of the whole document stay in memory for as long as any copy of
+     * the parsed sections does. Otherwise load() leaves everything compressed
+     * and channels are decompressed on first access instead.
+     * ResourcesOnly stops after the image resources section, leaving the
+     * layers and the merged image data empty.
+     */
+    void setLoadOptions(LoadOptions options);
+
+    /*!
+     * Returns the maximum number of threads load() uses to decompress
+     * image data. Defaults to QThread::idealThreadCount().
+     */
+    int maxThreadCount() const;
+
+    /*!
+     * Sets the maximum number of threads load() uses to decompress layer
+     * channels and the merged image data to \a maxThreadCount. A value of
+     * 1 or less decompresses everything on the calling thread. The decoded
+     * data is identical regardless of the number of threads. Nothing is
+     * decompressed by load() with StructureOnly or DecompressOnDemand.
+     */
+    void setMaxThreadCount(int maxThreadCount);
+
     /*!
      * Loads and parses a PSD file from the specified source path.
      * \param source The path to the PSD file to load.
      */
     void load(const QString &source);
 
+    /*!
+     * Returns the thumbnail embedded in the PSD file \a source, reading only
+     * the file header and the image resources. Returns a null image if the
+     * file has no thumbnail.
+     */
+    static QImage thumbnail(const QString &source);
+
 private:
     class Private;
     QSharedDataPointer<Private> d;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QPsdParser::LoadOptions)
+
 QT_END_NAMESPACE
 
 #endif // QPSDCORE_H
@@ -38,10 +38,11 @@ protected:
 
     template<typename T>
     static T read(QIODevice *source, quint32 *length = nullptr) {
-        QByteArray data = source->read(sizeof(T));
+        char data[sizeof(T)] = {};
+        source->read(data, sizeof(T));
         if (length)
             *length -= sizeof(T);
-        return qFromBigEndian<T>(data.constData());
+        return qFromBigEndian<T>(data);
     }
 
     static qint8 readS8(QIODevice *source, quint32 *length = nullptr) {
@@ -66,6 +67,10 @@ protected:
     static quint64 readU64(QIODevice *source, quint32 *length = nullptr) {
         return read<quint64>(source, length);
     }
+    // lengths that are 8 bytes in PSB files
+    static quint64 readLength(QIODevice *source, bool isPsb, quint32 *length = nullptr) {
+        return isPsb ? readU64(source, length) : readU32(source, length);
+    }
 
     static float readFloat(QIODevice *source, quint32 *length = nullptr) {
         return read<float>(source, length);
@@ -77,10 +82,11 @@ protected:
 
     template<typename T>
     static T readLE(QIODevice *source, quint32 *length = nullptr) {
-        QByteArray data = source->read(sizeof(T));
+        char data[sizeof(T)] = {};
+        source->read(data, sizeof(T));
         if (length)
             *length -= sizeof(T);
-        return qFromLittleEndian<T>(data.constData());
+        return qFromLittleEndian<T>(data);
     }
 
     static quint32 readU32LE(QIODevice *source, quint32 *length = nullptr) {
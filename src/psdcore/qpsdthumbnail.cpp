@@ -0,0 +1,155 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdthumbnail.h"
+#include "qpsdimageresourceblock.h"
+
+#include <QtCore/QDataStream>
+
+QT_BEGIN_NAMESPACE
+
+class QPsdThumbnail::Private : public QSharedData
+{
+public:
+    bool valid = false;
+    // resource 1033 stores the channels in BGR order
+    bool bgr = false;
+    QPsdThumbnail::Format format = QPsdThumbnail::RawRGB;
+    QSize size;
+    quint32 widthBytes = 0;
+    QByteArray data;
+};
+
+QPsdThumbnail::QPsdThumbnail()
+    : d(new Private)
+{
+}
+
+QPsdThumbnail::QPsdThumbnail(const QPsdImageResourceBlock &block)
+    : d(new Private)
+{
+    if (block.id() != 1036 && block.id() != 1033) {
+        qWarning() << "QPsdThumbnail: Invalid block ID" << block.id() << "expected 1036 or 1033";
+        return;
+    }
+
+    const QByteArray data = block.data();
+    if (data.size() < 28) {
+        qWarning() << "QPsdThumbnail: Insufficient data size" << data.size() << "expected at least 28";
+        return;
+    }
+
+    QDataStream stream(data);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    // Thumbnail resource format:
+    // 4 bytes: Format. 1 = kJpegRGB, 0 = kRawRGB
+    // 4 bytes: Width of thumbnail in pixels
+    // 4 bytes: Height of thumbnail in pixels
+    // 4 bytes: Widthbytes: Padded row bytes = (width * bits per pixel + 31) / 32 * 4
+    // 4 bytes: Total size = widthbytes * height * planes
+    // 4 bytes: Size after compression. Used for consistency check
+    // 2 bytes: Bits per pixel. = 24
+    // 2 bytes: Number of planes. = 1
+    // Variable: JFIF data in RGB format, or raw RGB rows
+    quint32 format;
+    quint32 width;
+    quint32 height;
+    quint32 widthBytes;
+    quint32 totalSize;
+    quint32 compressedSize;
+    quint16 bitsPerPixel;
+    quint16 planes;
+
+    stream >> format >> width >> height >> widthBytes >> totalSize >> compressedSize >> bitsPerPixel >> planes;
+
+    if (format != RawRGB && format != JpegRGB) {
+        qWarning() << "QPsdThumbnail: Unknown format" << format;
+        return;
+    }
+    if (bitsPerPixel != 24 || planes != 1) {
+        qWarning() << "QPsdThumbnail:" << bitsPerPixel << "bits per pixel in" << planes << "planes not supported";
+        return;
+    }
+    if (width == 0 || height == 0 || width > 0xffff || height > 0xffff || widthBytes < width * 3) {
+        qWarning() << "QPsdThumbnail: Invalid size" << width << height << widthBytes;
+        return;
+    }
+
+    d->data = data.mid(28);
+    if (format == RawRGB && quint64(d->data.size()) < quint64(widthBytes) * height) {
+        qWarning() << "QPsdThumbnail: Insufficient data size" << d->data.size() << "expected" << quint64(widthBytes) * height;
+        d->data.clear();
+        return;
+    }
+    Q_UNUSED(totalSize);
+    Q_UNUSED(compressedSize);
+
+    d->bgr = block.id() == 1033;
+    d->format = static_cast<Format>(format);
+    d->size = QSize(width, height);
+    d->widthBytes = widthBytes;
+    d->valid = true;
+}
+
+QPsdThumbnail::QPsdThumbnail(const QPsdThumbnail &other)
+    : d(other.d)
+{
+}
+
+QPsdThumbnail &QPsdThumbnail::operator=(const QPsdThumbnail &other)
+{
+    if (this != &other) {
+        d = other.d;
+    }
+    return *this;
+}
+
+QPsdThumbnail::~QPsdThumbnail() = default;
+
+bool QPsdThumbnail::isValid() const
+{
+    return d->valid;
+}
+
+QPsdThumbnail::Format QPsdThumbnail::format() const
+{
+    return d->format;
+}
+
+QSize QPsdThumbnail::size() const
+{
+    return d->size;
+}
+
+QByteArray QPsdThumbnail::data() const
+{
+    return d->data;
+}
+
+QImage QPsdThumbnail::image() const
+{
+    if (!d->valid)
+        return QImage();
+
+    QImage image;
+    switch (d->format) {
+    case JpegRGB:
+        image = QImage::fromData(d->data, "JPG");
+        if (image.isNull())
+            qWarning() << "QPsdThumbnail: Failed to decode the JPEG data";
+        break;
+    case RawRGB: {
+        image = QImage(d->size, QImage::Format_RGB888);
+        if (image.isNull())
+            break;
+        const qsizetype rowBytes = qsizetype(d->size.width()) * 3;
+        for (int y = 0; y < d->size.height(); ++y)
+            memcpy(image.scanLine(y), d->data.constData() + qsizetype(y) * d->widthBytes, rowBytes);
+        break; }
+    }
+
+    return d->bgr ? std::move(image).rgbSwapped() : image;
+}
+
+QT_END_NAMESPACE
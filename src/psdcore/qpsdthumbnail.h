@@ -0,0 +1,56 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDTHUMBNAIL_H
+#define QPSDTHUMBNAIL_H
+
+#include <QtPsdCore/qpsdcoreglobal.h>
+#include <QtCore/QSharedDataPointer>
+#include <QtGui/QImage>
+
+QT_BEGIN_NAMESPACE
+
+class QPsdImageResourceBlock;
+
+class Q_PSDCORE_EXPORT QPsdThumbnail
+{
+public:
+    enum Format {
+        RawRGB = 0,
+        JpegRGB = 1,
+    };
+
+    QPsdThumbnail();
+    /*!
+     * Parses the thumbnail resource \a block, 1036 or the BGR ordered 1033
+     * written by Photoshop 4.0.
+     */
+    explicit QPsdThumbnail(const QPsdImageResourceBlock &block);
+    QPsdThumbnail(const QPsdThumbnail &other);
+    QPsdThumbnail &operator=(const QPsdThumbnail &other);
+    ~QPsdThumbnail();
+
+    bool isValid() const;
+
+    Format format() const;
+    QSize size() const;
+
+    /*!
+     * Returns the JFIF data or the padded RGB rows of the thumbnail.
+     */
+    QByteArray data() const;
+
+    /*!
+     * Decodes the thumbnail. Returns a null image if it is not valid or
+     * can not be decoded.
+     */
+    QImage image() const;
+
+private:
+    class Private;
+    QSharedDataPointer<Private> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPSDTHUMBNAIL_H
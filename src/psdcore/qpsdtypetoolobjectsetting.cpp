@@ -11,6 +11,7 @@ class QPsdTypeToolObjectSetting::Private : public QSharedData
 public:
     QList<qreal> transform;
     QPsdDescriptor textData;
+    QPsdEngineDataDocument engineData;
     QPsdDescriptor warpData;
     QRect rect;
     QRectF bounds;
@@ -49,6 +50,7 @@ QPsdTypeToolObjectSetting::QPsdTypeToolObjectSetting(QIODevice *source, quint32
     d->textData = QPsdDescriptor(source, length);
 
     const auto &data = d->textData.data();
+    d->engineData = QPsdEngineDataDocument(data.value("EngineData").toByteArray());
     if (data.contains("bounds")) {
         const auto &bounds = data.value("bounds").value<QPsdDescriptor>();
         const auto l = bounds.data().value("Left").value<QPsdUnitFloat>().value();
@@ -105,6 +107,11 @@ QPsdDescriptor QPsdTypeToolObjectSetting::textData() const
     return d->textData;
 }
 
+QPsdEngineDataDocument QPsdTypeToolObjectSetting::engineData() const
+{
+    return d->engineData;
+}
+
 QPsdDescriptor QPsdTypeToolObjectSetting::warpData() const
 {
     return d->warpData;
@@ -6,6 +6,7 @@
 
 #include <QtPsdCore/qpsdsection.h>
 #include <QtPsdCore/qpsddescriptor.h>
+#include <QtPsdCore/qpsdenginedatadocument.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -20,6 +21,12 @@ public:
 
     QList<qreal> transform() const;
     QPsdDescriptor textData() const;
+    /*!
+     * Returns the EngineData of textData(). It is parsed on first use and
+     * shared by all copies of the setting, so the GUI items and exporters of
+     * a text layer read it once.
+     */
+    QPsdEngineDataDocument engineData() const;
     QPsdDescriptor warpData() const;
     QRect rect() const;
     QRectF bounds() const;
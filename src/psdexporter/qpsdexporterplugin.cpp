@@ -4,6 +4,10 @@
 #include "qpsdexporterplugin.h"
 
 #include <QtCore/QCryptographicHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSet>
+#include <QtPsdExporter/qtpsdexporterversion.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -17,10 +21,32 @@ public:
     void generateChildrenRectMap(const QPersistentModelIndex &index) const;
     void generateIndexMap(const QPersistentModelIndex &index, const QPoint &topLeft) const;
 
+    QByteArray fingerprint(const QModelIndex &index) const;
+    void findSharedIds(const QModelIndex &parent, QSet<quint32> *ids);
+    QString fingerprintKey(const QModelIndex &index) const;
+
     QPsdExporterPlugin *q;
     const QPsdExporterTreeItemModel *model = nullptr;
+
+    // incremental export
+    struct Fingerprint {
+        QByteArray hash;
+        QString imageName;
+    };
+    bool incremental = false;
+    QString fingerprintFileName;
+    QString exportKey;
+    QByteArray exportHash;
+    // layer ids that are 0 (no lyid) or used by more than one layer
+    QSet<quint32> sharedIds;
+    QHash<QString, Fingerprint> previousFingerprints;
+    QHash<QString, Fingerprint> fingerprints;
 };
 
+#define FINGERPRINTFILE_MAGIC_KEY "qtpsdparser.fingerprints"_L1
+#define FINGERPRINTFILE_MAGIC_VERSION 1
+#define FINGERPRINTFILE_EXPORTS_KEY "exports"_L1
+
 QPsdExporterPlugin::Private::Private(QPsdExporterPlugin *parent) : q(parent)
 {}
 
@@ -80,6 +106,49 @@ void QPsdExporterPlugin::Private::generateIndexMap(const QPersistentModelIndex &
     }
 }
 
+QByteArray QPsdExporterPlugin::Private::fingerprint(const QModelIndex &index) const
+{
+    const auto *item = model->layerItem(index);
+    const auto hint = model->layerHint(index);
+    auto properties = hint.properties.values();
+    std::sort(properties.begin(), properties.end());
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(exportHash);
+    hash.addData(item->record().fingerprint());
+    // embedded files live outside of the layer record
+    hash.addData(item->linkedFile().data);
+    hash.addData(u"%1\n%2\n%3\n%4\n%5\n%6"_s.arg(hint.id).arg(int(hint.type)).arg(hint.componentName)
+                     .arg(int(hint.baseElement)).arg(int(hint.visible)).arg(properties.join(u',')).toUtf8());
+    return hash.result();
+}
+
+void QPsdExporterPlugin::Private::findSharedIds(const QModelIndex &parent, QSet<quint32> *ids)
+{
+    for (int i = 0; i < model->rowCount(parent); i++) {
+        const QModelIndex index = model->index(i, 0, parent);
+        const auto id = model->layerItem(index)->id();
+        if (id == 0 || ids->contains(id))
+            sharedIds.insert(id);
+        else
+            ids->insert(id);
+        findSharedIds(index, ids);
+    }
+}
+
+// the layer id survives edits elsewhere in the document, the position in the
+// tree is used for layers without an id of their own
+QString QPsdExporterPlugin::Private::fingerprintKey(const QModelIndex &index) const
+{
+    const auto id = model->layerItem(index)->id();
+    if (!sharedIds.contains(id))
+        return QString::number(id);
+    QString ret;
+    for (QModelIndex i = index; i.isValid(); i = model->parent(i))
+        ret.prepend(u'/' + QString::number(i.row()));
+    return ret;
+}
+
 QPsdExporterPlugin::QPsdExporterPlugin(QObject *parent)
     : QPsdAbstractPlugin(parent), d(new Private(this))
 {}
@@ -175,6 +244,121 @@ QString QPsdExporterPlugin::imageFileName(const QString &name, const QString &fo
     return u"%1.%2"_s.arg(basename, format.toLower());
 }
 
+bool QPsdExporterPlugin::writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    // keep the modification time of unchanged files for build systems watching them
+    if (file.size() == contents.size() && file.open(QIODevice::ReadOnly)) {
+        if (file.readAll() == contents)
+            return true;
+        file.close();
+    }
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    return file.write(contents) == contents.size();
+}
+
+void QPsdExporterPlugin::loadFingerprints(const QString &to, const QVariantMap &hint) const
+{
+    d->previousFingerprints.clear();
+    d->fingerprints.clear();
+    d->sharedIds.clear();
+    d->incremental = hint.value("incremental"_L1).toBool() && !d->model->hintFileName().isEmpty();
+    if (!d->incremental)
+        return;
+
+    d->fingerprintFileName = d->model->hintFileName() + "fingerprints"_L1;
+    d->exportKey = u"%1:%2"_s.arg(QString::fromLatin1(key()), QFileInfo(to).absoluteFilePath());
+
+    // everything that changes the output of every layer
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(key());
+    hash.addData(QTPSDEXPORTER_VERSION_STR);
+    for (auto it = hint.cbegin(); it != hint.cend(); ++it) {
+        const QSize size = it.value().toSize();
+        const QString value = it.value().typeId() == QMetaType::QSize
+            ? u"%1x%2"_s.arg(size.width()).arg(size.height())
+            : it.value().toString();
+        hash.addData(u"%1=%2\n"_s.arg(it.key(), value).toUtf8());
+    }
+    d->exportHash = hash.result();
+
+    QSet<quint32> ids;
+    d->findSharedIds({}, &ids);
+
+    QFile file(d->fingerprintFileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    const auto root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(FINGERPRINTFILE_MAGIC_KEY).toInt() != FINGERPRINTFILE_MAGIC_VERSION)
+        return;
+    const auto layers = root.value(FINGERPRINTFILE_EXPORTS_KEY).toObject().value(d->exportKey).toObject();
+    for (auto it = layers.begin(); it != layers.end(); ++it) {
+        const auto object = it.value().toObject();
+        d->previousFingerprints.insert(it.key(), {
+            QByteArray::fromHex(object.value("hash"_L1).toString().toLatin1()),
+            object.value("image"_L1).toString(),
+        });
+    }
+}
+
+bool QPsdExporterPlugin::saveFingerprints() const
+{
+    if (!d->incremental)
+        return true;
+
+    QJsonObject root;
+    QFile file(d->fingerprintFileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        root = QJsonDocument::fromJson(file.readAll()).object();
+        file.close();
+        if (root.value(FINGERPRINTFILE_MAGIC_KEY).toInt() != FINGERPRINTFILE_MAGIC_VERSION)
+            root = QJsonObject();
+    }
+
+    QJsonObject layers;
+    for (auto it = d->fingerprints.cbegin(); it != d->fingerprints.cend(); ++it) {
+        QJsonObject object;
+        object.insert("hash"_L1, QString::fromLatin1(it->hash.toHex()));
+        if (!it->imageName.isEmpty())
+            object.insert("image"_L1, it->imageName);
+        layers.insert(it.key(), object);
+    }
+    // other exporters and destinations keep their fingerprints
+    QJsonObject exports = root.value(FINGERPRINTFILE_EXPORTS_KEY).toObject();
+    exports.insert(d->exportKey, layers);
+    root.insert(FINGERPRINTFILE_MAGIC_KEY, FINGERPRINTFILE_MAGIC_VERSION);
+    root.insert(FINGERPRINTFILE_EXPORTS_KEY, exports);
+
+    if (!writeFile(d->fingerprintFileName, QJsonDocument(root).toJson())) {
+        qWarning() << "Failed to write" << d->fingerprintFileName;
+        return false;
+    }
+    return true;
+}
+
+QString QPsdExporterPlugin::cachedImageName(const QModelIndex &index) const
+{
+    if (!d->incremental)
+        return {};
+    const auto key = d->fingerprintKey(index);
+    auto &fingerprint = d->fingerprints[key];
+    if (fingerprint.hash.isEmpty())
+        fingerprint.hash = d->fingerprint(index);
+    const auto previous = d->previousFingerprints.value(key);
+    return previous.hash == fingerprint.hash ? previous.imageName : QString();
+}
+
+void QPsdExporterPlugin::setCachedImageName(const QModelIndex &index, const QString &name) const
+{
+    if (!d->incremental)
+        return;
+    auto &fingerprint = d->fingerprints[d->fingerprintKey(index)];
+    if (fingerprint.hash.isEmpty())
+        fingerprint.hash = d->fingerprint(index);
+    fingerprint.imageName = name;
+}
+
 bool QPsdExporterPlugin::generateMaps() const
 {
     childrenRectMap.clear();
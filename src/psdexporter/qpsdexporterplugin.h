@@ -58,6 +58,36 @@ protected:
     static QString imageFileName(const QString &name, const QString &format);
     bool generateMaps() const;
 
+    /*!
+     * Writes \a contents to \a fileName unless the file already holds
+     * exactly that, in which case it is left untouched.
+     */
+    static bool writeFile(const QString &fileName, const QByteArray &contents);
+
+    /*!
+     * Starts an export to \a to with \a hint. If the \c incremental hint is
+     * \c true, the layer fingerprints of the previous export of the document
+     * with this exporter to the same place are loaded from the file next to
+     * the hint file. A fingerprint covers the layer record and image data,
+     * the layer hint, the export hint and the version of the exporter.
+     */
+    void loadFingerprints(const QString &to, const QVariantMap &hint) const;
+
+    /*!
+     * Stores the fingerprints of this export for the next one.
+     * Does nothing unless the export is incremental.
+     */
+    bool saveFingerprints() const;
+
+    /*!
+     * Returns the image file name recorded for the layer at \a index by the
+     * previous export if the layer is unchanged since, otherwise an empty
+     * string. Layers are told apart by their id, or by their position in the
+     * layer tree if they have no id or share it with another layer.
+     */
+    QString cachedImageName(const QModelIndex &index) const;
+    void setCachedImageName(const QModelIndex &index, const QString &name) const;
+
 protected:
     static QMimeDatabase mimeDatabase;
 
@@ -275,6 +275,11 @@ QFileInfo QPsdExporterTreeItemModel::fileInfo() const
     }
 }
 
+QString QPsdExporterTreeItemModel::hintFileName() const
+{
+    return d->hintFileInfo.absoluteFilePath();
+}
+
 QString QPsdExporterTreeItemModel::fileName() const
 {
     auto *model = dynamic_cast<QPsdLayerTreeItemModel *>(sourceModel());
@@ -124,6 +124,12 @@ public:
     QString fileName() const;
     QString errorMessage() const;
 
+    /*!
+     * Returns the path of the file save() writes the hints to, next to the
+     * PSD file.
+     */
+    QString hintFileName() const;
+
 public slots:
     void load(const QString &fileName);
     void save();
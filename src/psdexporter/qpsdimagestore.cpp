@@ -5,25 +5,71 @@
 
 #include <QtCore/QBuffer>
 #include <QtCore/QCryptographicHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThreadPool>
+#include <QtGui/QImage>
 
 QT_BEGIN_NAMESPACE
 
+namespace {
+// records the images written to a directory, so that the next export into it
+// can tell which files are unchanged without encoding them again. It is kept
+// in the cache of the user, files in the image directory ship with the app.
+constexpr int ManifestVersion = 2;
+}
+
 class QPsdImageStore::Private : public QSharedData {
 public:
     Private(const QDir &d, const QString &p) : dir(d), path(p) {
         if (!path.isEmpty())
             dir.mkpath(path);
+        manifestFileName = manifestPath(imageDir());
+        loadManifest();
     }
+    ~Private() {
+        pool.waitForDone();
+        if (dirty)
+            saveManifest();
+    }
+
+    struct Entry {
+        QString key;
+        QString sha256;
+        qint64 size = -1;
+        qint64 lastModified = 0;
+    };
 
     const QDir dir;
     const QString path;
+    QString manifestFileName;
 
-    QHash<QString, QString> hash;
+    // file name by pixel key and pixel key by file name, for this export
+    QHash<QString, QString> names;
+    QHash<QString, QString> keys;
 
-    QDir imageDir();
-    QString sha256hex(const QByteArray &bytes);
-    std::pair<QByteArray, QString> sha256image(const QImage &image, const char *format);
-    QString sha256file(const QDir &dir, const QString &filename);
+    // guards the members below, which are updated by the writers
+    QMutex mutex;
+    QHash<QString, Entry> manifest;
+    bool dirty = false;
+    bool failed = false;
+
+    QThreadPool pool;
+
+    QDir imageDir() const;
+    void loadManifest();
+    void saveManifest();
+    bool isUnchanged(const QString &filename, const QString &key);
+    void write(const QString &filename, const QString &key, const QImage &image, const QByteArray &format, const QByteArray &encoded);
+
+    static QString manifestPath(const QDir &imageDir);
+    static QString pixelKey(const QImage &image, const QByteArray &format);
+    static QByteArray encode(const QImage &image, const char *format);
+    static QString sha256hex(const QByteArray &bytes);
+    static QString sha256file(const QDir &dir, const QString &filename);
 };
 
 QPsdImageStore::QPsdImageStore(const QDir &dir, const QString &path)
@@ -49,42 +95,46 @@ QPsdImageStore &QPsdImageStore::operator=(const QPsdImageStore &other)
 
 QString QPsdImageStore::save(const QString &filename, const QImage &image, const char *format)
 {
+    const QByteArray imageFormat = QByteArray(format).toLower();
+    const QString key = Private::pixelKey(image, imageFormat);
+
+    // the same image was saved by another layer
+    const auto it = d->names.constFind(key);
+    if (it != d->names.cend())
+        return it.value();
+
     QString fname = filename;
     QFileInfo fileInfo(filename);
+    QByteArray encoded;
     int i = 0;
     while (true) {
-        // first, check if hash is registered
-        if (d->hash.contains(fname)) {
-            // if already registered, check image hash
-            QString sha256registered = d->hash.value(fname);
-            std::pair<QByteArray, QString> sha256img = d->sha256image(image, format);
-
-            if (sha256registered == sha256img.second) {
-                // if hash matched
+        if (!d->keys.contains(fname)) {
+            if (d->isUnchanged(fname, key)) {
+                // written by the previous export
+                break;
+            }
+
+            bool written = false;
+            {
+                QMutexLocker locker(&d->mutex);
+                written = d->manifest.contains(fname);
+            }
+            const QFileInfo target(d->imageDir().absoluteFilePath(fname));
+            if (written || !target.exists()) {
+                // new, or outdated since the previous export
+                d->write(fname, key, image, imageFormat, encoded);
                 break;
             }
-            // if hash not matched, increment filename at below
-        } else {
-            // if not registered in hash, check file is exists
-            QString sha256 = d->sha256file(d->imageDir(), fname);
-            if (!sha256.isEmpty()) {
-                // file found
-                d->hash.insert(fname, sha256);
-
-                // re-check hash
-                continue;
-            } else {
-                // file not found
-                std::pair<QByteArray, QString> sha256img = d->sha256image(image, format);
-
-                // create file
-                QFile f(d->imageDir().absoluteFilePath(fname));
-                if (f.open(QIODevice::WriteOnly)) {
-                    f.write(sha256img.first);
-                    f.close();
-                    d->hash.insert(fname, sha256img.second);
-                    break;
-                }
+
+            // a file this store did not write, use it only if it is identical
+            if (encoded.isNull())
+                encoded = Private::encode(image, format);
+            const QString sha256 = Private::sha256hex(encoded);
+            if (Private::sha256file(d->imageDir(), fname) == sha256) {
+                QMutexLocker locker(&d->mutex);
+                d->manifest.insert(fname, { key, sha256, target.size(), target.lastModified().toMSecsSinceEpoch() });
+                d->dirty = true;
+                break;
             }
         }
 
@@ -92,27 +142,191 @@ QString QPsdImageStore::save(const QString &filename, const QImage &image, const
         fname = u"%1_%2.%3"_s.arg(fileInfo.completeBaseName()).arg(++i).arg(fileInfo.suffix());
     }
 
+    d->names.insert(key, fname);
+    d->keys.insert(fname, key);
     return fname;
 }
 
-QDir QPsdImageStore::Private::imageDir()
+QString QPsdImageStore::reuse(const QString &filename)
+{
+    if (filename.isEmpty())
+        return {};
+
+    QString key;
+    {
+        QMutexLocker locker(&d->mutex);
+        key = d->manifest.value(filename).key;
+    }
+    if (key.isEmpty())
+        return {};
+
+    // the image was already saved in this export, possibly by another layer
+    const auto it = d->names.constFind(key);
+    if (it != d->names.cend())
+        return it.value();
+    // the file is taken by a different image in this export
+    if (d->keys.contains(filename) || !d->isUnchanged(filename, key))
+        return {};
+
+    d->names.insert(key, filename);
+    d->keys.insert(filename, key);
+    return filename;
+}
+
+bool QPsdImageStore::waitForDone()
+{
+    d->pool.waitForDone();
+    QMutexLocker locker(&d->mutex);
+    if (d->dirty)
+        d->saveManifest();
+    d->dirty = false;
+    const bool ret = !d->failed;
+    d->failed = false;
+    return ret;
+}
+
+QDir QPsdImageStore::Private::imageDir() const
 {
     return QDir(dir.absoluteFilePath(path));
 }
 
-QString QPsdImageStore::Private::sha256hex(const QByteArray &bytes)
+QString QPsdImageStore::Private::manifestPath(const QDir &imageDir)
 {
-    return QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha256).toHex());
+    const auto cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheDir.isEmpty())
+        return {};
+    const auto id = QCryptographicHash::hash(imageDir.absolutePath().toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    return cacheDir + "/qtpsd/imagestore-"_L1 + QLatin1StringView(id) + ".json"_L1;
 }
 
-std::pair<QByteArray, QString> QPsdImageStore::Private::sha256image(const QImage &image, const char *format)
+void QPsdImageStore::Private::loadManifest()
+{
+    if (manifestFileName.isEmpty())
+        return;
+    QFile file(manifestFileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    const auto root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version"_L1).toInt() != ManifestVersion)
+        return;
+    const auto images = root.value("images"_L1).toObject();
+    for (auto it = images.begin(); it != images.end(); ++it) {
+        const auto object = it.value().toObject();
+        manifest.insert(it.key(), {
+            object.value("key"_L1).toString(),
+            object.value("sha256"_L1).toString(),
+            object.value("size"_L1).toInteger(-1),
+            object.value("lastModified"_L1).toInteger(),
+        });
+    }
+}
+
+void QPsdImageStore::Private::saveManifest()
+{
+    // called with the mutex locked or after the writers are done
+    const QDir imageDir = this->imageDir();
+    QJsonObject images;
+    for (auto it = manifest.cbegin(); it != manifest.cend(); ++it) {
+        // files removed since they were written are forgotten
+        if (!imageDir.exists(it.key()))
+            continue;
+        QJsonObject object;
+        object.insert("key"_L1, it->key);
+        object.insert("sha256"_L1, it->sha256);
+        object.insert("size"_L1, it->size);
+        object.insert("lastModified"_L1, it->lastModified);
+        images.insert(it.key(), object);
+    }
+    QJsonObject root;
+    root.insert("version"_L1, ManifestVersion);
+    root.insert("images"_L1, images);
+
+    if (manifestFileName.isEmpty())
+        return;
+    QDir().mkpath(QFileInfo(manifestFileName).absolutePath());
+    QSaveFile file(manifestFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << file.fileName() << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson());
+    if (!file.commit())
+        qWarning() << file.fileName() << file.errorString();
+}
+
+bool QPsdImageStore::Private::isUnchanged(const QString &filename, const QString &key)
+{
+    Entry entry;
+    {
+        QMutexLocker locker(&mutex);
+        entry = manifest.value(filename);
+    }
+    if (entry.key != key)
+        return false;
+    // the file is as it was written, nobody replaced it since
+    const QFileInfo fileInfo(imageDir().absoluteFilePath(filename));
+    return fileInfo.exists() && fileInfo.size() == entry.size
+        && fileInfo.lastModified().toMSecsSinceEpoch() == entry.lastModified;
+}
+
+void QPsdImageStore::Private::write(const QString &filename, const QString &key, const QImage &image, const QByteArray &format, const QByteArray &encoded)
+{
+    {
+        QMutexLocker locker(&mutex);
+        manifest.remove(filename);
+        dirty = true;
+    }
+
+    const QString filePath = imageDir().absoluteFilePath(filename);
+    pool.start([this, filePath, filename, key, image, format, encoded]() {
+        const QByteArray bytes = encoded.isNull() ? encode(image, format.constData()) : encoded;
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size()) {
+            qWarning() << filePath << file.errorString();
+            QMutexLocker locker(&mutex);
+            failed = true;
+            return;
+        }
+        file.close();
+
+        const QFileInfo fileInfo(filePath);
+        const Entry entry { key, sha256hex(bytes), fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch() };
+        QMutexLocker locker(&mutex);
+        manifest.insert(filename, entry);
+    });
+}
+
+QString QPsdImageStore::Private::pixelKey(const QImage &image, const QByteArray &format)
+{
+    // the keys are kept in the manifest across runs and identical keys are
+    // taken for identical images, so the hash has to be stable and wide
+    QCryptographicHash sha256(QCryptographicHash::Sha256);
+    // rows are hashed without their padding
+    const qsizetype bytesPerLine = (qsizetype(image.width()) * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); y++)
+        sha256.addData(QByteArrayView(image.constScanLine(y), bytesPerLine));
+    if (image.colorCount() > 0) {
+        const auto colorTable = image.colorTable();
+        sha256.addData(QByteArrayView(reinterpret_cast<const char *>(colorTable.constData()), colorTable.size() * sizeof(QRgb)));
+    }
+
+    return u"%1x%2/%3/%4/%5"_s.arg(image.width()).arg(image.height())
+        .arg(int(image.format())).arg(QString::fromLatin1(format))
+        .arg(QLatin1StringView(sha256.result().toHex()));
+}
+
+QByteArray QPsdImageStore::Private::encode(const QImage &image, const char *format)
 {
     QByteArray bytes;
     QBuffer buffer(&bytes);
     buffer.open(QIODevice::WriteOnly);
     image.save(&buffer, format);
+    return bytes;
+}
 
-    return std::make_pair(bytes, sha256hex(bytes));
+QString QPsdImageStore::Private::sha256hex(const QByteArray &bytes)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha256).toHex());
 }
 
 QString QPsdImageStore::Private::sha256file(const QDir &dir, const QString &filename)
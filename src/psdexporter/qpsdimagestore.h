@@ -19,11 +19,40 @@ public:
 
     QPsdImageStore &operator=(const QPsdImageStore &other);
 
+    /*!
+     * Saves \a image in \a format as \a filename in the image directory and
+     * returns the name of the file that holds it.
+     *
+     * Images are identified by their pixels. An image that was saved before
+     * through this store returns the name it was saved as, and an image that
+     * is unchanged since the previous export into the same directory is not
+     * encoded again. If \a filename is taken by a different image, a number
+     * is appended to it.
+     *
+     * Files are encoded and written in the background, call waitForDone()
+     * before using them.
+     */
     QString save(const QString &filename, const QImage &image, const char *format);
 
+    /*!
+     * Returns the name of the file that holds the image \a filename held
+     * when it was written by a previous export into the directory, if the
+     * file is unchanged since, without loading the image. Returns an empty
+     * string otherwise, the image has to be saved then.
+     */
+    QString reuse(const QString &filename);
+
+    /*!
+     * Waits until all images are written and updates the manifest that
+     * records them for the next export. The manifest is kept in
+     * QStandardPaths::GenericCacheLocation, not in the image directory.
+     * Returns \c false if an image could not be written.
+     */
+    bool waitForDone();
+
 private:
     class Private;
-    QSharedDataPointer<Private> d;
+    QExplicitlySharedDataPointer<Private> d;
 };
 
 QT_END_NAMESPACE
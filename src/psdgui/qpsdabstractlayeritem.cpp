@@ -5,9 +5,12 @@
 #include "qpsdborder.h"
 #include "qpsdpatternfill.h"
 #include "qpsdguiglobal.h"
+#include "qpsdlinkedimagecache.h"
 
+#include <QtCore/QCache>
 #include <QtCore/QCborArray>
 #include <QtCore/QCborMap>
+#include <QtCore/QMutex>
 
 #include <QtGui/QLinearGradient>
 
@@ -15,12 +18,43 @@
 #include <QtPsdCore/QPsdEnum>
 #include <QtPsdCore/QPsdUnitFloat>
 
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
+namespace {
+
+struct Pixels
+{
+    QImage image;
+    QImage transparencyMask;
+};
+
+struct PixelCache
+{
+    QMutex mutex;
+    // decoded pixels by layer item, costs are in KiB, unlimited by default
+    QCache<quint64, Pixels> pixels { std::numeric_limits<qsizetype>::max() };
+    quint64 nextKey = 0;
+};
+
+Q_GLOBAL_STATIC(PixelCache, pixelCache)
+
+}
+
 class QPsdAbstractLayerItem::Private
 {
 public:
+    Private();
+    ~Private();
+
+    Pixels pixels() const;
+    Pixels decode() const;
+
     QPsdLayerRecord record;
+    quint64 key = 0;
+    // serializes decoding of this layer
+    mutable QMutex mutex;
 
     quint32 id = 0;
     QString name;
@@ -34,12 +68,83 @@ public:
     QScopedPointer<QPsdBorder> border;
     QScopedPointer<QPsdPatternFill> patternFill;
     PathInfo vectorMask;
-    QImage image;
-    QImage transparencyMask;
     QPsdLinkedLayer::LinkedFile linkedFile;
+    // QPsdLinkedImageCache::key() of linkedFile, hashed once per layer
+    QByteArray linkedFileKey;
     QVariantList effects;
 };
 
+QPsdAbstractLayerItem::Private::Private()
+{
+    QMutexLocker locker(&pixelCache->mutex);
+    key = pixelCache->nextKey++;
+}
+
+QPsdAbstractLayerItem::Private::~Private()
+{
+    if (pixelCache.isDestroyed())
+        return;
+    QMutexLocker locker(&pixelCache->mutex);
+    pixelCache->pixels.remove(key);
+}
+
+Pixels QPsdAbstractLayerItem::Private::pixels() const
+{
+    auto lookup = [this](Pixels *ret) {
+        QMutexLocker locker(&pixelCache->mutex);
+        if (const auto *cached = pixelCache->pixels.object(key)) {
+            *ret = *cached;
+            return true;
+        }
+        return false;
+    };
+
+    Pixels ret;
+    if (lookup(&ret))
+        return ret;
+
+    QMutexLocker locker(&mutex);
+    // another thread may have decoded the layer while this one waited
+    if (lookup(&ret))
+        return ret;
+
+    ret = decode();
+    const qsizetype cost = qMax<qsizetype>(1, (ret.image.sizeInBytes() + ret.transparencyMask.sizeInBytes()) / 1024);
+    QMutexLocker cacheLocker(&pixelCache->mutex);
+    pixelCache->pixels.insert(key, new Pixels(ret), cost);
+    return ret;
+}
+
+Pixels QPsdAbstractLayerItem::Private::decode() const
+{
+    Pixels ret;
+    // decompress into a copy of its own, the QImages hold the pixels afterwards
+    // and the decompressed channels are freed with the copy
+    const auto imageData = record.imageData().compressedCopy();
+    if (imageData.channelIds().isEmpty())
+        return ret;
+
+    // Use imageDataToImage function to decode the channels straight into a QImage
+    ret.image = QtPsdGui::imageDataToImage(imageData, imageData.header());
+
+    // Layer mask
+    const auto transparencyMaskData = imageData.transparencyMaskData();
+    if (!transparencyMaskData.isEmpty()) {
+        const auto w = imageData.width();
+        const auto h = imageData.height();
+        // Create QImage that owns its data
+        QImage image(w, h, QImage::Format_Grayscale8);
+        if (!image.isNull() && static_cast<size_t>(transparencyMaskData.size()) >= static_cast<size_t>(w) * h) {
+            // scan lines are padded to 4 bytes
+            for (quint32 y = 0; y < h; ++y)
+                memcpy(image.scanLine(y), transparencyMaskData.constData() + static_cast<size_t>(y) * w, w);
+            ret.transparencyMask = image;
+        }
+    }
+
+    return ret;
+}
+
 QPsdAbstractLayerItem::QPsdAbstractLayerItem(int width, int height)
     : QPsdAbstractLayerItem()
 {
@@ -50,6 +155,9 @@ QPsdAbstractLayerItem::QPsdAbstractLayerItem(const QPsdLayerRecord &record)
     : QPsdAbstractLayerItem()
 {
     d->record = record;
+    // channels decompressed by the parser stay with the parser, the pixels
+    // are decoded into the image cache when needed
+    d->record.setImageData(record.imageData().compressedCopy());
     const auto additionalLayerInformation = record.additionalLayerInformation();
 
     // Layer ID
@@ -319,27 +427,10 @@ QPsdAbstractLayerItem::QPsdAbstractLayerItem(const QPsdLayerRecord &record)
         }
     }
 
-    // Layer image
-    const auto imageData = record.imageData();
-    const auto header = imageData.header();
-
-    // Use imageDataToImage function to create a QImage that owns its data
-    d->image = QtPsdGui::imageDataToImage(imageData, header);
-
-    // Layer mask
-    const auto transparencyMaskData = imageData.transparencyMaskData();
-    if (!transparencyMaskData.isEmpty()) {
-        const auto w = imageData.width();
-        const auto h = imageData.height();
-        // Create QImage that owns its data
-        QImage image(w, h, QImage::Format_Grayscale8);
-        if (!image.isNull() && static_cast<size_t>(transparencyMaskData.size()) >= static_cast<size_t>(w) * h) {
-            memcpy(image.bits(), transparencyMaskData.constData(), w * h);
-            d->transparencyMask = image;
-        }
-    }
+    // Layer image and mask are decoded on first use, see Private::pixels()
 
     // Document size
+    const auto header = record.imageData().header();
     d->documentSize = QSize(header.width(), header.height());
 
     // Vector mask
@@ -416,12 +507,33 @@ QPsdAbstractLayerItem::PathInfo QPsdAbstractLayerItem::vectorMask() const
 
 QImage QPsdAbstractLayerItem::image() const
 {
-    return d->image;
+    return d->pixels().image;
 }
 
 QImage QPsdAbstractLayerItem::transparencyMask() const
 {
-    return d->transparencyMask;
+    return d->pixels().transparencyMask;
+}
+
+qint64 QPsdAbstractLayerItem::imageCacheLimit()
+{
+    QMutexLocker locker(&pixelCache->mutex);
+    const qsizetype maxCost = pixelCache->pixels.maxCost();
+    return maxCost == std::numeric_limits<qsizetype>::max() ? 0 : qint64(maxCost) * 1024;
+}
+
+void QPsdAbstractLayerItem::setImageCacheLimit(qint64 bytes)
+{
+    QMutexLocker locker(&pixelCache->mutex);
+    pixelCache->pixels.setMaxCost(bytes > 0
+        ? qsizetype(qMin<qint64>(bytes / 1024, std::numeric_limits<qsizetype>::max() - 1))
+        : std::numeric_limits<qsizetype>::max());
+}
+
+qint64 QPsdAbstractLayerItem::imageCacheSize()
+{
+    QMutexLocker locker(&pixelCache->mutex);
+    return qint64(pixelCache->pixels.totalCost()) * 1024;
 }
 
 QPsdLinkedLayer::LinkedFile QPsdAbstractLayerItem::linkedFile() const
@@ -432,6 +544,12 @@ QPsdLinkedLayer::LinkedFile QPsdAbstractLayerItem::linkedFile() const
 void QPsdAbstractLayerItem::setLinkedFile(const QPsdLinkedLayer::LinkedFile &linkedFile)
 {
     d->linkedFile = linkedFile;
+    d->linkedFileKey = QPsdLinkedImageCache::key(linkedFile);
+}
+
+QByteArray QPsdAbstractLayerItem::linkedFileKey() const
+{
+    return d->linkedFileKey;
 }
 
 QPsdAbstractLayerItem::PathInfo QPsdAbstractLayerItem::parseShape(const QPsdVectorMaskSetting &vms) const
@@ -448,7 +566,8 @@ QPsdAbstractLayerItem::PathInfo QPsdAbstractLayerItem::parseShape(const QPsdVect
 
     // check if the path is rectangle
     const auto subPathList = vms.subPathList();
-    static Qt::FillRule lastFill = Qt::OddEvenFill;
+    // "same" refers to the previous subpath of this mask, not to other layers
+    Qt::FillRule lastFill = Qt::OddEvenFill;
     for (const auto &pathInfo : subPathList) {
         ret.type = PathInfo::Path;
         switch (vms.fillRule()) {
@@ -60,9 +60,38 @@ public:
         QPainterPath path;
     };
     PathInfo vectorMask() const;
+
+    /*!
+     * Returns the pixels of the layer. They are decoded from the layer record
+     * on first use and kept in a cache shared by all layer items.
+     */
     QImage image() const;
+
+    /*!
+     * Returns the transparency mask of the layer in QImage::Format_Grayscale8,
+     * decoded together with image().
+     */
     QImage transparencyMask() const;
 
+    /*!
+     * Returns the memory budget for decoded layer images in bytes, 0 if the
+     * decoded images of every layer are kept. Defaults to 0.
+     */
+    static qint64 imageCacheLimit();
+
+    /*!
+     * Sets the memory budget for decoded layer images to \a bytes. The least
+     * recently used images are dropped when the budget is exceeded and decoded
+     * again when needed. Images still referenced elsewhere stay alive until
+     * released.
+     */
+    static void setImageCacheLimit(qint64 bytes);
+
+    /*!
+     * Returns the memory used by decoded layer images in bytes.
+     */
+    static qint64 imageCacheSize();
+
     QPsdLinkedLayer::LinkedFile linkedFile() const;
     void setLinkedFile(const QPsdLinkedLayer::LinkedFile &linkedFile);
 
@@ -70,6 +99,8 @@ public:
 
 protected:
     QPsdAbstractLayerItem::PathInfo parseShape(const QPsdVectorMaskSetting &vms) const;
+    // the key of linkedFile() in QPsdLinkedImageCache
+    QByteArray linkedFileKey() const;
 
 private:
     class Private;
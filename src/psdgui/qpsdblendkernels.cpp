@@ -0,0 +1,503 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdblendkernels_p.h"
+
+#include <QtCore/private/qsimd_p.h>
+
+#include <algorithm>
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+namespace QPsdBlendKernels {
+
+namespace {
+
+// Separable blend functions B(Cb, Cs) on unpremultiplied colors
+// https://www.w3.org/TR/compositing-1/#blending
+
+float darken(float cb, float cs) { return std::min(cb, cs); }
+float multiply(float cb, float cs) { return cb * cs; }
+float colorBurn(float cb, float cs)
+{
+    if (cb >= 1)
+        return 1;
+    if (cs <= 0)
+        return 0;
+    return 1 - std::min(1.0f, (1 - cb) / cs);
+}
+float linearBurn(float cb, float cs) { return std::max(0.0f, cb + cs - 1); }
+float lighten(float cb, float cs) { return std::max(cb, cs); }
+float screen(float cb, float cs) { return cb + cs - cb * cs; }
+float colorDodge(float cb, float cs)
+{
+    if (cb <= 0)
+        return 0;
+    if (cs >= 1)
+        return 1;
+    return std::min(1.0f, cb / (1 - cs));
+}
+float linearDodge(float cb, float cs) { return std::min(1.0f, cb + cs); }
+float hardLight(float cb, float cs)
+{
+    return cs <= 0.5f ? multiply(cb, 2 * cs) : screen(cb, 2 * cs - 1);
+}
+float overlay(float cb, float cs) { return hardLight(cs, cb); }
+float softLight(float cb, float cs)
+{
+    if (cs <= 0.5f)
+        return cb - (1 - 2 * cs) * cb * (1 - cb);
+    const float d = cb <= 0.25f ? ((16 * cb - 12) * cb + 4) * cb : std::sqrt(cb);
+    return cb + (2 * cs - 1) * (d - cb);
+}
+// the rest are Photoshop modes that are not part of the W3C list
+float vividLight(float cb, float cs)
+{
+    return cs <= 0.5f ? colorBurn(cb, 2 * cs) : colorDodge(cb, 2 * cs - 1);
+}
+float linearLight(float cb, float cs) { return std::clamp(cb + 2 * cs - 1, 0.0f, 1.0f); }
+float pinLight(float cb, float cs)
+{
+    return cs <= 0.5f ? std::min(cb, 2 * cs) : std::max(cb, 2 * cs - 1);
+}
+float hardMix(float cb, float cs) { return cb + cs >= 1 ? 1 : 0; }
+float difference(float cb, float cs) { return std::abs(cb - cs); }
+float exclusion(float cb, float cs) { return cb + cs - 2 * cb * cs; }
+float subtract(float cb, float cs) { return std::max(0.0f, cb - cs); }
+float divide(float cb, float cs)
+{
+    if (cs <= 0)
+        return cb <= 0 ? 0 : 1;
+    return std::min(1.0f, cb / cs);
+}
+
+template <float (*F)(float, float)>
+struct Separable
+{
+    void operator()(const float *cb, const float *cs, float *out) const
+    {
+        out[0] = F(cb[0], cs[0]);
+        out[1] = F(cb[1], cs[1]);
+        out[2] = F(cb[2], cs[2]);
+    }
+};
+
+// Non-separable blend functions
+
+float lum(const float *c) { return 0.3f * c[0] + 0.59f * c[1] + 0.11f * c[2]; }
+
+void clipColor(float *c)
+{
+    const float l = lum(c);
+    const float n = std::min({ c[0], c[1], c[2] });
+    const float x = std::max({ c[0], c[1], c[2] });
+    for (int i = 0; i < 3; i++) {
+        if (n < 0)
+            c[i] = l + (c[i] - l) * l / (l - n);
+        if (x > 1)
+            c[i] = l + (c[i] - l) * (1 - l) / (x - l);
+    }
+}
+
+void setLum(const float *c, float l, float *out)
+{
+    const float d = l - lum(c);
+    for (int i = 0; i < 3; i++)
+        out[i] = c[i] + d;
+    clipColor(out);
+}
+
+float sat(const float *c)
+{
+    return std::max({ c[0], c[1], c[2] }) - std::min({ c[0], c[1], c[2] });
+}
+
+void setSat(const float *c, float s, float *out)
+{
+    const float n = std::min({ c[0], c[1], c[2] });
+    const float x = std::max({ c[0], c[1], c[2] });
+    for (int i = 0; i < 3; i++)
+        out[i] = x > n ? (c[i] - n) * s / (x - n) : 0;
+}
+
+struct Hue
+{
+    void operator()(const float *cb, const float *cs, float *out) const
+    {
+        float t[3];
+        setSat(cs, sat(cb), t);
+        setLum(t, lum(cb), out);
+    }
+};
+
+struct Saturation
+{
+    void operator()(const float *cb, const float *cs, float *out) const
+    {
+        float t[3];
+        setSat(cb, sat(cs), t);
+        setLum(t, lum(cb), out);
+    }
+};
+
+struct Color
+{
+    void operator()(const float *cb, const float *cs, float *out) const { setLum(cs, lum(cb), out); }
+};
+
+struct Luminosity
+{
+    void operator()(const float *cb, const float *cs, float *out) const { setLum(cb, lum(cs), out); }
+};
+
+struct DarkerColor
+{
+    void operator()(const float *cb, const float *cs, float *out) const
+    {
+        std::copy_n(lum(cs) < lum(cb) ? cs : cb, 3, out);
+    }
+};
+
+struct LighterColor
+{
+    void operator()(const float *cb, const float *cs, float *out) const
+    {
+        std::copy_n(lum(cs) > lum(cb) ? cs : cb, 3, out);
+    }
+};
+
+// co = cs * (1 - ab) + cb * (1 - as) + as * ab * B(Cb, Cs)
+// ao = as + ab * (1 - as)
+// with preserveAlpha the first term is dropped and ao = ab
+template <typename Op>
+void blendPixels(float *dst, const float *src, const float *coverage, float opacity,
+                 qsizetype count, bool preserveAlpha, Op op)
+{
+    for (qsizetype i = 0; i < count; i++) {
+        const float *s = src + i * 4;
+        float *d = dst + i * 4;
+        const float as = s[3] * opacity * (coverage ? coverage[i] : 1.0f);
+        if (as <= 0)
+            continue;
+        const float ab = d[3];
+        const float cs[3] = { s[0] / s[3], s[1] / s[3], s[2] / s[3] };
+        float cb[3] = { 0, 0, 0 };
+        if (ab > 0) {
+            for (int c = 0; c < 3; c++)
+                cb[c] = d[c] / ab;
+        }
+        float b[3];
+        op(cb, cs, b);
+        const float source = preserveAlpha ? 0 : as * (1 - ab);
+        for (int c = 0; c < 3; c++)
+            d[c] = cs[c] * source + d[c] * (1 - as) + as * ab * b[c];
+        if (!preserveAlpha)
+            d[3] = as + ab * (1 - as);
+    }
+}
+
+#ifdef __SSE2__
+// The separable functions without divisions on the three colors of a pixel
+// at once, lanes are picked with a mask where the scalar functions branch.
+// The operations are done in the same order, so that the results match.
+namespace Sse2 {
+
+__m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+__m128 darken(__m128 cb, __m128 cs) { return _mm_min_ps(cs, cb); }
+__m128 multiply(__m128 cb, __m128 cs) { return _mm_mul_ps(cb, cs); }
+__m128 linearBurn(__m128 cb, __m128 cs)
+{
+    return _mm_max_ps(_mm_sub_ps(_mm_add_ps(cb, cs), _mm_set1_ps(1.0f)), _mm_setzero_ps());
+}
+__m128 lighten(__m128 cb, __m128 cs) { return _mm_max_ps(cs, cb); }
+__m128 screen(__m128 cb, __m128 cs) { return _mm_sub_ps(_mm_add_ps(cb, cs), _mm_mul_ps(cb, cs)); }
+__m128 linearDodge(__m128 cb, __m128 cs) { return _mm_min_ps(_mm_add_ps(cb, cs), _mm_set1_ps(1.0f)); }
+__m128 hardLight(__m128 cb, __m128 cs)
+{
+    const __m128 cs2 = _mm_mul_ps(_mm_set1_ps(2.0f), cs);
+    return select(_mm_cmple_ps(cs, _mm_set1_ps(0.5f)),
+                  multiply(cb, cs2), screen(cb, _mm_sub_ps(cs2, _mm_set1_ps(1.0f))));
+}
+__m128 overlay(__m128 cb, __m128 cs) { return hardLight(cs, cb); }
+__m128 softLight(__m128 cb, __m128 cs)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 cs2 = _mm_mul_ps(_mm_set1_ps(2.0f), cs);
+    const __m128 darker = _mm_sub_ps(cb, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(one, cs2), cb), _mm_sub_ps(one, cb)));
+    // lanes of cb below 0.25 do not use the square root, negative ones give NaN there
+    const __m128 polynomial = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(16.0f), cb), _mm_set1_ps(12.0f)), cb), _mm_set1_ps(4.0f)), cb);
+    const __m128 d = select(_mm_cmple_ps(cb, _mm_set1_ps(0.25f)), polynomial, _mm_sqrt_ps(cb));
+    const __m128 lighter = _mm_add_ps(cb, _mm_mul_ps(_mm_sub_ps(cs2, one), _mm_sub_ps(d, cb)));
+    return select(_mm_cmple_ps(cs, _mm_set1_ps(0.5f)), darker, lighter);
+}
+__m128 linearLight(__m128 cb, __m128 cs)
+{
+    const __m128 v = _mm_sub_ps(_mm_add_ps(cb, _mm_mul_ps(_mm_set1_ps(2.0f), cs)), _mm_set1_ps(1.0f));
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+__m128 pinLight(__m128 cb, __m128 cs)
+{
+    const __m128 cs2 = _mm_mul_ps(_mm_set1_ps(2.0f), cs);
+    return select(_mm_cmple_ps(cs, _mm_set1_ps(0.5f)),
+                  _mm_min_ps(cs2, cb), _mm_max_ps(_mm_sub_ps(cs2, _mm_set1_ps(1.0f)), cb));
+}
+__m128 hardMix(__m128 cb, __m128 cs)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    return _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(cb, cs), one), one);
+}
+__m128 difference(__m128 cb, __m128 cs) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(cb, cs)); }
+__m128 exclusion(__m128 cb, __m128 cs)
+{
+    return _mm_sub_ps(_mm_add_ps(cb, cs), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), cb), cs));
+}
+__m128 subtract(__m128 cb, __m128 cs) { return _mm_max_ps(_mm_sub_ps(cb, cs), _mm_setzero_ps()); }
+
+}
+
+// blendPixels() with one pixel per vector, op gets all four lanes and the
+// alpha that comes out of it is replaced
+template <__m128 (*F)(__m128, __m128)>
+void blendPixelsSse2(float *dst, const float *src, const float *coverage, float opacity,
+                     qsizetype count, bool preserveAlpha)
+{
+    for (qsizetype i = 0; i < count; i++) {
+        const float *s = src + i * 4;
+        float *d = dst + i * 4;
+        const float as = s[3] * opacity * (coverage ? coverage[i] : 1.0f);
+        if (as <= 0)
+            continue;
+        const float ab = d[3];
+        const __m128 vd = _mm_loadu_ps(d);
+        const __m128 cs = _mm_div_ps(_mm_loadu_ps(s), _mm_set1_ps(s[3]));
+        const __m128 cb = ab > 0 ? _mm_div_ps(vd, _mm_set1_ps(ab)) : _mm_setzero_ps();
+        const __m128 b = F(cb, cs);
+        const float source = preserveAlpha ? 0 : as * (1 - ab);
+        const __m128 co = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cs, _mm_set1_ps(source)), _mm_mul_ps(vd, _mm_set1_ps(1 - as))),
+                                     _mm_mul_ps(_mm_set1_ps(as * ab), b));
+        _mm_storeu_ps(d, co);
+        d[3] = preserveAlpha ? ab : as + ab * (1 - as);
+    }
+}
+
+#define BLEND_SEPARABLE(f) blendPixelsSse2<Sse2::f>(dst, src, coverage, opacity, count, preserveAlpha)
+#else
+#define BLEND_SEPARABLE(f) blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Separable<f>())
+#endif
+
+// co = cs * k + cb * (1 - as), which keeps ab when multiplied by ab instead of k
+void normal(float *dst, const float *src, const float *coverage, float opacity, qsizetype count, bool preserveAlpha)
+{
+    qsizetype i = 0;
+#ifdef __SSE2__
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i < count; i++) {
+        const float k = coverage ? coverage[i] * opacity : opacity;
+        const __m128 s = _mm_mul_ps(_mm_loadu_ps(src + i * 4), _mm_set1_ps(k));
+        const __m128 as = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128 d = _mm_loadu_ps(dst + i * 4);
+        const __m128 rest = _mm_mul_ps(d, _mm_sub_ps(one, as));
+        if (preserveAlpha) {
+            const __m128 ab = _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 3, 3));
+            d = _mm_add_ps(rest, _mm_mul_ps(s, ab));
+        } else {
+            d = _mm_add_ps(rest, s);
+        }
+        _mm_storeu_ps(dst + i * 4, d);
+    }
+#endif
+    for (; i < count; i++) {
+        const float k = coverage ? coverage[i] * opacity : opacity;
+        const float *s = src + i * 4;
+        float *d = dst + i * 4;
+        const float as = s[3] * k;
+        const float scale = preserveAlpha ? d[3] : 1.0f;
+        for (int c = 0; c < 4; c++)
+            d[c] = d[c] * (1 - as) + s[c] * k * scale;
+    }
+}
+
+// a per pixel threshold that only depends on the position in the document
+float dissolveThreshold(int x, int y)
+{
+    quint32 h = quint32(x) * 0x9e3779b1u ^ quint32(y) * 0x85ebca77u;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return (h & 0xffffff) / 16777216.0f;
+}
+
+// pixels are either left out or drawn opaque, as often as the alpha says
+void dissolve(float *dst, const float *src, const float *coverage, float opacity,
+              qsizetype count, bool preserveAlpha, int x, int y)
+{
+    for (qsizetype i = 0; i < count; i++) {
+        const float *s = src + i * 4;
+        const float as = s[3] * opacity * (coverage ? coverage[i] : 1.0f);
+        if (as <= dissolveThreshold(x + int(i), y))
+            continue;
+        const float opaque[4] = { s[0] / s[3], s[1] / s[3], s[2] / s[3], 1 };
+        normal(dst + i * 4, opaque, nullptr, 1, 1, preserveAlpha);
+    }
+}
+
+}
+
+void blend(QPsdBlend::Mode mode, float *dst, const float *src, const float *coverage, float opacity,
+           qsizetype count, bool preserveAlpha, int x, int y)
+{
+    if (opacity <= 0 || count <= 0)
+        return;
+
+    switch (mode) {
+    case QPsdBlend::Dissolve:
+        dissolve(dst, src, coverage, opacity, count, preserveAlpha, x, y);
+        break;
+    case QPsdBlend::Darken:
+        BLEND_SEPARABLE(darken);
+        break;
+    case QPsdBlend::Multiply:
+        BLEND_SEPARABLE(multiply);
+        break;
+    case QPsdBlend::ColorBurn:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Separable<colorBurn>());
+        break;
+    case QPsdBlend::LinearBurn:
+        BLEND_SEPARABLE(linearBurn);
+        break;
+    case QPsdBlend::DarkerColor:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, DarkerColor());
+        break;
+    case QPsdBlend::Lighten:
+        BLEND_SEPARABLE(lighten);
+        break;
+    case QPsdBlend::Screen:
+        BLEND_SEPARABLE(screen);
+        break;
+    case QPsdBlend::ColorDodge:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Separable<colorDodge>());
+        break;
+    case QPsdBlend::LinearDodge:
+        BLEND_SEPARABLE(linearDodge);
+        break;
+    case QPsdBlend::LighterColor:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, LighterColor());
+        break;
+    case QPsdBlend::Overlay:
+        BLEND_SEPARABLE(overlay);
+        break;
+    case QPsdBlend::SoftLight:
+        BLEND_SEPARABLE(softLight);
+        break;
+    case QPsdBlend::HardLight:
+        BLEND_SEPARABLE(hardLight);
+        break;
+    case QPsdBlend::VividLight:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Separable<vividLight>());
+        break;
+    case QPsdBlend::LinearLight:
+        BLEND_SEPARABLE(linearLight);
+        break;
+    case QPsdBlend::PinLight:
+        BLEND_SEPARABLE(pinLight);
+        break;
+    case QPsdBlend::HardMix:
+        BLEND_SEPARABLE(hardMix);
+        break;
+    case QPsdBlend::Difference:
+        BLEND_SEPARABLE(difference);
+        break;
+    case QPsdBlend::Exclusion:
+        BLEND_SEPARABLE(exclusion);
+        break;
+    case QPsdBlend::Subtract:
+        BLEND_SEPARABLE(subtract);
+        break;
+    case QPsdBlend::Divide:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Separable<divide>());
+        break;
+    case QPsdBlend::Hue:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Hue());
+        break;
+    case QPsdBlend::Saturation:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Saturation());
+        break;
+    case QPsdBlend::Color:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Color());
+        break;
+    case QPsdBlend::Luminosity:
+        blendPixels(dst, src, coverage, opacity, count, preserveAlpha, Luminosity());
+        break;
+    default:
+        // Normal, and pass through and invalid keys which only make sense for groups
+        normal(dst, src, coverage, opacity, count, preserveAlpha);
+        break;
+    }
+}
+
+#undef BLEND_SEPARABLE
+
+void fade(float *dst, const float *backdrop, const float *coverage, float opacity, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; i++) {
+        const float t = coverage ? coverage[i] * opacity : opacity;
+        for (int c = 0; c < 4; c++)
+            dst[i * 4 + c] = backdrop[i * 4 + c] + (dst[i * 4 + c] - backdrop[i * 4 + c]) * t;
+    }
+}
+
+void load(float *dst, const uint *src, qsizetype count)
+{
+    qsizetype i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(1.0f / 255);
+    for (; i < count; i++) {
+        // BGRA in memory
+        const __m128i bytes = _mm_cvtsi32_si128(int(src[i]));
+        const __m128i words = _mm_unpacklo_epi8(bytes, zero);
+        const __m128 bgra = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), scale);
+        _mm_storeu_ps(dst + i * 4, _mm_shuffle_ps(bgra, bgra, _MM_SHUFFLE(3, 0, 1, 2)));
+    }
+#endif
+    for (; i < count; i++) {
+        const uint p = src[i];
+        dst[i * 4 + 0] = ((p >> 16) & 0xff) / 255.0f;
+        dst[i * 4 + 1] = ((p >> 8) & 0xff) / 255.0f;
+        dst[i * 4 + 2] = (p & 0xff) / 255.0f;
+        dst[i * 4 + 3] = (p >> 24) / 255.0f;
+    }
+}
+
+void store(uint *dst, const float *src, qsizetype count)
+{
+    qsizetype i = 0;
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i < count; i++) {
+        __m128 rgba = _mm_max_ps(_mm_loadu_ps(src + i * 4), zero);
+        // premultiplied colors never exceed alpha
+        const __m128 alpha = _mm_min_ps(_mm_shuffle_ps(rgba, rgba, _MM_SHUFFLE(3, 3, 3, 3)), _mm_set1_ps(1.0f));
+        rgba = _mm_mul_ps(_mm_min_ps(rgba, alpha), scale);
+        const __m128 bgra = _mm_shuffle_ps(rgba, rgba, _MM_SHUFFLE(3, 0, 1, 2));
+        const __m128i words = _mm_packs_epi32(_mm_cvtps_epi32(bgra), _mm_setzero_si128());
+        dst[i] = uint(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+    }
+#endif
+    for (; i < count; i++) {
+        const float *s = src + i * 4;
+        const float a = std::clamp(s[3], 0.0f, 1.0f);
+        auto channel = [a](float v) { return uint(std::lround(std::clamp(v, 0.0f, a) * 255)); };
+        dst[i] = (channel(a) << 24) | (channel(s[0]) << 16) | (channel(s[1]) << 8) | channel(s[2]);
+    }
+}
+
+}
+
+QT_END_NAMESPACE
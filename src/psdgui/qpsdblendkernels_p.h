@@ -0,0 +1,46 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDBLENDKERNELS_P_H
+#define QPSDBLENDKERNELS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtPsdGui/qpsdguiglobal.h>
+#include <QtPsdCore/qpsdblend.h>
+
+QT_BEGIN_NAMESPACE
+
+// Row kernels of the compositor. Pixels are premultiplied RGBA in float,
+// four floats per pixel, and rows must not overlap.
+namespace QPsdBlendKernels {
+
+// Blends count pixels of src into dst with mode. The alpha of src is scaled
+// by opacity and, if not null, by coverage, one value per pixel.
+// With preserveAlpha the alpha of dst is kept, which clips src to dst.
+// x and y are the document coordinates of the first pixel, Dissolve uses them
+// to pick the same pixels in every tile.
+void blend(QPsdBlend::Mode mode, float *dst, const float *src, const float *coverage, float opacity,
+           qsizetype count, bool preserveAlpha, int x, int y);
+
+// backdrop + (dst - backdrop) * coverage * opacity, fades what was drawn over backdrop
+void fade(float *dst, const float *backdrop, const float *coverage, float opacity, qsizetype count);
+
+// QImage::Format_ARGB32_Premultiplied to float and back
+void load(float *dst, const uint *src, qsizetype count);
+void store(uint *dst, const float *src, qsizetype count);
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QPSDBLENDKERNELS_P_H
@@ -0,0 +1,405 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdcompositor.h"
+#include "qpsdblendkernels_p.h"
+#include "qpsdguilayertreeitemmodel.h"
+
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtEndian>
+#include <QtCore/QVarLengthArray>
+#include <QtGui/QPainter>
+
+#include <QtPsdCore/QPsdSectionDividerSetting>
+#include <QtPsdCore/QPsdVectorMaskSetting>
+
+#include <algorithm>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// tiles are rendered independently and are small enough for their rows to stay in cache
+constexpr int TileSize = 128;
+
+// Format_Alpha8, value is used outside of rect
+struct Mask
+{
+    bool isNull() const { return image.isNull() && value >= 1; }
+
+    QImage image;
+    QRect rect;
+    float value = 1;
+};
+
+struct Node
+{
+    bool visible = true;
+    bool group = false;
+    QPsdBlend::Mode mode = QPsdBlend::Normal;
+    float opacity = 1;
+    // Format_ARGB32_Premultiplied, at rect in the document
+    QImage image;
+    QRect rect;
+    QList<Mask> masks;
+    // bottom first
+    QList<Node> children;
+    // layers clipped to this one, bottom first
+    QList<Node> clipped;
+};
+
+// premultiplied RGBA in float for a rectangle of the document
+struct Buffer
+{
+    explicit Buffer(const QRect &rect)
+        : rect(rect)
+        , data(qsizetype(rect.width()) * rect.height() * 4, 0.0f)
+    {}
+
+    float *pixel(int x, int y)
+    {
+        return data.data() + (qsizetype(y - rect.y()) * rect.width() + (x - rect.x())) * 4;
+    }
+
+    QRect rect;
+    QList<float> data;
+};
+
+Mask userMask(const QPsdLayerRecord &record)
+{
+    const auto maskData = record.layerMaskAdjustmentLayerData();
+    const auto rect = maskData.rect();
+    if (maskData.isLayerMaskDisabled() || rect.isEmpty())
+        return {};
+    const auto data = record.imageData().userSuppliedLayerMask();
+    const auto depth = record.imageData().header().depth();
+    const int bytesPerSample = depth / 8;
+    if (bytesPerSample < 1 || data.size() < qsizetype(rect.width()) * rect.height() * bytesPerSample) {
+        if (!data.isEmpty())
+            qWarning() << "layer mask of" << record.name() << "is too small," << data.size() << "bytes for" << rect;
+        return {};
+    }
+
+    Mask mask;
+    mask.image = QImage(rect.size(), QImage::Format_Alpha8);
+    if (mask.image.isNull())
+        return {};
+    mask.rect = rect;
+    mask.value = maskData.defaultColor() / 255.0f;
+    const auto *src = reinterpret_cast<const uchar *>(data.constData());
+    for (int y = 0; y < rect.height(); y++) {
+        uchar *dst = mask.image.scanLine(y);
+        const uchar *line = src + qsizetype(y) * rect.width() * bytesPerSample;
+        switch (bytesPerSample) {
+        case 1:
+            std::memcpy(dst, line, rect.width());
+            break;
+        case 2:
+            // big endian, the high byte comes first
+            for (int x = 0; x < rect.width(); x++)
+                dst[x] = line[x * 2];
+            break;
+        default:
+            for (int x = 0; x < rect.width(); x++)
+                dst[x] = uchar(qBound(0.0f, qFromBigEndian<float>(line + x * 4), 1.0f) * 255 + 0.5f);
+            break;
+        }
+    }
+    return mask;
+}
+
+Mask vectorMask(const QPsdAbstractLayerItem *item, const QRect &documentRect)
+{
+    const auto vms = item->record().additionalLayerInformation().value("vmsk").value<QPsdVectorMaskSetting>();
+    const auto pathInfo = item->vectorMask();
+    if (pathInfo.type == QPsdAbstractLayerItem::PathInfo::None || vms.disable())
+        return {};
+
+    // the path is relative to the layer
+    const auto path = pathInfo.path.translated(item->rect().topLeft());
+    Mask mask;
+    mask.rect = vms.invert() ? documentRect : path.boundingRect().toAlignedRect() & documentRect;
+    mask.value = vms.invert() ? 1 : 0;
+    if (mask.rect.isEmpty())
+        return mask;
+    mask.image = QImage(mask.rect.size(), QImage::Format_Alpha8);
+    if (mask.image.isNull())
+        return {};
+    mask.image.fill(vms.invert() ? Qt::black : Qt::transparent);
+    QPainter painter(&mask.image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    if (vms.invert())
+        painter.setCompositionMode(QPainter::CompositionMode_Clear);
+    painter.translate(-mask.rect.topLeft());
+    painter.fillPath(path, Qt::black);
+    return mask;
+}
+
+Node layerNode(const QPsdAbstractLayerItem *item, const QRect &documentRect)
+{
+    const auto record = item->record();
+    const auto imageData = record.imageData();
+    const auto additionalLayerInformation = record.additionalLayerInformation();
+
+    Node node;
+    node.visible = item->isVisible();
+    node.group = item->type() == QPsdAbstractLayerItem::Folder;
+    node.mode = record.blendMode();
+    if (node.group) {
+        const auto lsct = additionalLayerInformation.value("lsct").value<QPsdSectionDividerSetting>();
+        if (lsct.key() != QPsdBlend::Invalid)
+            node.mode = lsct.key();
+    } else if (node.mode == QPsdBlend::PassThrough || node.mode == QPsdBlend::Invalid) {
+        node.mode = QPsdBlend::Normal;
+    }
+
+    // toImage() has already scaled the alpha channel of RGB layers by the opacity
+    const bool rgb = imageData.header().colorMode() == QPsdFileHeader::RGB;
+    if (node.group || !rgb || !imageData.hasAlpha())
+        node.opacity = record.opacity() / 255.0f;
+    if (!node.group && additionalLayerInformation.contains("iOpa"))
+        node.opacity *= additionalLayerInformation.value("iOpa").toInt() / 255.0f;
+
+    if (!node.group) {
+        auto image = item->image();
+        // only RGB images carry the transparency mask as alpha
+        const auto transparencyMask = item->transparencyMask();
+        if (!rgb && !image.isNull() && transparencyMask.size() == image.size()) {
+            image = image.convertToFormat(QImage::Format_ARGB32);
+            image.setAlphaChannel(transparencyMask);
+        }
+        node.image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        node.rect = QRect(item->rect().topLeft(), node.image.size());
+    }
+
+    const auto user = userMask(record);
+    if (!user.isNull())
+        node.masks.append(user);
+    const auto vector = vectorMask(item, node.group ? documentRect : node.rect & documentRect);
+    if (!vector.isNull())
+        node.masks.append(vector);
+    return node;
+}
+
+QList<Node> buildNodes(const QPsdGuiLayerTreeItemModel *model, const QModelIndex &parent, const QRect &documentRect)
+{
+    QList<Node> nodes;
+    // rows start at the top of the stack
+    for (int row = model->rowCount(parent) - 1; row >= 0; row--) {
+        const auto index = model->index(row, 0, parent);
+        const auto *item = model->layerItem(index);
+        if (!item)
+            continue;
+        auto node = layerNode(item, documentRect);
+        if (node.group)
+            node.children = buildNodes(model, index, documentRect);
+
+        if (item->record().clipping() == QPsdLayerRecord::NonBase && !nodes.isEmpty())
+            nodes.last().clipped.append(node);
+        else
+            nodes.append(node);
+    }
+    return nodes;
+}
+
+// the product of the masks of node for count pixels at (x, y), false if there are none
+bool coverage(const Node &node, int x, int y, int count, float *out)
+{
+    if (node.masks.isEmpty())
+        return false;
+    std::fill_n(out, count, 1.0f);
+    for (const auto &mask : node.masks) {
+        int from = 0;
+        int to = 0;
+        if (y >= mask.rect.top() && y <= mask.rect.bottom()) {
+            from = qBound(0, mask.rect.left() - x, count);
+            to = qBound(from, mask.rect.right() + 1 - x, count);
+        }
+        for (int i = 0; i < from; i++)
+            out[i] *= mask.value;
+        if (from < to) {
+            const uchar *line = mask.image.constScanLine(y - mask.rect.top()) + (x + from - mask.rect.left());
+            for (int i = from; i < to; i++)
+                out[i] *= line[i - from] / 255.0f;
+        }
+        for (int i = to; i < count; i++)
+            out[i] *= mask.value;
+    }
+    return true;
+}
+
+void renderNodes(const QList<Node> &nodes, Buffer &buffer);
+
+void renderNode(const Node &node, Buffer &buffer, QPsdBlend::Mode mode, bool preserveAlpha)
+{
+    const auto &rect = buffer.rect;
+    QVarLengthArray<float, TileSize> cover(rect.width());
+
+    if (!node.group) {
+        const auto r = node.rect & rect;
+        if (r.isEmpty() || node.image.isNull())
+            return;
+        QVarLengthArray<float, TileSize * 4> src(r.width() * 4);
+        for (int y = r.top(); y <= r.bottom(); y++) {
+            const auto *line = reinterpret_cast<const uint *>(node.image.constScanLine(y - node.rect.top()));
+            QPsdBlendKernels::load(src.data(), line + (r.left() - node.rect.left()), r.width());
+            const bool masked = coverage(node, r.left(), y, r.width(), cover.data());
+            QPsdBlendKernels::blend(mode, buffer.pixel(r.left(), y), src.data(), masked ? cover.data() : nullptr,
+                                    node.opacity, r.width(), preserveAlpha, r.left(), y);
+        }
+        return;
+    }
+
+    if (mode == QPsdBlend::PassThrough && !preserveAlpha) {
+        // children blend with what is below the group
+        if (node.masks.isEmpty() && node.opacity >= 1) {
+            renderNodes(node.children, buffer);
+            return;
+        }
+        const Buffer backdrop = buffer;
+        renderNodes(node.children, buffer);
+        for (int y = rect.top(); y <= rect.bottom(); y++) {
+            const bool masked = coverage(node, rect.left(), y, rect.width(), cover.data());
+            const float *below = backdrop.data.constData() + qsizetype(y - rect.top()) * rect.width() * 4;
+            QPsdBlendKernels::fade(buffer.pixel(rect.left(), y), below, masked ? cover.data() : nullptr,
+                                   node.opacity, rect.width());
+        }
+        return;
+    }
+
+    // an isolated group is flattened first and blends as a single layer
+    Buffer layer(rect);
+    renderNodes(node.children, layer);
+    if (mode == QPsdBlend::PassThrough)
+        mode = QPsdBlend::Normal;
+    for (int y = rect.top(); y <= rect.bottom(); y++) {
+        const bool masked = coverage(node, rect.left(), y, rect.width(), cover.data());
+        QPsdBlendKernels::blend(mode, buffer.pixel(rect.left(), y), layer.pixel(rect.left(), y),
+                                masked ? cover.data() : nullptr, node.opacity, rect.width(), preserveAlpha, rect.left(), y);
+    }
+}
+
+void renderNodes(const QList<Node> &nodes, Buffer &buffer)
+{
+    const auto &rect = buffer.rect;
+    for (const auto &node : nodes) {
+        if (!node.visible)
+            continue;
+        if (node.clipped.isEmpty()) {
+            renderNode(node, buffer, node.mode, false);
+            continue;
+        }
+
+        // the base and its clipped layers are flattened first, then blend with the mode of the base
+        Buffer base(rect);
+        renderNode(node, base, QPsdBlend::Normal, false);
+        for (const auto &clipped : node.clipped) {
+            if (clipped.visible)
+                renderNode(clipped, base, clipped.mode, true);
+        }
+        const auto mode = node.mode == QPsdBlend::PassThrough ? QPsdBlend::Normal : node.mode;
+        for (int y = rect.top(); y <= rect.bottom(); y++) {
+            QPsdBlendKernels::blend(mode, buffer.pixel(rect.left(), y), base.pixel(rect.left(), y),
+                                    nullptr, 1, rect.width(), false, rect.left(), y);
+        }
+    }
+}
+
+}
+
+class QPsdCompositor::Private
+{
+public:
+    const QPsdGuiLayerTreeItemModel *model = nullptr;
+    int maxThreadCount = QThread::idealThreadCount();
+};
+
+QPsdCompositor::QPsdCompositor(const QPsdGuiLayerTreeItemModel *model)
+    : d(new Private)
+{
+    d->model = model;
+}
+
+QPsdCompositor::~QPsdCompositor() = default;
+
+const QPsdGuiLayerTreeItemModel *QPsdCompositor::model() const
+{
+    return d->model;
+}
+
+void QPsdCompositor::setModel(const QPsdGuiLayerTreeItemModel *model)
+{
+    d->model = model;
+}
+
+int QPsdCompositor::maxThreadCount() const
+{
+    return d->maxThreadCount;
+}
+
+void QPsdCompositor::setMaxThreadCount(int maxThreadCount)
+{
+    d->maxThreadCount = maxThreadCount;
+}
+
+QImage QPsdCompositor::render() const
+{
+    if (!d->model)
+        return {};
+    return render(QRect(QPoint(0, 0), d->model->size()));
+}
+
+QImage QPsdCompositor::render(const QRect &rect) const
+{
+    if (!d->model)
+        return {};
+    const QRect documentRect(QPoint(0, 0), d->model->size());
+    const auto area = rect & documentRect;
+    if (area.isEmpty())
+        return {};
+
+    QImage image(area.size(), QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) {
+        qWarning() << "cannot allocate an image of" << area.size();
+        return {};
+    }
+
+    // images and masks are converted once on this thread, tiles only read them
+    const auto nodes = buildNodes(d->model, QModelIndex(), documentRect);
+
+    uchar *bits = image.bits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    auto renderTile = [&](const QRect &tile) {
+        Buffer buffer(tile);
+        renderNodes(nodes, buffer);
+        for (int y = tile.top(); y <= tile.bottom(); y++) {
+            auto *line = reinterpret_cast<uint *>(bits + qsizetype(y - area.top()) * bytesPerLine);
+            QPsdBlendKernels::store(line + (tile.left() - area.left()), buffer.pixel(tile.left(), y), tile.width());
+        }
+    };
+
+    QList<QRect> tiles;
+    for (int y = area.top(); y <= area.bottom(); y += TileSize) {
+        for (int x = area.left(); x <= area.right(); x += TileSize)
+            tiles.append(QRect(x, y, TileSize, TileSize) & area);
+    }
+
+    if (d->maxThreadCount < 2 || tiles.size() < 2) {
+        for (const auto &tile : tiles)
+            renderTile(tile);
+        return image;
+    }
+
+    // every tile writes to its own pixels, so the result does not depend on scheduling
+    QThreadPool pool;
+    pool.setMaxThreadCount(d->maxThreadCount);
+    for (const auto &tile : tiles)
+        pool.start([&renderTile, tile] { renderTile(tile); });
+    pool.waitForDone();
+    return image;
+}
+
+QT_END_NAMESPACE
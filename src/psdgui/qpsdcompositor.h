@@ -0,0 +1,63 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDCOMPOSITOR_H
+#define QPSDCOMPOSITOR_H
+
+#include <QtPsdGui/qpsdguiglobal.h>
+
+#include <QtGui/QImage>
+
+QT_BEGIN_NAMESPACE
+
+class QPsdGuiLayerTreeItemModel;
+
+class Q_PSDGUI_EXPORT QPsdCompositor
+{
+public:
+    explicit QPsdCompositor(const QPsdGuiLayerTreeItemModel *model = nullptr);
+    ~QPsdCompositor();
+
+    const QPsdGuiLayerTreeItemModel *model() const;
+    void setModel(const QPsdGuiLayerTreeItemModel *model);
+
+    /*!
+     * Returns the maximum number of threads render() uses.
+     * Defaults to QThread::idealThreadCount().
+     */
+    int maxThreadCount() const;
+
+    /*!
+     * Sets the maximum number of threads render() uses to \a maxThreadCount.
+     * Tiles of the document are rendered independently, a value of 1 or less
+     * renders all of them on the calling thread. The result is identical
+     * regardless of the number of threads.
+     */
+    void setMaxThreadCount(int maxThreadCount);
+
+    /*!
+     * Flattens the layers of the model into an image of the size of the
+     * document in QImage::Format_ARGB32_Premultiplied.
+     *
+     * Layers are blended with their QPsdBlend mode, opacity and fill opacity,
+     * through their layer mask and vector mask. Groups are composited on their
+     * own unless they pass through, and clipped layers only draw where their
+     * base layer does. Layer effects and adjustment layers are not rendered.
+     */
+    QImage render() const;
+
+    /*!
+     * Flattens the part of the document in \a rect, which is clipped to the
+     * document, into an image of the size of the clipped rectangle.
+     */
+    QImage render(const QRect &rect) const;
+
+private:
+    Q_DISABLE_COPY(QPsdCompositor)
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPSDCOMPOSITOR_H
@@ -1,8 +1,13 @@
 #include "qpsdguiglobal.h"
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 namespace QtPsdGui {
+// bytes converted at a time for formats QImage can't take as toImage() lays them out
+static constexpr qsizetype BandSize = 256 * 1024;
+
 QImage imageDataToImage(const QPsdAbstractImage &imageData, const QPsdFileHeader &fileHeader, const QPsdColorModeData &colorModeData)
 {
     QImage image;
@@ -11,158 +16,112 @@ QImage imageDataToImage(const QPsdAbstractImage &imageData, const QPsdFileHeader
     if (w * h == 0)
         return image;
     const auto depth = fileHeader.depth();
-    const QByteArray data = imageData.toImage(fileHeader.colorMode());
+    const auto colorMode = fileHeader.colorMode();
+
+    // decodes straight into the pixels of the image, honoring its stride
+    auto decode = [&](QImage::Format format) {
+        image = QImage(w, h, format);
+        if (image.isNull() || !imageData.toImage(colorMode, image.bits(), image.bytesPerLine()))
+            qFatal() << Q_FUNC_INFO << __LINE__;
+    };
+    // decodes bands of rows into a scratch buffer and converts them row by row
+    auto convert = [&](QImage::Format format, auto &&convertLine) {
+        image = QImage(w, h, format);
+        const auto lineSize = imageData.toImageBytesPerLine(colorMode);
+        if (image.isNull() || lineSize == 0) {
+            qFatal() << Q_FUNC_INFO << __LINE__;
+            return;
+        }
+        const quint32 band = std::clamp<qsizetype>(BandSize / lineSize, 1, h);
+        QByteArray scratch(lineSize * band, Qt::Uninitialized);
+        auto *src = reinterpret_cast<const uchar *>(scratch.constData());
+        for (quint32 y = 0; y < h; y += band) {
+            const int rows = std::min(band, h - y);
+            if (!imageData.toImage(colorMode, reinterpret_cast<uchar *>(scratch.data()), lineSize, y, rows))
+                qFatal() << Q_FUNC_INFO << __LINE__;
+            for (int i = 0; i < rows; i++)
+                convertLine(src + i * lineSize, image.scanLine(y + i));
+        }
+    };
 
-    switch (fileHeader.colorMode()) {
+    switch (colorMode) {
     case QPsdFileHeader::Bitmap:
         // Bitmap mode is 1-bit per pixel
         if (depth == 1) {
-            // Calculate expected size for 1-bit data
-            const size_t bytesPerRow = (w + 7) / 8; // Round up to next byte
-            const size_t expectedSize = static_cast<size_t>(bytesPerRow) * h;
-
-            if (static_cast<size_t>(data.size()) >= expectedSize) {
-                // Convert 1-bit to 8-bit grayscale
-                image = QImage(w, h, QImage::Format_Grayscale8);
-                const uchar* src = reinterpret_cast<const uchar*>(data.constData());
-                uchar* dst = image.bits();
-
-                for (quint32 y = 0; y < h; ++y) {
-                    for (quint32 x = 0; x < w; ++x) {
-                        size_t byteIndex = static_cast<size_t>(y) * bytesPerRow + x / 8;
-                        int bitIndex = 7 - (x % 8); // MSB first
-                        bool bit = (src[byteIndex] >> bitIndex) & 1;
-                        dst[y * w + x] = bit ? 255 : 0;
-                    }
+            // Convert 1-bit to 8-bit grayscale
+            convert(QImage::Format_Grayscale8, [w](const uchar *src, uchar *dst) {
+                for (quint32 x = 0; x < w; ++x) {
+                    int bitIndex = 7 - (x % 8); // MSB first
+                    bool bit = (src[x / 8] >> bitIndex) & 1;
+                    dst[x] = bit ? 255 : 0;
                 }
-            } else {
-                qFatal() << Q_FUNC_INFO << __LINE__ << "Expected" << expectedSize << "got" << data.size();
-            }
+            });
         }
         break;
 
     case QPsdFileHeader::Grayscale:
         if (depth == 8) {
-            // Create QImage that owns its data
-            image = QImage(w, h, QImage::Format_Grayscale8);
-            if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h) {
-                memcpy(image.bits(), data.constData(), w * h);
-            } else {
-                qFatal() << Q_FUNC_INFO << __LINE__;
-            }
+            decode(QImage::Format_Grayscale8);
         } else if (depth == 16) {
-            // Create QImage that owns its data
-            image = QImage(w, h, QImage::Format_Grayscale16);
-            if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h * 2) {
-                memcpy(image.bits(), data.constData(), w * h * 2);
-            } else {
-                qFatal() << Q_FUNC_INFO << __LINE__;
-            }
+            decode(QImage::Format_Grayscale16);
         } else if (depth == 32) {
             // Convert 32-bit float grayscale to 16-bit
-            image = QImage(w, h, QImage::Format_Grayscale16);
-            const auto src = reinterpret_cast<const float *>(data.constData());
-            auto dst = reinterpret_cast<quint16 *>(image.bits());
-            const auto pixelCount = w * h;
-            for (quint32 i = 0; i < pixelCount; ++i) {
-                // Convert float (0.0-1.0) to 16-bit (0-65535)
-                float value = src[i];
-                value = qBound(0.0f, value, 1.0f);
-                dst[i] = static_cast<quint16>(value * 65535.0f);
-            }
+            convert(QImage::Format_Grayscale16, [w](const uchar *line, uchar *out) {
+                const auto src = reinterpret_cast<const float *>(line);
+                auto dst = reinterpret_cast<quint16 *>(out);
+                for (quint32 x = 0; x < w; ++x) {
+                    // Convert float (0.0-1.0) to 16-bit (0-65535)
+                    dst[x] = static_cast<quint16>(qBound(0.0f, src[x], 1.0f) * 65535.0f);
+                }
+            });
         }
         break;
 
     case QPsdFileHeader::RGB:
         if (depth == 8) {
-            if (imageData.hasAlpha()) {
-                image = QImage(w, h, QImage::Format_ARGB32);
-                if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h * 4) {
-                    memcpy(image.bits(), data.constData(), w * h * 4);
-                } else {
-                    qFatal() << Q_FUNC_INFO << __LINE__;
-                }
-            } else {
-                image = QImage(w, h, QImage::Format_BGR888);
-                if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h * 3) {
-                    memcpy(image.bits(), data.constData(), w * h * 3);
-                } else {
-                    qFatal() << Q_FUNC_INFO << __LINE__;
-                }
-            }
+            decode(imageData.hasAlpha() ? QImage::Format_ARGB32 : QImage::Format_BGR888);
         } else if (depth == 16) {
             if (imageData.hasAlpha()) {
-                image = QImage(w, h, QImage::Format_RGBA64);
-                if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h * 8) {
-                    memcpy(image.bits(), data.constData(), w * h * 8);
-                } else {
-                    qFatal() << Q_FUNC_INFO << __LINE__;
-                }
+                decode(QImage::Format_RGBA64);
             } else {
-                image = QImage(w, h, QImage::Format_RGBX64);
-                const size_t expectedSize = static_cast<size_t>(w) * h * 6; // 3 channels * 2 bytes
-                if (!image.isNull() && static_cast<size_t>(data.size()) >= expectedSize) {
-                    // Convert RGB16 to RGBX64 (add padding for X channel)
-                    const quint16* src = reinterpret_cast<const quint16*>(data.constData());
-                    quint16* dst = reinterpret_cast<quint16*>(image.bits());
-                    for (quint32 i = 0; i < w * h; ++i) {
+                // Convert RGB16 to RGBX64 (add padding for X channel)
+                convert(QImage::Format_RGBX64, [w](const uchar *line, uchar *out) {
+                    const quint16* src = reinterpret_cast<const quint16*>(line);
+                    quint16* dst = reinterpret_cast<quint16*>(out);
+                    for (quint32 x = 0; x < w; ++x) {
                         *dst++ = src[2]; // B
                         *dst++ = src[1]; // G
                         *dst++ = src[0]; // R
                         *dst++ = 65535;  // X (padding, full opacity)
                         src += 3;
                     }
-                } else {
-                    qFatal() << Q_FUNC_INFO << __LINE__ << "Expected" << expectedSize << "got" << data.size();
-                }
+                });
             }
         } else if (depth == 32) {
             // Convert 32-bit float RGB to 16-bit for display using RGBA64 format
-            if (imageData.hasAlpha()) {
-                image = QImage(w, h, QImage::Format_RGBA64);
-                const auto src = reinterpret_cast<const float *>(data.constData());
-                auto dst = reinterpret_cast<quint16 *>(image.bits());
-                for (quint32 y = 0; y < h; ++y) {
-                    for (quint32 x = 0; x < w; ++x) {
-                        const int srcIdx = (y * w + x) * 4;
-                        const int dstIdx = (y * w + x) * 4;
-                        // Convert float (0.0-1.0) to 16-bit (0-65535)
-                        // Note: PSD stores in BGR order, but we need RGB
-                        dst[dstIdx + 2] = static_cast<quint16>(qBound(0.0f, src[srcIdx], 1.0f) * 65535.0f);     // B -> B
-                        dst[dstIdx + 1] = static_cast<quint16>(qBound(0.0f, src[srcIdx + 1], 1.0f) * 65535.0f); // G -> G
-                        dst[dstIdx] = static_cast<quint16>(qBound(0.0f, src[srcIdx + 2], 1.0f) * 65535.0f);     // R -> R
-                        dst[dstIdx + 3] = static_cast<quint16>(qBound(0.0f, src[srcIdx + 3], 1.0f) * 65535.0f); // A -> A
-                    }
+            // Note: PSD stores in BGR order, but we need RGB
+            const bool alpha = imageData.hasAlpha();
+            convert(alpha ? QImage::Format_RGBA64 : QImage::Format_RGBX64, [w, alpha](const uchar *line, uchar *out) {
+                const auto src = reinterpret_cast<const float *>(line);
+                auto dst = reinterpret_cast<quint16 *>(out);
+                const int channels = alpha ? 4 : 3;
+                for (quint32 x = 0; x < w; ++x) {
+                    // Convert float (0.0-1.0) to 16-bit (0-65535)
+                    dst[2] = static_cast<quint16>(qBound(0.0f, src[0], 1.0f) * 65535.0f); // B -> B
+                    dst[1] = static_cast<quint16>(qBound(0.0f, src[1], 1.0f) * 65535.0f); // G -> G
+                    dst[0] = static_cast<quint16>(qBound(0.0f, src[2], 1.0f) * 65535.0f); // R -> R
+                    dst[3] = alpha ? static_cast<quint16>(qBound(0.0f, src[3], 1.0f) * 65535.0f) : 65535; // A -> A
+                    src += channels;
+                    dst += 4;
                 }
-            } else {
-                image = QImage(w, h, QImage::Format_RGBX64);
-                const auto src = reinterpret_cast<const float *>(data.constData());
-                auto dst = reinterpret_cast<quint16 *>(image.bits());
-                for (quint32 y = 0; y < h; ++y) {
-                    for (quint32 x = 0; x < w; ++x) {
-                        const int srcIdx = (y * w + x) * 3;
-                        const int dstIdx = (y * w + x) * 4;
-                        // Convert float (0.0-1.0) to 16-bit (0-65535)
-                        // Note: PSD stores in BGR order, but we need RGB
-                        dst[dstIdx + 2] = static_cast<quint16>(qBound(0.0f, src[srcIdx], 1.0f) * 65535.0f);     // B -> B
-                        dst[dstIdx + 1] = static_cast<quint16>(qBound(0.0f, src[srcIdx + 1], 1.0f) * 65535.0f); // G -> G
-                        dst[dstIdx] = static_cast<quint16>(qBound(0.0f, src[srcIdx + 2], 1.0f) * 65535.0f);     // R -> R
-                        dst[dstIdx + 3] = 65535; // Alpha = 1.0
-                    }
-                }
-            }
+            });
         }
         break;
 
     case QPsdFileHeader::CMYK:
         if (depth == 8 || depth == 16) {
             // Note: 16-bit CMYK is converted to 8-bit in toImage()
-            image = QImage(w, h, QImage::Format_CMYK8888);
-            if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h * 4) {
-                memcpy(image.bits(), data.constData(), w * h * 4);
-            } else {
-                qFatal() << Q_FUNC_INFO << __LINE__;
-            }
+            decode(QImage::Format_CMYK8888);
         }
         break;
 
@@ -172,66 +131,35 @@ QImage imageDataToImage(const QPsdAbstractImage &imageData, const QPsdFileHeader
             const QByteArray palette = colorModeData.colorData();
             if (palette.size() == 768) { // 256 colors * 3 bytes (RGB)
                 // Convert indexed to RGB using palette
-                image = QImage(w, h, QImage::Format_RGB888);
-                if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h) {
-                    const uchar* src = reinterpret_cast<const uchar*>(data.constData());
-                    uchar* dst = image.bits();
-                    const uchar* pal = reinterpret_cast<const uchar*>(palette.constData());
-                    
-                    for (quint32 i = 0; i < w * h; ++i) {
-                        const int index = src[i];
-                        dst[i * 3 + 0] = pal[index * 3 + 0]; // R
-                        dst[i * 3 + 1] = pal[index * 3 + 1]; // G
-                        dst[i * 3 + 2] = pal[index * 3 + 2]; // B
+                const uchar* pal = reinterpret_cast<const uchar*>(palette.constData());
+                convert(QImage::Format_RGB888, [w, pal](const uchar *src, uchar *dst) {
+                    for (quint32 x = 0; x < w; ++x) {
+                        const int index = src[x];
+                        dst[x * 3 + 0] = pal[index * 3 + 0]; // R
+                        dst[x * 3 + 1] = pal[index * 3 + 1]; // G
+                        dst[x * 3 + 2] = pal[index * 3 + 2]; // B
                     }
-                } else {
-                    qFatal() << Q_FUNC_INFO << __LINE__;
-                }
+                });
             } else {
                 // No palette data or invalid size, fall back to grayscale
-                image = QImage(w, h, QImage::Format_Grayscale8);
-                if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h) {
-                    memcpy(image.bits(), data.constData(), w * h);
-                } else {
-                    qFatal() << Q_FUNC_INFO << __LINE__;
-                }
+                decode(QImage::Format_Grayscale8);
             }
         }
         break;
 
     case QPsdFileHeader::Lab:
-        if (depth == 8 || depth == 16) {
-            // Lab color is converted to RGB in toImage()
-            image = QImage(w, h, QImage::Format_RGB888);
-            if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h * 3) {
-                memcpy(image.bits(), data.constData(), w * h * 3);
-            } else {
-                qFatal() << Q_FUNC_INFO << __LINE__;
-            }
-        }
+        // Lab color is converted to RGB in toImage(), keeping 16-bit precision
+        if (depth == 8)
+            decode(QImage::Format_RGB888);
+        else if (depth == 16)
+            decode(QImage::Format_RGBA64);
         break;
 
     case QPsdFileHeader::Multichannel:
-        if (depth == 8 || depth == 16) {
-            // Multichannel is converted to grayscale in toImage()
-            image = QImage(w, h, QImage::Format_Grayscale8);
-            if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h) {
-                memcpy(image.bits(), data.constData(), w * h);
-            } else {
-                qFatal() << Q_FUNC_INFO << __LINE__;
-            }
-        }
-        break;
-
     case QPsdFileHeader::Duotone:
         if (depth == 8 || depth == 16) {
-            // Duotone is converted to grayscale in toImage()
-            image = QImage(w, h, QImage::Format_Grayscale8);
-            if (!image.isNull() && static_cast<size_t>(data.size()) >= static_cast<size_t>(w) * h) {
-                memcpy(image.bits(), data.constData(), w * h);
-            } else {
-                qFatal() << Q_FUNC_INFO << __LINE__;
-            }
+            // Multichannel and Duotone are converted to grayscale in toImage()
+            decode(QImage::Format_Grayscale8);
         }
         break;
 
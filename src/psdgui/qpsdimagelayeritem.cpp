@@ -2,9 +2,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qpsdimagelayeritem.h"
-
-#include <QtCore/QBuffer>
-#include <QtGui/QImageReader>
+#include "qpsdlinkedimagecache.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -27,23 +25,12 @@ QPsdImageLayerItem::~QPsdImageLayerItem() = default;
 
 QImage QPsdImageLayerItem::linkedImage() const
 {
-    const auto file = linkedFile();
-    if (!file.type.isEmpty()) {
-        QBuffer buffer;
-        buffer.setData(file.data);
-        buffer.open(QBuffer::ReadOnly);
-        QImageReader reader(&buffer, file.type.trimmed());
-        if (reader.canRead()) {
-            QImage image;
-            if (reader.read(&image)) {
-                return image;
-            }
-            qWarning() << reader.errorString();
-        } else {
-            qWarning() << file.type << "not supported for" << file.name;
-        }
-    }
-    return QImage();
+    return QPsdLinkedImageCache::image(linkedFile(), linkedFileKey());
+}
+
+QImage QPsdImageLayerItem::linkedImage(const QSize &size, Qt::AspectRatioMode mode) const
+{
+    return QPsdLinkedImageCache::scaledImage(linkedFile(), linkedFileKey(), size, mode);
 }
 
 QT_END_NAMESPACE
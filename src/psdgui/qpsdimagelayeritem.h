@@ -16,8 +16,17 @@ public:
     ~QPsdImageLayerItem() override;
     Type type() const override { return Image; }
 
+    /*!
+     * Returns the decoded image of the embedded linked file, through
+     * QPsdLinkedImageCache.
+     */
     QImage linkedImage() const;
 
+    /*!
+     * Returns the linked image scaled to \a size with \a mode.
+     */
+    QImage linkedImage(const QSize &size, Qt::AspectRatioMode mode = Qt::KeepAspectRatio) const;
+
 private:
     class Private;
     QScopedPointer<Private> d;
@@ -0,0 +1,171 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpsdlinkedimagecache.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCache>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtGui/QImageReader>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// costs are in KiB so that the budget fits in qsizetype on 32-bit platforms
+constexpr qsizetype DefaultMaxCost = 256 * 1024;
+
+struct Cache
+{
+    QMutex mutex;
+    // decoded images by key() and scaled images by key(), size and mode
+    QCache<QByteArray, QImage> images { DefaultMaxCost };
+};
+
+Q_GLOBAL_STATIC(Cache, cache)
+
+qsizetype costOf(const QImage &image)
+{
+    // failed decodes are cached too so that they are not retried on every paint
+    return qMax<qsizetype>(1, image.sizeInBytes() / 1024);
+}
+
+QByteArray scaledKey(const QByteArray &fileKey, const QSize &size, Qt::AspectRatioMode mode)
+{
+    QByteArray key = fileKey;
+    key += '\0';
+    key += QByteArray::number(size.width());
+    key += 'x';
+    key += QByteArray::number(size.height());
+    key += '/';
+    key += QByteArray::number(mode);
+    return key;
+}
+
+bool lookup(const QByteArray &key, QImage *image)
+{
+    QMutexLocker locker(&cache->mutex);
+    if (const auto *cached = cache->images.object(key)) {
+        *image = *cached;
+        return true;
+    }
+    return false;
+}
+
+void insert(const QByteArray &key, const QImage &image)
+{
+    QMutexLocker locker(&cache->mutex);
+    cache->images.insert(key, new QImage(image), costOf(image));
+}
+
+QImage decode(const QPsdLinkedLayer::LinkedFile &file)
+{
+    if (file.type.isEmpty())
+        return QImage();
+
+    QBuffer buffer;
+    buffer.setData(file.data);
+    buffer.open(QBuffer::ReadOnly);
+    QImageReader reader(&buffer, file.type.trimmed());
+    if (reader.canRead()) {
+        QImage image;
+        if (reader.read(&image)) {
+            return image;
+        }
+        qWarning() << reader.errorString();
+    } else {
+        qWarning() << file.type << "not supported for" << file.name;
+    }
+    return QImage();
+}
+
+} // namespace
+
+// the unique id stays the same when the linked file is edited, so the
+// size and a hash of the embedded bytes are part of the key. The cache lives
+// in memory only, qHashBits() does not need to be stable across runs.
+QByteArray QPsdLinkedImageCache::key(const QPsdLinkedLayer::LinkedFile &file)
+{
+    if (file.uniqueId.isEmpty())
+        return {};
+
+    QByteArray key = file.uniqueId;
+    key += '\0';
+    key += QByteArray::number(file.data.size());
+    key += '/';
+    key += QByteArray::number(quint64(qHashBits(file.data.constData(), file.data.size())), 16);
+    return key;
+}
+
+QImage QPsdLinkedImageCache::image(const QPsdLinkedLayer::LinkedFile &file)
+{
+    return image(file, key(file));
+}
+
+QImage QPsdLinkedImageCache::image(const QPsdLinkedLayer::LinkedFile &file, const QByteArray &key)
+{
+    if (key.isEmpty())
+        return decode(file);
+
+    QImage image;
+    if (lookup(key, &image))
+        return image;
+
+    // decoded without the lock, two threads may decode the same file once each
+    image = decode(file);
+    insert(key, image);
+    return image;
+}
+
+QImage QPsdLinkedImageCache::scaledImage(const QPsdLinkedLayer::LinkedFile &file, const QSize &size, Qt::AspectRatioMode mode)
+{
+    return scaledImage(file, key(file), size, mode);
+}
+
+QImage QPsdLinkedImageCache::scaledImage(const QPsdLinkedLayer::LinkedFile &file, const QByteArray &key, const QSize &size, Qt::AspectRatioMode mode)
+{
+    if (key.isEmpty()) {
+        const QImage image = decode(file);
+        return image.isNull() ? image : image.scaled(size, mode, Qt::SmoothTransformation);
+    }
+
+    const QByteArray sizeKey = scaledKey(key, size, mode);
+    QImage scaled;
+    if (lookup(sizeKey, &scaled))
+        return scaled;
+
+    const QImage image = QPsdLinkedImageCache::image(file, key);
+    if (!image.isNull())
+        scaled = image.scaled(size, mode, Qt::SmoothTransformation);
+    insert(sizeKey, scaled);
+    return scaled;
+}
+
+qint64 QPsdLinkedImageCache::maxCost()
+{
+    QMutexLocker locker(&cache->mutex);
+    return qint64(cache->images.maxCost()) * 1024;
+}
+
+void QPsdLinkedImageCache::setMaxCost(qint64 bytes)
+{
+    QMutexLocker locker(&cache->mutex);
+    cache->images.setMaxCost(qsizetype(qBound<qint64>(0, bytes / 1024, std::numeric_limits<qsizetype>::max())));
+}
+
+qint64 QPsdLinkedImageCache::totalCost()
+{
+    QMutexLocker locker(&cache->mutex);
+    return qint64(cache->images.totalCost()) * 1024;
+}
+
+void QPsdLinkedImageCache::clear()
+{
+    QMutexLocker locker(&cache->mutex);
+    cache->images.clear();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,79 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPSDLINKEDIMAGECACHE_H
+#define QPSDLINKEDIMAGECACHE_H
+
+#include <QtPsdGui/qpsdguiglobal.h>
+#include <QtPsdCore/qpsdlinkedlayer.h>
+
+#include <QtGui/QImage>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+ * Decoded images of the files embedded in linked layers, shared by every
+ * document of the process. Images are looked up by LinkedFile::uniqueId and
+ * the embedded bytes, so that a file edited under the same id is decoded
+ * again, and the least recently used ones are dropped when the cache grows
+ * over its budget. All functions are thread-safe.
+ */
+class Q_PSDGUI_EXPORT QPsdLinkedImageCache
+{
+public:
+    /*!
+     * Returns the decoded image of \a file, decoding it on first use.
+     * Files without a unique id are decoded every time.
+     * Returns a null image if the file can not be decoded.
+     */
+    static QImage image(const QPsdLinkedLayer::LinkedFile &file);
+
+    /*!
+     * Returns the decoded image of \a file looked up by \a key, which must be
+     * key() of \a file.
+     */
+    static QImage image(const QPsdLinkedLayer::LinkedFile &file, const QByteArray &key);
+
+    /*!
+     * Returns the image of \a file scaled to \a size with \a mode and
+     * Qt::SmoothTransformation. The scaled image is cached too.
+     */
+    static QImage scaledImage(const QPsdLinkedLayer::LinkedFile &file, const QSize &size,
+                              Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+
+    /*!
+     * Returns the scaled image of \a file looked up by \a key, which must be
+     * key() of \a file.
+     */
+    static QImage scaledImage(const QPsdLinkedLayer::LinkedFile &file, const QByteArray &key, const QSize &size,
+                              Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+
+    /*!
+     * Returns the key of \a file in the cache, empty if \a file has no
+     * unique id. It hashes the embedded bytes, so callers looking up the same
+     * file repeatedly compute it once and pass it to image() and scaledImage().
+     */
+    static QByteArray key(const QPsdLinkedLayer::LinkedFile &file);
+
+    /*!
+     * Returns the memory budget of the cache in bytes. Defaults to 256 MiB.
+     */
+    static qint64 maxCost();
+
+    /*!
+     * Sets the memory budget of the cache to \a bytes, dropping images
+     * if the cache is over it.
+     */
+    static void setMaxCost(qint64 bytes);
+
+    /*!
+     * Returns the memory used by the cached images in bytes.
+     */
+    static qint64 totalCost();
+
+    static void clear();
+};
+
+QT_END_NAMESPACE
+
+#endif // QPSDLINKEDIMAGECACHE_H
@@ -4,12 +4,12 @@
 #include "qpsdtextlayeritem.h"
 
 #include <QtCore/QCborMap>
+#include <QtCore/QMutex>
 #include <QtGui/QFontInfo>
 #include <QtGui/QFontDatabase>
 #include <QtGui/QFontMetrics>
 
 #include <QtPsdCore/QPsdTypeToolObjectSetting>
-#include <QtPsdCore/QPsdEngineDataParser>
 
 QT_BEGIN_NAMESPACE
 
@@ -18,7 +18,10 @@ namespace {
 // SourceHanSans-Medium -> "源ノ角ゴシック JP Medium", "Medium"
 // SourceHanSans-Bold -> "源ノ角ゴシック JP", "Bold"
 QFont findProperFont(const QString &name) {
+    // text layers of documents parsed on different threads share the cache
+    static QMutex mutex;
     static QHash<QString, QFont> cache;
+    QMutexLocker locker(&mutex);
     if (cache.contains(name))
         return cache.value(name);
     QFont font(name);
@@ -90,7 +93,6 @@ QPsdTextLayerItem::QPsdTextLayerItem(const QPsdLayerRecord &record)
 {
     const auto additionalLayerInformation = record.additionalLayerInformation();
     const auto tysh = additionalLayerInformation.value("TySh").value<QPsdTypeToolObjectSetting>();
-    const auto textData = tysh.textData();
     const auto transformParam = tysh.transform();
     const QTransform transform = QTransform(
         transformParam[0], transformParam[1],
@@ -98,15 +100,14 @@ QPsdTextLayerItem::QPsdTextLayerItem(const QPsdLayerRecord &record)
         transformParam[4], transformParam[5]
     );
 
-    const auto engineDataData = textData.data().value("EngineData").toByteArray();
-    const auto engineData = QPsdEngineDataParser::parseEngineData(engineDataData);
-    // qDebug().noquote() << QJsonDocument(engineData.toJsonObject()).toJson();
+    // only the parts in use are materialized, ResourceDict and most of
+    // DocumentResources are skipped over
+    const auto engineData = tysh.engineData();
 
-    const auto documentResources = engineData.value("DocumentResources"_L1).toMap();
-    const auto fontSet = documentResources.value("FontSet"_L1).toArray();
-    const auto styleSheetSet = documentResources.value("StyleSheetSet"_L1).toArray();
+    const auto fontSet = engineData.value(u"DocumentResources/FontSet").toArray();
+    const auto styleSheetSet = engineData.value(u"DocumentResources/StyleSheetSet").toArray();
 
-    const auto engineDict = engineData.value("EngineDict"_L1).toMap();
+    const auto engineDict = engineData.value(u"EngineDict").toMap();
     const auto editor = engineDict.value("Editor"_L1).toMap();
     const auto text = editor.value("Text"_L1).toString().replace("\r"_L1, "\n"_L1);
     const auto styleRun = engineDict.value("StyleRun"_L1).toMap();
@@ -6,6 +6,9 @@
 
 #include <QtGui/QPainter>
 
+#include <cstring>
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 
 class QPsdAbstractItem::Private
@@ -16,10 +19,19 @@ public:
 private:
     QPsdAbstractItem *q;
 public:
+    const QList<QPainterPath> &vectorMasks() const;
+    const QImage &clippingMask() const;
+
     const QPsdAbstractLayerItem *layer = nullptr;
     const QPsdAbstractLayerItem *maskItem = nullptr;
     const QMap<quint32, QString> group;
     const QModelIndex index;
+
+    // the masks are computed on first paint and kept until the item is
+    // deleted, which happens when the model is reset
+    mutable std::optional<QList<QPainterPath>> vectorMaskPaths;
+    mutable QImage clippingMaskImage;
+    QImage maskedImage;
 };
 
 QPsdAbstractItem::Private::Private(const QModelIndex &index, const QPsdAbstractLayerItem *layer, const QPsdAbstractLayerItem *maskItem, const QMap<quint32, QString> group, QPsdAbstractItem *parent)
@@ -30,6 +42,53 @@ QPsdAbstractItem::Private::Private(const QModelIndex &index, const QPsdAbstractL
     q->setGeometry(layer->rect());
 }
 
+const QList<QPainterPath> &QPsdAbstractItem::Private::vectorMasks() const
+{
+    if (!vectorMaskPaths) {
+        vectorMaskPaths.emplace();
+        QModelIndex index = this->index;
+        const auto *model = dynamic_cast<const QPsdWidgetTreeItemModel *>(index.model());
+        while (model && index.isValid()) {
+            const QPsdAbstractLayerItem *layer = model->layerItem(index);
+            if (layer->vectorMask().type != QPsdAbstractLayerItem::PathInfo::None)
+                vectorMaskPaths->append(layer->vectorMask().path);
+            index = model->parent(index);
+        }
+    }
+    return *vectorMaskPaths;
+}
+
+const QImage &QPsdAbstractItem::Private::clippingMask() const
+{
+    if (!layer || !maskItem)
+        return clippingMaskImage;
+    // text items change their geometry after construction
+    if (!clippingMaskImage.isNull() && clippingMaskImage.size() == q->size())
+        return clippingMaskImage;
+
+    const QImage maskImage = maskItem->transparencyMask();
+    if (maskImage.size().isEmpty() || !maskItem->rect().isValid() || q->size().isEmpty())
+        return clippingMaskImage;
+
+    // the transparency of the clipping layer as alpha, nothing shows outside of it
+    QImage image(q->size(), QImage::Format_Alpha8);
+    const auto source = maskImage.convertToFormat(QImage::Format_Grayscale8);
+    if (image.isNull() || source.isNull())
+        return clippingMaskImage;
+    image.fill(0);
+    const auto geometry = q->geometry();
+    // the mask image is not always as large as the layer, only the pixels it has are copied
+    const QRect sourceRect(maskItem->rect().topLeft(), source.size());
+    const auto intersected = sourceRect.intersected(geometry);
+    for (int y = intersected.top(); y <= intersected.bottom(); y++) {
+        const uchar *from = source.constScanLine(y - maskItem->rect().y()) + (intersected.x() - maskItem->rect().x());
+        uchar *to = image.scanLine(y - geometry.y()) + (intersected.x() - geometry.x());
+        std::memcpy(to, from, intersected.width());
+    }
+    clippingMaskImage = image;
+    return clippingMaskImage;
+}
+
 QPsdAbstractItem::QPsdAbstractItem(const QModelIndex &index, const QPsdAbstractLayerItem *layer, const QPsdAbstractLayerItem *maskItem, const QMap<quint32, QString> group, QWidget *parent)
     : QWidget(parent)
     , d(new Private(index, layer, maskItem, group, this))
@@ -49,29 +108,38 @@ QString QPsdAbstractItem::name() const
 
 void QPsdAbstractItem::setMask(QPainter *painter) const
 {
-    QModelIndex index = d->index;
-    const auto *model = dynamic_cast<const QPsdWidgetTreeItemModel *>(index.model());
-    while (index.isValid()) {
-        const QPsdAbstractLayerItem *layer = model->layerItem(index);
-        if (layer->vectorMask().type != QPsdAbstractLayerItem::PathInfo::None) {
-            painter->setClipPath(layer->vectorMask().path, Qt::IntersectClip);
-        }
-        index = model->parent(index);
-    }
-    if (d->layer && d->maskItem) {
-        QPixmap pixmap(size());
-        pixmap.fill(Qt::transparent);
-        const auto maskItem = d->maskItem;
-        const QImage maskImage = maskItem->transparencyMask();
-        if (!maskImage.size().isEmpty() && maskItem->rect().isValid()) {
-            const auto intersected = maskItem->rect().intersected(geometry());
-            QPainter p(&pixmap);
-            p.drawImage(intersected.translated(-x(), -y()), maskImage, intersected.translated(-maskItem->rect().x(), -maskItem->rect().y()));
-            p.end();
-
-            painter->setClipRegion(QRegion(pixmap.createHeuristicMask()), Qt::IntersectClip);
-        }
-    }
+    for (const auto &path : d->vectorMasks())
+        painter->setClipPath(path, Qt::IntersectClip);
+}
+
+QPaintDevice *QPsdAbstractItem::beginMaskedPaint()
+{
+    if (d->clippingMask().isNull())
+        return this;
+    const qreal dpr = devicePixelRatioF();
+    d->maskedImage = QImage(size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    if (d->maskedImage.isNull())
+        return this;
+    d->maskedImage.setDevicePixelRatio(dpr);
+    d->maskedImage.fill(Qt::transparent);
+    return &d->maskedImage;
+}
+
+void QPsdAbstractItem::endMaskedPaint(QPainter::CompositionMode mode)
+{
+    if (d->maskedImage.isNull())
+        return;
+
+    QPainter masked(&d->maskedImage);
+    masked.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    masked.drawImage(rect(), d->clippingMask());
+    masked.end();
+
+    QPainter painter(this);
+    painter.setCompositionMode(mode);
+    painter.drawImage(rect(), d->maskedImage);
+    painter.end();
+    d->maskedImage = QImage();
 }
 
 const QPsdAbstractLayerItem *QPsdAbstractItem::abstractLayer() const
@@ -8,11 +8,10 @@
 
 #include <QtWidgets/QWidget>
 #include <QtCore/QPersistentModelIndex>
+#include <QtGui/QPainter>
 
 QT_BEGIN_NAMESPACE
 
-class QPainter;
-
 class QPsdAbstractItem : public QWidget
 {
     Q_OBJECT
@@ -29,6 +28,15 @@ public:
 protected:
     void setMask(QPainter *painter) const;
 
+    /*!
+     * Returns the device to paint the item to. Layers clipped to another layer
+     * are painted to an offscreen image, which endMaskedPaint() masks with the
+     * transparency of that layer and draws to the item with \a mode.
+     * Other items paint to the widget directly.
+     */
+    QPaintDevice *beginMaskedPaint();
+    void endMaskedPaint(QPainter::CompositionMode mode = QPainter::CompositionMode_SourceOver);
+
     template<class T>
     const T *layer() const { return reinterpret_cast<const T *>(abstractLayer()); }
 
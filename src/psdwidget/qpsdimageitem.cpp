@@ -19,16 +19,17 @@ void QPsdImageItem::paintEvent(QPaintEvent *event)
 {
     QPsdAbstractItem::paintEvent(event);
 
-    QPainter painter(this);
+    QPaintDevice *device = beginMaskedPaint();
+    QPainter painter(device);
     setMask(&painter);
 
     const auto *layer = this->layer<QPsdImageLayerItem>();
     QRect r = rect();
     QImage image = layer->image();
 
-    QImage linkedImage = layer->linkedImage();
+    const QImage linkedImage = layer->linkedImage(size());
     if (!linkedImage.isNull()) {
-        image = linkedImage.scaled(width(), height(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        image = linkedImage;
         r = QRect((width() - image.width()) / 2, (height() - image.height()) / 2, image.width(), image.height());
     }
 
@@ -103,7 +104,10 @@ void QPsdImageItem::paintEvent(QPaintEvent *event)
         }
     }
 
-    painter.setCompositionMode(QtPsdGui::compositionMode(layer->record().blendMode()));
+    // a clipped layer is blended when the masked image is drawn to the item
+    const auto compositionMode = QtPsdGui::compositionMode(layer->record().blendMode());
+    if (device == this)
+        painter.setCompositionMode(compositionMode);
     
     // Finally, draw the layer itself
     painter.drawImage(r, image);
@@ -115,6 +119,9 @@ void QPsdImageItem::paintEvent(QPaintEvent *event)
         painter.setBrush(QBrush(*gradient));
         painter.drawRect(rect());
     }
+
+    painter.end();
+    endMaskedPaint(compositionMode);
 }
 
 QT_END_NAMESPACE
@@ -20,7 +20,7 @@ void QPsdShapeItem::paintEvent(QPaintEvent *event)
 
     const auto *layer = this->layer<QPsdShapeLayerItem>();
 
-    QPainter painter(this);
+    QPainter painter(beginMaskedPaint());
     setMask(&painter);
     painter.setOpacity(abstractLayer()->opacity());
     painter.setRenderHint(QPainter::Antialiasing);
@@ -43,6 +43,8 @@ void QPsdShapeItem::paintEvent(QPaintEvent *event)
         // TODO: find the pattern from below
         // However, there is no way to access it from here yet
         // parser.layerAndMaskInformation().additionalLayerInformation().value("Patt");
+        painter.end();
+        endMaskedPaint();
         return;
     } else {
         painter.setPen(layer->pen());
@@ -61,6 +63,9 @@ void QPsdShapeItem::paintEvent(QPaintEvent *event)
         painter.drawPath(pathInfo.path);
         break;
     }
+
+    painter.end();
+    endMaskedPaint();
 }
 
 QT_END_NAMESPACE
@@ -7,8 +7,11 @@
 #include "qpsdimageitem.h"
 #include "qpsdfolderitem.h"
 
+#include <QtCore/QCache>
+
 #include <QtGui/QPainter>
 #include <QtGui/QPaintEvent>
+#include <QtGui/QPixmap>
 
 #include <QtWidgets/QRubberBand>
 
@@ -23,8 +26,17 @@ private:
     QPsdView *q;
 
 public:
+    // the layers are composited in tiles of this size, which are kept until a layer in them changes
+    static constexpr int TileSize = 256;
+
     void modelChanged(QPsdWidgetTreeItemModel *model);
+    void renderTiles(const QRect &area);
+    void invalidate(const QRect &rect);
 
+    // never shown, the items are only rendered into tiles
+    QWidget *canvas;
+    QCache<quint64, QPixmap> tiles;
+    qreal tileDevicePixelRatio = 1;
     QRubberBand *rubberBand;
     QPsdWidgetTreeItemModel *model = nullptr;
     QMetaObject::Connection modelConnection;
@@ -33,8 +45,12 @@ public:
 
 QPsdView::Private::Private(QPsdView *parent)
     : q(parent)
+    , canvas(new QWidget(q))
     , rubberBand(new QRubberBand(QRubberBand::Rectangle, q))
 {
+    canvas->hide();
+    // in KiB, 256 MiB of tiles
+    tiles.setMaxCost(256 * 1024);
     rubberBand->hide();
 }
 
@@ -49,6 +65,59 @@ void QPsdView::Private::modelChanged(QPsdWidgetTreeItemModel *model)
     q->reset();
 }
 
+static quint64 tileKey(int column, int row)
+{
+    return (quint64(row) << 32) | quint32(column);
+}
+
+void QPsdView::Private::renderTiles(const QRect &area)
+{
+    // the missing tiles are rendered together, so that every item is painted once
+    QRegion region;
+    QList<QRect> missing;
+    for (int row = area.top() / TileSize; row <= area.bottom() / TileSize; row++) {
+        for (int column = area.left() / TileSize; column <= area.right() / TileSize; column++) {
+            if (tiles.contains(tileKey(column, row)))
+                continue;
+            const QRect rect(column * TileSize, row * TileSize, TileSize, TileSize);
+            missing.append(rect);
+            region += rect;
+        }
+    }
+    if (missing.isEmpty())
+        return;
+
+    const QRect bounds = region.boundingRect();
+    const qreal dpr = tileDevicePixelRatio;
+    QPixmap pixmap(bounds.size() * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+    canvas->render(&pixmap, QPoint(), region, QWidget::DrawChildren);
+
+    for (const auto &rect : missing) {
+        const QRect source((rect.topLeft() - bounds.topLeft()) * dpr, rect.size() * dpr);
+        auto *tile = new QPixmap(pixmap.copy(source));
+        tile->setDevicePixelRatio(dpr);
+        const qint64 cost = qint64(tile->width()) * tile->height() * tile->depth() / 8 / 1024;
+        tiles.insert(tileKey(rect.x() / TileSize, rect.y() / TileSize), tile, qMax<qint64>(1, cost));
+    }
+}
+
+void QPsdView::Private::invalidate(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+    const int left = qMax(0, rect.left() / TileSize);
+    const int top = qMax(0, rect.top() / TileSize);
+    const int right = rect.right() / TileSize;
+    const int bottom = rect.bottom() / TileSize;
+    for (int row = top; row <= bottom; row++) {
+        for (int column = left; column <= right; column++)
+            tiles.remove(tileKey(column, row));
+    }
+    q->update(rect);
+}
+
 QPsdView::QPsdView(QWidget *parent)
     : QWidget(parent)
     , d(new Private(this))
@@ -90,14 +159,17 @@ void QPsdView::setShowChecker(bool show)
 
 void QPsdView::reset()
 {
-    auto items = findChildren<QPsdAbstractItem *>(Qt::FindDirectChildrenOnly);
+    auto items = d->canvas->findChildren<QPsdAbstractItem *>(Qt::FindDirectChildrenOnly);
     qDeleteAll(items);
+    d->tiles.clear();
+    update();
 
     if (d->model == nullptr) {
         return;
     }
 
     resize(d->model->size());
+    d->canvas->resize(d->model->size());
     std::function<void(const QModelIndex, QWidget *)> traverseTree = [&](const QModelIndex index, QWidget *parent) {
         if (index.isValid()) {
             const QPsdAbstractLayerItem *layer = d->model->layerItem(index);
@@ -141,14 +213,18 @@ void QPsdView::reset()
         }
     };
 
-    traverseTree(QModelIndex(), this);
+    traverseTree(QModelIndex(), d->canvas);
 }
 
 void QPsdView::setItemVisible(quint32 id, bool visible)
 {
-    for (auto item : findChildren<QPsdAbstractItem *>()) {
+    for (auto item : d->canvas->findChildren<QPsdAbstractItem *>()) {
         if (item->id() == id) {
+            if (item->isHidden() == !visible)
+                break;
             item->setVisible(visible);
+            // only the tiles under the layer are composited again
+            d->invalidate(QRect(item->mapTo(d->canvas, QPoint(0, 0)), item->size()));
             break;
         }
     }
@@ -179,14 +255,39 @@ void QPsdView::paintEvent(QPaintEvent *event)
             }
         }
     }
+
+    if (!d->model)
+        return;
+
+    // tiles are rendered for the screen the view is on
+    if (!qFuzzyCompare(d->tileDevicePixelRatio, devicePixelRatioF())) {
+        d->tiles.clear();
+        d->tileDevicePixelRatio = devicePixelRatioF();
+    }
+
+    const QRect area = rect & d->canvas->rect();
+    if (area.isEmpty())
+        return;
+    d->renderTiles(area);
+    const int tileSize = Private::TileSize;
+    for (int row = area.top() / tileSize; row <= area.bottom() / tileSize; row++) {
+        for (int column = area.left() / tileSize; column <= area.right() / tileSize; column++) {
+            const QRect tileRect(column * tileSize, row * tileSize, tileSize, tileSize);
+            // rendered on demand, one at a time when the cache cannot hold the whole area
+            if (!d->tiles.contains(tileKey(column, row)))
+                d->renderTiles(tileRect);
+            if (const auto *tile = d->tiles.object(tileKey(column, row)))
+                painter.drawPixmap(tileRect.topLeft(), *tile);
+        }
+    }
 }
 
 void QPsdView::mouseDoubleClickEvent(QMouseEvent *event)
 {
-    auto children = findChildren<QPsdAbstractItem *>();
+    auto children = d->canvas->findChildren<QPsdAbstractItem *>();
     std::reverse(children.begin(), children.end());
     for (const auto *child : children) {
-        if (!child->isVisible())
+        if (!child->isVisibleTo(d->canvas))
             continue;
         if (!child->geometry().contains(event->pos()))
             continue;
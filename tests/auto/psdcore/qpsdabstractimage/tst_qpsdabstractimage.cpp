@@ -0,0 +1,114 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtCore/QtEndian>
+#include <QtPsdCore/QPsdAbstractImage>
+#include <QtTest/QtTest>
+
+#include "psdwriter.h"
+
+class ZipCodec : public QPsdAbstractImage
+{
+public:
+    using QPsdAbstractImage::decodeZip;
+};
+
+class tst_QPsdAbstractImage : public QObject
+{
+    Q_OBJECT
+private slots:
+    void decodeZip_data();
+    void decodeZip();
+};
+
+// a channel of width x height samples, big-endian as stored in a file
+static QByteArray samples(int width, int height, int depth)
+{
+    QByteArray ret;
+    for (int i = 0; i < width * height; i++) {
+        switch (depth) {
+        case 8:
+            ret.append(char(i * 37 + i / width));
+            break;
+        case 16:
+            PsdWriter::u16(&ret, quint16(i * 4099 + 17));
+            break;
+        case 32:
+            PsdWriter::bigEndian(&ret, (i % 7) / 7.0f - (i % 3) * 1.5f + i * 0.001f);
+            break;
+        }
+    }
+    return ret;
+}
+
+// the rows of data as Photoshop stores them with prediction
+static QByteArray predict(const QByteArray &data, int width, int height, int depth)
+{
+    const qsizetype bytesPerLine = qsizetype(width) * depth / 8;
+    QByteArray ret;
+    for (int y = 0; y < height; y++) {
+        const auto *row = reinterpret_cast<const uchar *>(data.constData()) + y * bytesPerLine;
+        QByteArray stored(bytesPerLine, '\0');
+        auto *out = reinterpret_cast<uchar *>(stored.data());
+        switch (depth) {
+        case 8:
+            for (int x = 0; x < width; x++)
+                out[x] = uchar(row[x] - (x > 0 ? row[x - 1] : 0));
+            break;
+        case 16:
+            for (int x = 0; x < width; x++) {
+                const quint16 previous = x > 0 ? qFromBigEndian<quint16>(row + (x - 1) * 2) : 0;
+                qToBigEndian<quint16>(quint16(qFromBigEndian<quint16>(row + x * 2) - previous), out + x * 2);
+            }
+            break;
+        case 32: {
+            // the bytes of the samples as four planes, most significant first,
+            // and the delta over the whole row of bytes
+            QByteArray planes(bytesPerLine, '\0');
+            for (int x = 0; x < width; x++) {
+                for (int b = 0; b < 4; b++)
+                    planes[b * width + x] = char(row[x * 4 + b]);
+            }
+            for (qsizetype i = 0; i < bytesPerLine; i++)
+                out[i] = uchar(uchar(planes.at(i)) - (i > 0 ? uchar(planes.at(i - 1)) : 0));
+            break; }
+        }
+        ret.append(stored);
+    }
+    return ret;
+}
+
+void tst_QPsdAbstractImage::decodeZip_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("depth");
+    QTest::addColumn<bool>("prediction");
+
+    // odd widths, shorter and longer than the 16 bytes unpredicted at a time
+    for (int width : { 13, 37 }) {
+        for (int depth : { 8, 16, 32 }) {
+            QTest::addRow("%d-bit %d", depth, width) << width << depth << false;
+            QTest::addRow("%d-bit %d with prediction", depth, width) << width << depth << true;
+        }
+    }
+}
+
+void tst_QPsdAbstractImage::decodeZip()
+{
+    QFETCH(int, width);
+    QFETCH(int, depth);
+    QFETCH(bool, prediction);
+
+    constexpr int height = 5;
+    const QByteArray expected = samples(width, height, depth);
+    const QByteArray stored = prediction ? predict(expected, width, height, depth) : expected;
+    if (prediction)
+        QVERIFY(stored != expected);
+    // qCompress() prepends the uncompressed size to the zlib stream
+    const QByteArray compressed = qCompress(stored).mid(4);
+
+    QCOMPARE(ZipCodec::decodeZip(compressed, width, height, depth, prediction), expected);
+}
+
+QTEST_MAIN(tst_QPsdAbstractImage)
+#include "tst_qpsdabstractimage.moc"
@@ -0,0 +1,244 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtPsdCore/QPsdAdditionalLayerInformationPlugin>
+#include <QtPsdCore/QPsdDescriptorPlugin>
+#include <QtPsdCore/QPsdEffectsLayerPlugin>
+#include <QtPsdCore/private/qpsdabstractplugin_p.h>
+#include <QtTest/QtTest>
+
+// a registry of plugins of an interface no library implements, in a directory of the test
+class Plugins : public QPsdAbstractPlugin
+{
+public:
+    using QPsdAbstractPlugin::Registry;
+    static constexpr char iid[] = "org.qt-project.Qt.QPsdTestFactoryInterface";
+};
+
+class tst_QPsdAbstractPlugin : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void fourCC();
+    void dispatch();
+    void index();
+    void indexUpdate();
+    void noIndex();
+
+private:
+    static QString libraryName();
+    static QJsonObject readIndex(const QString &fileName);
+    static void writeIndex(const QString &fileName, const QJsonObject &index);
+    static QJsonObject pretendPlugin(const QString &library);
+};
+
+void tst_QPsdAbstractPlugin::initTestCase()
+{
+    // keep the plugin index out of the cache of the user
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void tst_QPsdAbstractPlugin::fourCC()
+{
+    static_assert(QPsdAbstractPlugin::fourCC("8BIM") == 0x3842494d);
+    QCOMPARE(QPsdAbstractPlugin::fourCC("TySh"_ba), 0x54795368u);
+    QCOMPARE(QPsdAbstractPlugin::fromFourCC(QPsdAbstractPlugin::fourCC("obj ")), "obj "_ba);
+    QCOMPARE(QPsdAbstractPlugin::fourCC("toolong"), 0u);
+    QCOMPARE(QPsdAbstractPlugin::fourCC(""), 0u);
+}
+
+template <typename T>
+static void compare()
+{
+    const auto keys = T::keys();
+    QVERIFY(!keys.isEmpty());
+    for (const QByteArray &key : keys) {
+        const auto plugin = T::plugin(QPsdAbstractPlugin::fourCC(key));
+        QVERIFY2(plugin, key.constData());
+        QCOMPARE(plugin, T::plugin(key));
+    }
+    QCOMPARE(T::plugin(QPsdAbstractPlugin::fourCC("????")), nullptr);
+}
+
+void tst_QPsdAbstractPlugin::dispatch()
+{
+    // the 4-character code lookup finds the same plugins as the lookup by name
+    compare<QPsdDescriptorPlugin>();
+    compare<QPsdAdditionalLayerInformationPlugin>();
+    compare<QPsdEffectsLayerPlugin>();
+}
+
+void tst_QPsdAbstractPlugin::index()
+{
+    QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/qtpsd"_L1);
+    const auto indexes = cacheDir.entryInfoList(QStringList() << "plugins-*.json"_L1, QDir::Files);
+    if (indexes.isEmpty())
+        QSKIP("no plugins loaded from a directory");
+
+    // the keys of the index are those of the plugins, other tests may have
+    // indexed other kinds of plugins
+    const QStringList iids {
+        QString::fromLatin1(QPsdDescriptorFactoryInterface_iid),
+        QString::fromLatin1(QPsdAdditionalLayerInformationFactoryInterface_iid),
+        QString::fromLatin1(QPsdEffectsLayerPluginFactoryInterface_iid),
+    };
+    const QByteArrayList keys = QPsdDescriptorPlugin::keys()
+                          + QPsdAdditionalLayerInformationPlugin::keys()
+                          + QPsdEffectsLayerPlugin::keys();
+    int indexed = 0;
+    for (const QFileInfo &index : indexes) {
+        QFile file(index.absoluteFilePath());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const auto plugins = QJsonDocument::fromJson(file.readAll()).object();
+        for (const auto &plugin : plugins) {
+            const auto object = plugin.toObject();
+            if (!iids.contains(object.value("iid"_L1).toString()))
+                continue;
+            QVERIFY(object.value("size"_L1).toInteger() > 0);
+            for (const auto &key : object.value("keys"_L1).toArray()) {
+                QVERIFY2(keys.contains(key.toString().toLatin1()), qPrintable(key.toString()));
+                indexed++;
+            }
+        }
+    }
+    QVERIFY(indexed > 0);
+}
+
+QString tst_QPsdAbstractPlugin::libraryName()
+{
+#ifdef Q_OS_WIN
+    return u"test.dll"_s;
+#else
+    return u"test.so"_s;
+#endif
+}
+
+QJsonObject tst_QPsdAbstractPlugin::readIndex(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+void tst_QPsdAbstractPlugin::writeIndex(const QString &fileName, const QJsonObject &index)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+}
+
+// an index in which library is a plugin with the key "test", as long as the
+// size and modification time of the library match
+QJsonObject tst_QPsdAbstractPlugin::pretendPlugin(const QString &library)
+{
+    const QFileInfo info(library);
+    return QJsonObject {
+        { info.fileName(), QJsonObject {
+            { "size"_L1, info.size() },
+            { "lastModified"_L1, info.lastModified().toMSecsSinceEpoch() },
+            { "iid"_L1, QLatin1StringView(Plugins::iid) },
+            { "keys"_L1, QJsonArray { "test"_L1 } },
+        } },
+    };
+}
+
+void tst_QPsdAbstractPlugin::indexUpdate()
+{
+    QTemporaryDir temp;
+    QVERIFY(temp.isValid());
+    const QDir dir(temp.path());
+    const QString library = dir.filePath(libraryName());
+    {
+        QFile file(library);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a plugin");
+    }
+    const QString indexFileName = Plugins::Registry::indexFileName(dir, QLatin1StringView(Plugins::iid));
+    QVERIFY(!indexFileName.isEmpty());
+    QVERIFY(!QFile::exists(indexFileName));
+
+    // the library is read and indexed
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"is not a plugin of"_s));
+    QVERIFY(Plugins::Registry(Plugins::iid, dir).keys.isEmpty());
+    auto entry = readIndex(indexFileName).value(libraryName()).toObject();
+    QCOMPARE(entry.value("size"_L1).toInteger(), qint64(12));
+    QCOMPARE(entry.value("lastModified"_L1).toInteger(), QFileInfo(library).lastModified().toMSecsSinceEpoch());
+    QCOMPARE(entry.value("iid"_L1).toString(), QString());
+
+    // an unchanged library is taken from the index, which is left as it is
+    auto pretended = pretendPlugin(library);
+    writeIndex(indexFileName, pretended);
+    QCOMPARE(Plugins::Registry(Plugins::iid, dir).keys, QByteArrayList { "test"_ba });
+    QCOMPARE(readIndex(indexFileName), pretended);
+
+    // a new modification time reads the library again
+    {
+        QFile file(library);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(QFileInfo(library).lastModified().addSecs(-60), QFileDevice::FileModificationTime));
+    }
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"is not a plugin of"_s));
+    QVERIFY(Plugins::Registry(Plugins::iid, dir).keys.isEmpty());
+    entry = readIndex(indexFileName).value(libraryName()).toObject();
+    QCOMPARE(entry.value("lastModified"_L1).toInteger(), QFileInfo(library).lastModified().toMSecsSinceEpoch());
+    QCOMPARE(entry.value("iid"_L1).toString(), QString());
+
+    // and so does a new size
+    pretended = pretendPlugin(library);
+    writeIndex(indexFileName, pretended);
+    const QDateTime lastModified = QFileInfo(library).lastModified();
+    {
+        QFile file(library);
+        QVERIFY(file.open(QIODevice::Append));
+        file.write(" either");
+        QVERIFY(file.setFileTime(lastModified, QFileDevice::FileModificationTime));
+    }
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"is not a plugin of"_s));
+    QVERIFY(Plugins::Registry(Plugins::iid, dir).keys.isEmpty());
+    entry = readIndex(indexFileName).value(libraryName()).toObject();
+    QCOMPARE(entry.value("size"_L1).toInteger(), qint64(19));
+    QCOMPARE(entry.value("iid"_L1).toString(), QString());
+
+    QFile::remove(indexFileName);
+}
+
+void tst_QPsdAbstractPlugin::noIndex()
+{
+    QTemporaryDir temp;
+    QVERIFY(temp.isValid());
+    const QDir dir(temp.path());
+    const QString library = dir.filePath(libraryName());
+    {
+        QFile file(library);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a plugin");
+    }
+    const QString indexFileName = Plugins::Registry::indexFileName(dir, QLatin1StringView(Plugins::iid));
+    QVERIFY(!indexFileName.isEmpty());
+    QVERIFY(QDir().mkpath(QFileInfo(indexFileName).absolutePath()));
+    const auto pretended = pretendPlugin(library);
+    writeIndex(indexFileName, pretended);
+    auto cleanup = qScopeGuard([&] {
+        qunsetenv("QTPSD_NO_PLUGIN_INDEX");
+        QFile::remove(indexFileName);
+    });
+
+    qputenv("QTPSD_NO_PLUGIN_INDEX", "1");
+    QVERIFY(Plugins::Registry::indexFileName(dir, QLatin1StringView(Plugins::iid)).isEmpty());
+
+    // the index is neither used nor updated
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"is not a plugin of"_s));
+    QVERIFY(Plugins::Registry(Plugins::iid, dir).keys.isEmpty());
+    QCOMPARE(readIndex(indexFileName), pretended);
+
+    // nor written
+    QVERIFY(QFile::remove(indexFileName));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"is not a plugin of"_s));
+    QVERIFY(Plugins::Registry(Plugins::iid, dir).keys.isEmpty());
+    QVERIFY(!QFile::exists(indexFileName));
+}
+
+QTEST_MAIN(tst_QPsdAbstractPlugin)
+#include "tst_qpsdabstractplugin.moc"
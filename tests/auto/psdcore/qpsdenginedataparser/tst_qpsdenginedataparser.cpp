@@ -2,7 +2,9 @@
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include <QtTest/QtTest>
+#include <QtPsdCore/QPsdEngineDataDocument>
 #include <QtPsdCore/QPsdEngineDataParser>
+#include <QtPsdCore/QPsdEngineDataTokenizer>
 
 #include <QThread>
 
@@ -12,6 +14,12 @@ class tst_QPsdEngineDataParser : public QObject
 private slots:
     void parse_data();
     void parse();
+    void errors_data();
+    void errors();
+    void strings_data();
+    void strings();
+    void document_data();
+    void document();
 };
 
 void tst_QPsdEngineDataParser::parse_data()
@@ -53,5 +61,100 @@ void tst_QPsdEngineDataParser::parse()
     QCOMPARE(cbor.toJsonObject(), json.object());
 }
 
+void tst_QPsdEngineDataParser::errors_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("no dictionary") << "/A 1"_ba;
+    QTest::newRow("trailing data") << "<< /A 1 >> 2"_ba;
+    QTest::newRow("key without slash") << "<< A 1 >>"_ba;
+    QTest::newRow("missing value") << "<< /A >>"_ba;
+    QTest::newRow("invalid boolean") << "<< /A tru >>"_ba;
+    QTest::newRow("invalid number") << "<< /A 1.2.3 >>"_ba;
+    QTest::newRow("minus") << "<< /A - >>"_ba;
+    QTest::newRow("unterminated array") << "<< /A [ 1 2"_ba;
+    QTest::newRow("unterminated dictionary") << "<< /A << /B 1 >>"_ba;
+}
+
+void tst_QPsdEngineDataParser::errors()
+{
+    QFETCH(QByteArray, data);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("^QPsdEngineDataParser::ParseError"));
+    QPsdEngineDataParser::ParseError error;
+    QVERIFY(QPsdEngineDataParser::parseEngineData(data, &error).isEmpty());
+    QVERIFY(error);
+}
+
+void tst_QPsdEngineDataParser::strings_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QString>("string");
+
+    QTest::newRow("latin-1") << "(Hello \\\\ \\) world)"_ba << u"Hello \\ ) world"_s;
+    QTest::newRow("utf-16") << "(\xFE\xFF\x00H\x00\\)\x00i\x30\x42)"_ba << u"H)i\u3042"_s;
+    QTest::newRow("mac roman bom") << "(\xCB\x9B\xCB\x87Normal RGB)"_ba << u"Normal RGB"_s;
+    QTest::newRow("empty") << "()"_ba << QString();
+}
+
+void tst_QPsdEngineDataParser::strings()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QString, string);
+
+    QPsdEngineDataTokenizer tokenizer(data);
+    const auto token = tokenizer.next();
+    QCOMPARE(token.type, QPsdEngineDataTokenizer::String);
+    QCOMPARE(QPsdEngineDataTokenizer::decodeString(token.data), string);
+    QCOMPARE(tokenizer.next().type, QPsdEngineDataTokenizer::End);
+    QVERIFY(!tokenizer.hasError());
+}
+
+void tst_QPsdEngineDataParser::document_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<QStringList>("keys");
+
+    // the path and how to get to the same value in the parsed map
+    QTest::newRow("whole") << QString() << QStringList();
+    QTest::newRow("dictionary") << u"EngineDict"_s << QStringList { u"EngineDict"_s };
+    QTest::newRow("nested") << u"EngineDict/Editor/Text"_s << QStringList { u"EngineDict"_s, u"Editor"_s, u"Text"_s };
+    QTest::newRow("after skipped value") << u"Font/FillColor"_s << QStringList { u"Font"_s, u"FillColor"_s };
+    QTest::newRow("array") << u"Font/FillColor/Values"_s << QStringList { u"Font"_s, u"FillColor"_s, u"Values"_s };
+    QTest::newRow("array element") << u"Font/FillColor/Values/0"_s << QStringList { u"Font"_s, u"FillColor"_s, u"Values"_s, u"0"_s };
+    QTest::newRow("in array") << u"Font/StyleSheetSet/0/Name"_s << QStringList { u"Font"_s, u"StyleSheetSet"_s, u"0"_s, u"Name"_s };
+    QTest::newRow("missing key") << u"Font/Missing"_s << QStringList { u"Font"_s, u"Missing"_s };
+    QTest::newRow("out of range") << u"Font/FillColor/Values/4"_s << QStringList { u"Font"_s, u"FillColor"_s, u"Values"_s, u"4"_s };
+    QTest::newRow("into a number") << u"Font/FillColor/Type/0"_s << QStringList { u"Font"_s, u"FillColor"_s, u"Type"_s, u"0"_s };
+}
+
+void tst_QPsdEngineDataParser::document()
+{
+    QFETCH(QString, path);
+    QFETCH(QStringList, keys);
+
+    QFile engineDataFile(QFINDTESTDATA("data/psd-enginedata.ed"));
+    QVERIFY(engineDataFile.open(QIODevice::ReadOnly));
+    const QByteArray engineDataData = engineDataFile.readAll();
+
+    QCborValue expected = QPsdEngineDataParser::parseEngineData(engineDataData);
+    for (const auto &key : keys) {
+        if (expected.isArray()) {
+            bool ok = false;
+            const int index = key.toInt(&ok);
+            expected = ok ? expected.toArray().at(index) : QCborValue();
+        } else if (expected.isMap()) {
+            expected = expected.toMap().value(key);
+        } else {
+            expected = QCborValue();
+        }
+    }
+
+    const QPsdEngineDataDocument document(engineDataData);
+    QCOMPARE(document.value(path), expected);
+    QCOMPARE(document.contains(path), !expected.isUndefined());
+}
+
 QTEST_MAIN(tst_QPsdEngineDataParser)
 #include "tst_qpsdenginedataparser.moc"
@@ -0,0 +1,221 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtCore/private/qsimd_p.h>
+#include <QtPsdCore/private/qpsdimageconversion_p.h>
+#include <QtTest/QtTest>
+
+using Simd = QPsdImageConversion::Simd;
+
+class tst_QPsdImageConversion : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cleanup();
+    void interleave3x8_data() { kernels_data(); }
+    void interleave3x8();
+    void interleave4x8_data() { kernels_data(); }
+    void interleave4x8();
+    void interleave4x16_data() { kernels_data(); }
+    void interleave4x16();
+    void interleave4x32_data() { kernels_data(); }
+    void interleave4x32();
+    void scaleAlpha8_data() { kernels_data(); }
+    void scaleAlpha8();
+
+private:
+    void kernels_data();
+};
+
+// the bytes around the output, which the kernels must not touch
+static constexpr qsizetype guard = 64;
+
+// planar test data, every plane starting offset bytes after an aligned address
+struct Planes
+{
+    Planes(int count, qsizetype size, int offset)
+        : size(size), offset(offset)
+    {
+        data.resize(count * (size + 64) + 64);
+        for (qsizetype i = 0; i < data.size(); i++)
+            data[i] = char(i * 131 + i / 7);
+    }
+    const uchar *plane(int index) const
+    {
+        const auto *base = reinterpret_cast<const uchar *>(data.constData());
+        const auto aligned = (quintptr(base) + 63) & ~quintptr(63);
+        return reinterpret_cast<const uchar *>(aligned) + index * (size + 64) + offset;
+    }
+
+    QByteArray data;
+    qsizetype size;
+    int offset;
+};
+
+// the output with guard bytes on both sides, starting offset bytes after an
+// aligned address
+struct Output
+{
+    Output(qsizetype size, int offset)
+        : size(size)
+    {
+        data = QByteArray(size + 2 * guard + 128, '\xa5');
+        const auto aligned = (quintptr(data.data()) + 63) & ~quintptr(63);
+        bits = reinterpret_cast<uchar *>(aligned) + guard + offset;
+    }
+    QByteArray result() const { return QByteArray(reinterpret_cast<const char *>(bits), size); }
+    bool guardsIntact() const
+    {
+        for (qsizetype i = 1; i <= guard; i++) {
+            if (bits[-i] != 0xa5 || bits[size + i - 1] != 0xa5)
+                return false;
+        }
+        return true;
+    }
+
+    QByteArray data;
+    uchar *bits = nullptr;
+    qsizetype size;
+};
+
+static bool supported(Simd simd)
+{
+    switch (simd) {
+    case Simd::None:
+        return true;
+#ifdef __SSE2__
+    case Simd::Sse2:
+        return true;
+    case Simd::Ssse3:
+        return qCpuHasFeature(SSSE3);
+    case Simd::Avx2:
+        return qCpuHasFeature(AVX2);
+#endif
+    default:
+        return false;
+    }
+}
+
+void tst_QPsdImageConversion::cleanup()
+{
+    QPsdImageConversion::setMaximumSimd(Simd::Avx2);
+}
+
+void tst_QPsdImageConversion::kernels_data()
+{
+    QTest::addColumn<Simd>("simd");
+    QTest::addColumn<qsizetype>("count");
+    QTest::addColumn<int>("offset");
+
+    const QList<QPair<Simd, const char *>> simds = {
+        { Simd::None, "scalar" },
+        { Simd::Sse2, "sse2" },
+        { Simd::Ssse3, "ssse3" },
+        { Simd::Avx2, "avx2" },
+    };
+    // shorter than a vector, whole vectors and odd tails after them
+    for (const auto &simd : simds) {
+        for (qsizetype count : { 0, 1, 3, 15, 16, 17, 31, 32, 33, 63, 97 }) {
+            for (int offset : { 0, 1, 7 })
+                QTest::addRow("%s %lld +%d", simd.second, qlonglong(count), offset) << simd.first << count << offset;
+        }
+    }
+}
+
+#define FETCH_KERNEL \
+    QFETCH(Simd, simd); \
+    QFETCH(qsizetype, count); \
+    QFETCH(int, offset); \
+    if (!supported(simd)) \
+        QSKIP("Not supported by this CPU"); \
+    QPsdImageConversion::setMaximumSimd(simd)
+
+void tst_QPsdImageConversion::interleave3x8()
+{
+    FETCH_KERNEL;
+
+    const Planes planes(3, count, offset);
+    QByteArray expected;
+    for (qsizetype i = 0; i < count; i++) {
+        for (int c = 0; c < 3; c++)
+            expected.append(char(planes.plane(c)[i]));
+    }
+
+    Output output(count * 3, offset);
+    QPsdImageConversion::interleave3x8(output.bits, planes.plane(0), planes.plane(1), planes.plane(2), count);
+    QCOMPARE(output.result(), expected);
+    QVERIFY(output.guardsIntact());
+}
+
+void tst_QPsdImageConversion::interleave4x8()
+{
+    FETCH_KERNEL;
+
+    const Planes planes(4, count, offset);
+    for (uchar xorMask : { 0x00, 0xff }) {
+        QByteArray expected;
+        for (qsizetype i = 0; i < count; i++) {
+            for (int c = 0; c < 4; c++)
+                expected.append(char(planes.plane(c)[i] ^ xorMask));
+        }
+
+        Output output(count * 4, offset);
+        QPsdImageConversion::interleave4x8(output.bits, planes.plane(0), planes.plane(1), planes.plane(2), planes.plane(3), count, xorMask);
+        QCOMPARE(output.result(), expected);
+        QVERIFY(output.guardsIntact());
+    }
+}
+
+void tst_QPsdImageConversion::interleave4x16()
+{
+    FETCH_KERNEL;
+
+    const Planes planes(4, count * 2, offset);
+    QByteArray expected;
+    for (qsizetype i = 0; i < count; i++) {
+        for (int c = 0; c < 4; c++)
+            expected.append(reinterpret_cast<const char *>(planes.plane(c) + i * 2), 2);
+    }
+
+    Output output(count * 8, offset);
+    QPsdImageConversion::interleave4x16(output.bits, planes.plane(0), planes.plane(1), planes.plane(2), planes.plane(3), count);
+    QCOMPARE(output.result(), expected);
+    QVERIFY(output.guardsIntact());
+}
+
+void tst_QPsdImageConversion::interleave4x32()
+{
+    FETCH_KERNEL;
+
+    const Planes planes(4, count * 4, offset);
+    QByteArray expected;
+    for (qsizetype i = 0; i < count; i++) {
+        for (int c = 0; c < 4; c++)
+            expected.append(reinterpret_cast<const char *>(planes.plane(c) + i * 4), 4);
+    }
+
+    Output output(count * 16, offset);
+    QPsdImageConversion::interleave4x32(output.bits, planes.plane(0), planes.plane(1), planes.plane(2), planes.plane(3), count);
+    QCOMPARE(output.result(), expected);
+    QVERIFY(output.guardsIntact());
+}
+
+void tst_QPsdImageConversion::scaleAlpha8()
+{
+    FETCH_KERNEL;
+
+    const Planes planes(1, count, offset);
+    for (int opacity : { 0x00, 0x01, 0x80, 0xfe }) {
+        QByteArray expected;
+        for (qsizetype i = 0; i < count; i++)
+            expected.append(char(planes.plane(0)[i] * opacity / 0xff));
+
+        Output output(count, offset);
+        QPsdImageConversion::scaleAlpha8(output.bits, planes.plane(0), count, quint8(opacity));
+        QCOMPARE(output.result(), expected);
+        QVERIFY(output.guardsIntact());
+    }
+}
+
+QTEST_MAIN(tst_QPsdImageConversion)
+#include "tst_qpsdimageconversion.moc"
@@ -0,0 +1,165 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtPsdCore/QPsdFileHeader>
+#include <QtPsdCore/QPsdImageData>
+#include <QtPsdCore/QPsdImageDataReader>
+#include <QtPsdCore/QPsdParser>
+#include <QtTest/QtTest>
+
+#include "psdwriter.h"
+
+class tst_QPsdImageDataReader : public QObject
+{
+    Q_OBJECT
+private slots:
+    void bands_data();
+    void bands();
+    void zip_data();
+    void zip();
+    void errors();
+};
+
+// the rows [firstRow, firstRow + rowCount) of every plane of planar data
+static QByteArray rows(const QByteArray &planes, int channels, int height, qsizetype bytesPerLine, int firstRow, int rowCount)
+{
+    QByteArray ret;
+    const qsizetype planeSize = qsizetype(height) * bytesPerLine;
+    for (int channel = 0; channel < channels; channel++)
+        ret.append(planes.mid(channel * planeSize + firstRow * bytesPerLine, rowCount * bytesPerLine));
+    return ret;
+}
+
+void tst_QPsdImageDataReader::bands_data()
+{
+    QTest::addColumn<QString>("psd");
+
+    std::function<void(QDir *dir, const QDir &baseDir)> findPsd;
+    findPsd = [&](QDir *dir, const QDir &baseDir) {
+        for (const QString &subdir : dir->entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            dir->cd(subdir);
+            findPsd(dir, baseDir);
+            dir->cdUp();
+        }
+        for (const QString &fileName : dir->entryList(QStringList() << "*.psd")) {
+            QString relativePath = baseDir.relativeFilePath(dir->filePath(fileName));
+            QTest::newRow(relativePath.toLatin1().data()) << dir->filePath(fileName);
+        }
+    };
+
+    QDir agPsd(QFINDTESTDATA("../../3rdparty/ag-psd/test/"));
+    findPsd(&agPsd, QDir(agPsd));
+
+    QDir psdTools(QFINDTESTDATA("../../3rdparty/psd-tools/tests/psd_files/"));
+    findPsd(&psdTools, QDir(psdTools));
+}
+
+void tst_QPsdImageDataReader::bands()
+{
+    QFETCH(QString, psd);
+
+    QPsdParser parser;
+    parser.load(psd);
+    const auto header = parser.fileHeader();
+    const QByteArray expected = parser.imageData().imageData();
+
+    QPsdImageDataReader reader(psd);
+    if (!reader.open())
+        QSKIP("no image data");
+    QCOMPARE(reader.header().size(), header.size());
+
+    // an odd band height, so that bands do not line up with anything
+    reader.setBandHeight(7);
+    QCOMPARE(reader.bandCount(), (int(header.height()) + 6) / 7);
+
+    const qsizetype bytesPerLine = header.depth() == 1 ? (qsizetype(header.width()) + 7) / 8
+                                                       : qsizetype(header.width()) * header.depth() / 8;
+    for (int i = 0; i < reader.bandCount(); i++) {
+        const int firstRow = i * 7;
+        const int rowCount = std::min<int>(7, header.height() - firstRow);
+        const auto band = reader.readBand(i);
+        QCOMPARE(band.width(), header.width());
+        QCOMPARE(band.height(), quint32(rowCount));
+        QCOMPARE(band.imageData(), rows(expected, header.channels(), header.height(), bytesPerLine, firstRow, rowCount));
+        const auto lineSize = band.toImageBytesPerLine(header.colorMode());
+        if (lineSize > 0)
+            QCOMPARE(band.toImage(header.colorMode()), parser.imageData().toImage(header.colorMode()).mid(firstRow * lineSize, rowCount * lineSize));
+    }
+    QVERIFY(reader.readBand(reader.bandCount()).imageData().isEmpty());
+}
+
+void tst_QPsdImageDataReader::zip_data()
+{
+    QTest::addColumn<bool>("prediction");
+
+    QTest::newRow("without prediction") << false;
+    QTest::newRow("with prediction") << true;
+}
+
+void tst_QPsdImageDataReader::zip()
+{
+    QFETCH(bool, prediction);
+
+    // a 5x9 RGB document, its merged image data ZIP compressed
+    constexpr int width = 5;
+    constexpr int height = 9;
+    QByteArray planes;
+    for (int i = 0; i < 3 * width * height; i++)
+        planes.append(char(i * 7 + i / width));
+
+    QByteArray stored = planes;
+    if (prediction) {
+        // each row holds the differences to the previous byte
+        for (int row = 0; row < 3 * height; row++) {
+            for (int x = width - 1; x > 0; x--)
+                stored[row * width + x] = char(planes.at(row * width + x) - planes.at(row * width + x - 1));
+        }
+    }
+    // qCompress() prepends the uncompressed size to the zlib stream
+    const QByteArray compressed = qCompress(stored).mid(4);
+
+    using namespace PsdWriter;
+    QByteArray file = fileHeader(3, width, height, 8, QPsdFileHeader::RGB);
+    u32(&file, 0);
+    u32(&file, 0);
+    u32(&file, 0);
+    u16(&file, prediction ? 3 : 2);
+    file.append(compressed);
+
+    QTemporaryFile psd;
+    QVERIFY(psd.open());
+    psd.write(file);
+    psd.close();
+
+    QPsdImageDataReader reader(psd.fileName());
+    QVERIFY2(reader.open(), qPrintable(reader.errorString()));
+    reader.setBandHeight(4);
+    QCOMPARE(reader.bandCount(), 3);
+
+    // backwards as well, which inflates the stream again
+    for (int i : { 1, 2, 0, 2 }) {
+        const int firstRow = i * 4;
+        const int rowCount = std::min(4, height - firstRow);
+        QCOMPARE(reader.readBand(i).imageData(), rows(planes, 3, height, width, firstRow, rowCount));
+    }
+}
+
+void tst_QPsdImageDataReader::errors()
+{
+    QPsdImageDataReader missing("does-not-exist.psd"_L1);
+    QVERIFY(!missing.open());
+    QVERIFY(!missing.errorString().isEmpty());
+    QCOMPARE(missing.bandCount(), 0);
+    QVERIFY(missing.readBand(0).imageData().isEmpty());
+
+    QTemporaryFile notPsd;
+    QVERIFY(notPsd.open());
+    notPsd.write("not a psd file");
+    notPsd.close();
+    QPsdImageDataReader reader(notPsd.fileName());
+    QVERIFY(!reader.open());
+    QVERIFY(!reader.isOpen());
+}
+
+QTEST_MAIN(tst_QPsdImageDataReader)
+#include "tst_qpsdimagedatareader.moc"
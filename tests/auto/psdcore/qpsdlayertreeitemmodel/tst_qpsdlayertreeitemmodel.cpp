@@ -13,6 +13,7 @@ private slots:
     void parse_nested_layers();
     void parse_group();
     void parse_clippingmask();
+    void load_structureOnly();
 };
 
 void tst_QPsdLayerTreeItemModel::parse_nested_layers()
@@ -48,13 +49,18 @@ void tst_QPsdLayerTreeItemModel::parse_nested_layers()
 
         if (layerTree.hasChildren(index)) {
             for (int row = 0; row < layerTree.rowCount(index); row++) {
-                traverseTreeView(layerTree.index(row, 0, index));
+                const auto child = layerTree.index(row, 0, index);
+                QCOMPARE(child.row(), row);
+                QCOMPARE(layerTree.parent(child), index);
+                traverseTreeView(child);
             }
         }
     };
     traverseTreeView(QModelIndex());
 
     QCOMPARE(result, QList<qint32>({ 1, 2, 3, 0, 2, 0, 0, 0, 3, 0, 2, 0, 0, 0 }));
+    QVERIFY(!layerTree.index(1, 0, QModelIndex()).isValid());
+    QVERIFY(!layerTree.index(-1, 0, QModelIndex()).isValid());
 }
 
 void tst_QPsdLayerTreeItemModel::parse_group()
@@ -128,5 +134,33 @@ void tst_QPsdLayerTreeItemModel::parse_clippingmask()
     QCOMPARE(i5, i4c);
 }
 
+void tst_QPsdLayerTreeItemModel::load_structureOnly()
+{
+    QDir dir;
+    dir.cd(QFINDTESTDATA("data/"_L1));
+
+    QPsdLayerTreeItemModel fullTree;
+    fullTree.load(dir.filePath("nested_layers.psd"));
+
+    QPsdLayerTreeItemModel structureTree;
+    structureTree.load(dir.filePath("nested_layers.psd"), QPsdParser::StructureOnly);
+
+    std::function<void(const QModelIndex &, const QModelIndex &)> compareTree;
+    compareTree = [&](const QModelIndex &full, const QModelIndex &structure) {
+        QCOMPARE(structureTree.rowCount(structure), fullTree.rowCount(full));
+        if (full.isValid()) {
+            QCOMPARE(structureTree.layerId(structure), fullTree.layerId(full));
+            QCOMPARE(structureTree.layerName(structure), fullTree.layerName(full));
+            QCOMPARE(structureTree.rect(structure), fullTree.rect(full));
+            // channel data is decoded on demand and matches the full load
+            QCOMPARE(structureTree.layerRecord(structure)->imageData().imageData(),
+                     fullTree.layerRecord(full)->imageData().imageData());
+        }
+        for (int row = 0; row < fullTree.rowCount(full); row++)
+            compareTree(fullTree.index(row, 0, full), structureTree.index(row, 0, structure));
+    };
+    compareTree(QModelIndex(), QModelIndex());
+}
+
 QTEST_MAIN(tst_QPsdLayerTreeItemModel)
 #include "tst_qpsdlayertreeitemmodel.moc"
@@ -1,18 +1,36 @@
 // Copyright (C) 2024 Signal Slot Inc.
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
+#include <QtPsdCore/QPsdEngineDataParser>
 #include <QtPsdCore/QPsdFileHeader>
 #include <QtPsdCore/QPsdImageData>
 #include <QtPsdCore/QPsdLayerRecord>
 #include <QtPsdCore/QPsdParser>
+#include <QtPsdCore/QPsdThumbnail>
+#include <QtPsdCore/QPsdTypeToolObjectSetting>
+#include <QtGui/QImageWriter>
 #include <QtTest/QtTest>
 
+#include "psdwriter.h"
+
 class tst_QPsdParser : public QObject
 {
     Q_OBJECT
 private slots:
     void parse_data();
     void parse();
+    void parseMemoryMapped_data();
+    void parseMemoryMapped();
+    void parseThreaded_data();
+    void parseThreaded();
+    void parsePsb_data();
+    void parsePsb();
+    void resourcesOnly_data();
+    void resourcesOnly();
+    void thumbnail_data();
+    void thumbnail();
+    void engineData_data();
+    void engineData();
 
 private:
     void addPsdFiles();
@@ -56,5 +74,323 @@ void tst_QPsdParser::parse()
     parser.load(psd);
 }
 
+void tst_QPsdParser::parseMemoryMapped_data()
+{
+    addPsdFiles();
+}
+
+void tst_QPsdParser::parseMemoryMapped()
+{
+    QFETCH(QString, psd);
+
+    QPsdParser buffered;
+    buffered.load(psd);
+
+    QPsdParser mapped;
+    mapped.setLoadOptions(QPsdParser::MemoryMapped);
+    mapped.load(psd);
+
+    QCOMPARE(mapped.fileHeader().size(), buffered.fileHeader().size());
+    QCOMPARE(mapped.imageData().imageData(), buffered.imageData().imageData());
+
+    const auto mappedRecords = mapped.layerAndMaskInformation().layerInfo().records();
+    const auto bufferedRecords = buffered.layerAndMaskInformation().layerInfo().records();
+    QCOMPARE(mappedRecords.size(), bufferedRecords.size());
+    const auto mappedChannels = mapped.layerAndMaskInformation().layerInfo().channelImageData();
+    const auto bufferedChannels = buffered.layerAndMaskInformation().layerInfo().channelImageData();
+    QCOMPARE(mappedChannels.size(), bufferedChannels.size());
+    for (int i = 0; i < mappedRecords.size(); i++) {
+        QCOMPARE(mappedRecords.at(i).name(), bufferedRecords.at(i).name());
+        QCOMPARE(mappedRecords.at(i).rect(), bufferedRecords.at(i).rect());
+        QCOMPARE(mappedChannels.at(i).imageData(), bufferedChannels.at(i).imageData());
+        QCOMPARE(mappedChannels.at(i).transparencyMaskData(), bufferedChannels.at(i).transparencyMaskData());
+    }
+}
+
+void tst_QPsdParser::parseThreaded_data()
+{
+    addPsdFiles();
+}
+
+void tst_QPsdParser::parseThreaded()
+{
+    QFETCH(QString, psd);
+
+    QPsdParser serial;
+    serial.setMaxThreadCount(1);
+    serial.load(psd);
+
+    QPsdParser threaded;
+    threaded.setMaxThreadCount(4);
+    threaded.load(psd);
+
+    QCOMPARE(threaded.imageData().imageData(), serial.imageData().imageData());
+
+    const auto threadedChannels = threaded.layerAndMaskInformation().layerInfo().channelImageData();
+    const auto serialChannels = serial.layerAndMaskInformation().layerInfo().channelImageData();
+    QCOMPARE(threadedChannels.size(), serialChannels.size());
+    for (int i = 0; i < threadedChannels.size(); i++) {
+        QCOMPARE(threadedChannels.at(i).imageData(), serialChannels.at(i).imageData());
+        QCOMPARE(threadedChannels.at(i).transparencyMaskData(), serialChannels.at(i).transparencyMaskData());
+        QCOMPARE(threadedChannels.at(i).userSuppliedLayerMask(), serialChannels.at(i).userSuppliedLayerMask());
+    }
+}
+
+void tst_QPsdParser::parsePsb_data()
+{
+    QTest::addColumn<bool>("psb");
+
+    QTest::newRow("psd") << false;
+    QTest::newRow("psb") << true;
+}
+
+void tst_QPsdParser::parsePsb()
+{
+    QFETCH(bool, psb);
+
+    // a 3x2 RGB document with a single layer, RLE compressed, written as PSD or PSB
+    constexpr int width = 3;
+    constexpr int height = 2;
+    const QByteArray planes[] = { "\x10\x11\x12\x13\x14\x15", "\x20\x21\x22\x23\x24\x25", "\x30\x31\x32\x33\x34\x35" };
+
+    using namespace PsdWriter;
+    auto length = [&](QByteArray *data, quint64 value) {
+        if (psb)
+            u64(data, value);
+        else
+            u32(data, value);
+    };
+    // RLE byte counts followed by one literal run per row
+    auto rle = [&](const QList<QByteArray> &channelPlanes) {
+        QByteArray counts;
+        QByteArray rows;
+        for (const auto &plane : channelPlanes) {
+            for (int y = 0; y < height; y++) {
+                if (psb)
+                    u32(&counts, width + 1);
+                else
+                    u16(&counts, width + 1);
+                rows.append(char(width - 1));
+                rows.append(plane.mid(y * width, width));
+            }
+        }
+        return counts + rows;
+    };
+
+    QByteArray channelData[3];
+    for (int i = 0; i < 3; i++) {
+        u16(&channelData[i], 1);
+        channelData[i].append(rle({ planes[i] }));
+    }
+
+    QByteArray layerInfo;
+    u16(&layerInfo, 1);
+    u32(&layerInfo, 0);
+    u32(&layerInfo, 0);
+    u32(&layerInfo, height);
+    u32(&layerInfo, width);
+    u16(&layerInfo, 3);
+    for (int i = 0; i < 3; i++) {
+        u16(&layerInfo, i);
+        length(&layerInfo, channelData[i].size());
+    }
+    layerInfo.append("8BIMnorm");
+    layerInfo.append("\xff\x00\x00\x00", 4);
+    u32(&layerInfo, 12);
+    u32(&layerInfo, 0);
+    u32(&layerInfo, 0);
+    layerInfo.append("\x01" "a\x00\x00", 4);
+    for (const auto &data : channelData)
+        layerInfo.append(data);
+    if (layerInfo.size() % 2)
+        layerInfo.append('\0');
+
+    QByteArray layerAndMask;
+    length(&layerAndMask, layerInfo.size());
+    layerAndMask.append(layerInfo);
+    u32(&layerAndMask, 0);
+
+    QByteArray file = fileHeader(3, width, height, 8, QPsdFileHeader::RGB, psb);
+    u32(&file, 0);
+    u32(&file, 0);
+    length(&file, layerAndMask.size());
+    file.append(layerAndMask);
+    u16(&file, 1);
+    file.append(rle({ planes[0], planes[1], planes[2] }));
+
+    QTemporaryFile psd;
+    QVERIFY(psd.open());
+    psd.write(file);
+    psd.close();
+
+    QPsdParser parser;
+    parser.load(psd.fileName());
+
+    QCOMPARE(parser.fileHeader().isPsb(), psb);
+    QCOMPARE(parser.fileHeader().size(), QSize(width, height));
+    QCOMPARE(parser.imageData().imageData(), planes[0] + planes[1] + planes[2]);
+
+    const auto records = parser.layerAndMaskInformation().layerInfo().records();
+    QCOMPARE(records.size(), 1);
+    QCOMPARE(records.first().name(), QByteArray("a"));
+    QCOMPARE(records.first().rect(), QRect(0, 0, width, height));
+    const auto channels = parser.layerAndMaskInformation().layerInfo().channelImageData();
+    QCOMPARE(channels.size(), 1);
+    QByteArray bgr;
+    for (int i = 0; i < width * height; i++) {
+        bgr.append(planes[2].at(i));
+        bgr.append(planes[1].at(i));
+        bgr.append(planes[0].at(i));
+    }
+    QCOMPARE(channels.first().toImage(QPsdFileHeader::RGB), bgr);
+}
+
+void tst_QPsdParser::resourcesOnly_data()
+{
+    addPsdFiles();
+}
+
+void tst_QPsdParser::resourcesOnly()
+{
+    QFETCH(QString, psd);
+
+    QPsdParser full;
+    full.setLoadOptions(QPsdParser::StructureOnly);
+    full.load(psd);
+
+    QPsdParser resources;
+    resources.setLoadOptions(QPsdParser::ResourcesOnly);
+    resources.load(psd);
+
+    QCOMPARE(resources.fileHeader().size(), full.fileHeader().size());
+    QCOMPARE(resources.imageResources().imageResourceBlocks().size(), full.imageResources().imageResourceBlocks().size());
+    QVERIFY(resources.layerAndMaskInformation().layerInfo().records().isEmpty());
+    QCOMPARE(resources.imageResources().thumbnail().size(), full.imageResources().thumbnail().size());
+}
+
+void tst_QPsdParser::thumbnail_data()
+{
+    QTest::addColumn<int>("id");
+    QTest::addColumn<int>("format");
+
+    QTest::newRow("raw") << 1036 << int(QPsdThumbnail::RawRGB);
+    QTest::newRow("raw bgr") << 1033 << int(QPsdThumbnail::RawRGB);
+    QTest::newRow("jpeg") << 1036 << int(QPsdThumbnail::JpegRGB);
+}
+
+void tst_QPsdParser::thumbnail()
+{
+    QFETCH(int, id);
+    QFETCH(int, format);
+
+    // a 5x3 thumbnail, rows are padded to 4 bytes in raw data
+    constexpr int width = 5;
+    constexpr int height = 3;
+    constexpr int widthBytes = (width * 24 + 31) / 32 * 4;
+    QImage expected(width, height, QImage::Format_RGB888);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++)
+            expected.setPixelColor(x, y, format == QPsdThumbnail::RawRGB ? QColor(x * 50, y * 100, 30) : QColor(200, 40, 90));
+    }
+
+    QByteArray pixels;
+    if (format == QPsdThumbnail::RawRGB) {
+        const QImage stored = id == 1033 ? expected.rgbSwapped() : expected;
+        for (int y = 0; y < height; y++) {
+            pixels.append(reinterpret_cast<const char *>(stored.constScanLine(y)), width * 3);
+            pixels.append(widthBytes - width * 3, '\0');
+        }
+    } else {
+        if (!QImageWriter::supportedImageFormats().contains("jpeg"))
+            QSKIP("No JPEG support");
+        QBuffer buffer(&pixels);
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(expected.save(&buffer, "JPG", 100));
+    }
+
+    using namespace PsdWriter;
+
+    QByteArray resource;
+    u32(&resource, format);
+    u32(&resource, width);
+    u32(&resource, height);
+    u32(&resource, widthBytes);
+    u32(&resource, widthBytes * height);
+    u32(&resource, pixels.size());
+    u16(&resource, 24);
+    u16(&resource, 1);
+    resource.append(pixels);
+
+    QByteArray resources("8BIM");
+    u16(&resources, id);
+    u16(&resources, 0);
+    u32(&resources, resource.size());
+    resources.append(resource);
+    if (resource.size() % 2)
+        resources.append('\0');
+
+    // nothing after the image resources, it must not be read
+    QByteArray file = fileHeader(3, 500, 300, 8, QPsdFileHeader::RGB);
+    u32(&file, 0);
+    u32(&file, resources.size());
+    file.append(resources);
+
+    QTemporaryFile psd;
+    QVERIFY(psd.open());
+    psd.write(file);
+    psd.close();
+
+    QPsdParser parser;
+    parser.setLoadOptions(QPsdParser::ResourcesOnly);
+    parser.load(psd.fileName());
+    const auto thumbnail = parser.imageResources().thumbnail();
+    QVERIFY(thumbnail.isValid());
+    QCOMPARE(int(thumbnail.format()), format);
+    QCOMPARE(thumbnail.size(), QSize(width, height));
+
+    const QImage image = QPsdParser::thumbnail(psd.fileName());
+    QCOMPARE(image.size(), QSize(width, height));
+    if (format == QPsdThumbnail::RawRGB) {
+        QCOMPARE(image.convertToFormat(QImage::Format_RGB888), expected);
+    } else {
+        const QColor color = image.pixelColor(2, 1);
+        QVERIFY(qAbs(color.red() - 200) <= 8 && qAbs(color.green() - 40) <= 8 && qAbs(color.blue() - 90) <= 8);
+    }
+}
+
+void tst_QPsdParser::engineData_data()
+{
+    addPsdFiles();
+}
+
+void tst_QPsdParser::engineData()
+{
+    QFETCH(QString, psd);
+
+    QPsdParser parser;
+    parser.setLoadOptions(QPsdParser::StructureOnly);
+    parser.load(psd);
+
+    int textLayers = 0;
+    for (const auto &record : parser.layerAndMaskInformation().layerInfo().records()) {
+        const auto additionalLayerInformation = record.additionalLayerInformation();
+        if (!additionalLayerInformation.contains("TySh"))
+            continue;
+        textLayers++;
+        const auto tysh = additionalLayerInformation.value("TySh").value<QPsdTypeToolObjectSetting>();
+        const auto parsed = QPsdEngineDataParser::parseEngineData(tysh.textData().data().value("EngineData").toByteArray());
+
+        // read twice and from another copy of the setting, the second time from the cache
+        const auto engineDict = tysh.engineData().value(u"EngineDict");
+        QCOMPARE(engineDict, parsed.value("EngineDict"_L1));
+        const auto copy = additionalLayerInformation.value("TySh").value<QPsdTypeToolObjectSetting>();
+        QCOMPARE(copy.engineData().value(u"EngineDict"), engineDict);
+        QCOMPARE(copy.engineData().value(u"DocumentResources/FontSet"),
+                 parsed.value("DocumentResources"_L1).toMap().value("FontSet"_L1));
+    }
+    if (textLayers == 0)
+        QSKIP("no text layers");
+}
+
 QTEST_MAIN(tst_QPsdParser)
 #include "tst_qpsdparser.moc"
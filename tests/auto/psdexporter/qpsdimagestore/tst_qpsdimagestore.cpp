@@ -0,0 +1,136 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtCore/QTemporaryDir>
+#include <QtGui/QImage>
+#include <QtPsdExporter/QPsdImageStore>
+#include <QtTest/QtTest>
+
+using namespace Qt::StringLiterals;
+
+class tst_QPsdImageStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void save();
+    void deduplicate();
+    void collision();
+    void reexport();
+    void existingFile();
+
+private:
+    static QImage image(const QColor &color, const QSize &size = QSize(16, 16));
+};
+
+QImage tst_QPsdImageStore::image(const QColor &color, const QSize &size)
+{
+    QImage ret(size, QImage::Format_ARGB32);
+    ret.fill(color);
+    return ret;
+}
+
+void tst_QPsdImageStore::initTestCase()
+{
+    // keep the manifests out of the cache of the user
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void tst_QPsdImageStore::save()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QPsdImageStore store(QDir(dir.path()), u"images"_s);
+    QCOMPARE(store.save(u"red.png"_s, image(Qt::red), "PNG"), u"red.png"_s);
+    QVERIFY(store.waitForDone());
+
+    const QImage saved(dir.filePath(u"images/red.png"_s));
+    QCOMPARE(saved.size(), QSize(16, 16));
+    QCOMPARE(saved.pixelColor(0, 0), QColor(Qt::red));
+}
+
+void tst_QPsdImageStore::deduplicate()
+{
+    QTemporaryDir dir;
+    QPsdImageStore store(QDir(dir.path()), u"images"_s);
+    QCOMPARE(store.save(u"a.png"_s, image(Qt::red), "PNG"), u"a.png"_s);
+    // the same pixels under another name are stored once
+    QCOMPARE(store.save(u"b.png"_s, image(Qt::red), "png"), u"a.png"_s);
+    // a copy of the store shares what was saved
+    QPsdImageStore copy = store;
+    QCOMPARE(copy.save(u"c.png"_s, image(Qt::red), "PNG"), u"a.png"_s);
+    // the size is part of the identity
+    QCOMPARE(store.save(u"d.png"_s, image(Qt::red, QSize(8, 32)), "PNG"), u"d.png"_s);
+    QVERIFY(store.waitForDone());
+
+    const QStringList files = QDir(dir.filePath(u"images"_s)).entryList({ u"*.png"_s }, QDir::Files);
+    QCOMPARE(files, QStringList({ u"a.png"_s, u"d.png"_s }));
+}
+
+void tst_QPsdImageStore::collision()
+{
+    QTemporaryDir dir;
+    QPsdImageStore store(QDir(dir.path()), u"images"_s);
+    QCOMPARE(store.save(u"logo.png"_s, image(Qt::red), "PNG"), u"logo.png"_s);
+    QCOMPARE(store.save(u"logo.png"_s, image(Qt::green), "PNG"), u"logo_1.png"_s);
+    QCOMPARE(store.save(u"logo.png"_s, image(Qt::blue), "PNG"), u"logo_2.png"_s);
+    QCOMPARE(store.save(u"logo.png"_s, image(Qt::green), "PNG"), u"logo_1.png"_s);
+    QVERIFY(store.waitForDone());
+    QCOMPARE(QImage(dir.filePath(u"images/logo_1.png"_s)).pixelColor(0, 0), QColor(Qt::green));
+}
+
+void tst_QPsdImageStore::reexport()
+{
+    QTemporaryDir dir;
+    const QString path = dir.filePath(u"images/logo.png"_s);
+    {
+        QPsdImageStore store(QDir(dir.path()), u"images"_s);
+        store.save(u"logo.png"_s, image(Qt::red), "PNG");
+        store.save(u"other.png"_s, image(Qt::blue), "PNG");
+        QVERIFY(store.waitForDone());
+    }
+    // nothing but the images is written to the image directory
+    QCOMPARE(QDir(dir.filePath(u"images"_s)).entryList(QDir::Files | QDir::Hidden),
+             QStringList({ u"logo.png"_s, u"other.png"_s }));
+    const QDateTime written = QFileInfo(path).lastModified();
+
+    QTest::qWait(20);
+    {
+        // unchanged images are not written again
+        QPsdImageStore store(QDir(dir.path()), u"images"_s);
+        QCOMPARE(store.save(u"logo.png"_s, image(Qt::red), "PNG"), u"logo.png"_s);
+        // changed images replace the files written by the previous export
+        QCOMPARE(store.save(u"other.png"_s, image(Qt::green), "PNG"), u"other.png"_s);
+        QVERIFY(store.waitForDone());
+    }
+    QCOMPARE(QFileInfo(path).lastModified(), written);
+    QCOMPARE(QImage(dir.filePath(u"images/other.png"_s)).pixelColor(0, 0), QColor(Qt::green));
+
+    // a file replaced behind the back of the store is written again
+    QVERIFY(image(Qt::black, QSize(32, 32)).save(path, "PNG"));
+    {
+        QPsdImageStore store(QDir(dir.path()), u"images"_s);
+        QCOMPARE(store.save(u"logo.png"_s, image(Qt::red), "PNG"), u"logo.png"_s);
+        QVERIFY(store.waitForDone());
+    }
+    QCOMPARE(QImage(path).pixelColor(0, 0), QColor(Qt::red));
+}
+
+void tst_QPsdImageStore::existingFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(QDir(dir.path()).mkpath(u"images"_s));
+    // files the store did not write are kept, and reused if identical
+    QVERIFY(image(Qt::red).save(dir.filePath(u"images/red.png"_s), "PNG"));
+    QVERIFY(image(Qt::red).save(dir.filePath(u"images/taken.png"_s), "PNG"));
+
+    QPsdImageStore store(QDir(dir.path()), u"images"_s);
+    QCOMPARE(store.save(u"red.png"_s, image(Qt::red), "PNG"), u"red.png"_s);
+    QCOMPARE(store.save(u"taken.png"_s, image(Qt::blue), "PNG"), u"taken_1.png"_s);
+    QVERIFY(store.waitForDone());
+    QCOMPARE(QImage(dir.filePath(u"images/taken.png"_s)).pixelColor(0, 0), QColor(Qt::red));
+}
+
+QTEST_MAIN(tst_QPsdImageStore)
+#include "tst_qpsdimagestore.moc"
@@ -58,7 +58,7 @@ class MainWindow extends StatelessWidget {
                   top: 79,
                   width: 36,
                   child: Image.asset(
-                    "assets/images/slint.png", 
+                    "assets/images/qtquick_1.png", 
                     fit: BoxFit.contain,
                     height: 48,
                     width: 36,
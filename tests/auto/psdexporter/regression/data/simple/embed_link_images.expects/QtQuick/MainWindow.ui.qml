@@ -39,7 +39,7 @@ Item {
         Image {
             fillMode: Image.PreserveAspectFit
             height: 48
-            source: "images/slint.png"
+            source: "images/qtquick_1.png"
             width: 36
             x: 150
             y: 79
@@ -5,11 +5,16 @@
 
 #include <QtTest/QtTest>
 
+#include "psdwriter.h"
+
 class tst_QPsdExporter_Regression : public QObject {
     Q_OBJECT
 private slots:
+    void initTestCase();
     void exporter_data();
     void exporter();
+    void incremental_data();
+    void incremental();
 
 private:
     void removeContents(const QDir &dir);
@@ -19,6 +24,12 @@ private:
     void createGitKeep(const QString &path);
 };
 
+void tst_QPsdExporter_Regression::initTestCase()
+{
+    // keep the image store manifests out of the cache of the user
+    QStandardPaths::setTestModeEnabled(true);
+}
+
 void tst_QPsdExporter_Regression::removeContents(const QDir &dir) {
     const auto contentsInfo = dir.entryInfoList(QDir::AllDirs | QDir::Files | QDir::Filter::NoDotAndDotDot);
     for (auto &contentInfo : contentsInfo) {
@@ -206,5 +217,125 @@ void tst_QPsdExporter_Regression::exporter() {
     }
 }
 
+void tst_QPsdExporter_Regression::incremental_data()
+{
+    QTest::addColumn<QByteArray>("pluginKey");
+    const auto keys = QPsdExporterPlugin::keys();
+    for (const QByteArray key : { "QtQuick"_ba, "Slint"_ba, "Flutter"_ba }) {
+        if (keys.contains(key))
+            QTest::newRow(key.constData()) << key;
+    }
+}
+
+void tst_QPsdExporter_Regression::incremental()
+{
+    QFETCH(QByteArray, pluginKey);
+
+    // the fingerprints are written next to the document
+    QTemporaryDir temp;
+    QVERIFY(temp.isValid());
+    QString psd = temp.filePath("embed_link_images.psd"_L1);
+    QVERIFY(QFile::copy(QFINDTESTDATA("data/simple/embed_link_images.psd"_L1), psd));
+    QString to = temp.filePath("export"_L1);
+    QVERIFY(QDir().mkpath(to));
+
+    auto exporter = QPsdExporterPlugin::plugin(pluginKey);
+    auto exportOnce = [&]() {
+        QPsdGuiLayerTreeItemModel guiModel;
+        QPsdExporterTreeItemModel model;
+        model.setSourceModel(&guiModel);
+        model.load(psd);
+
+        QVariantMap hint;
+        hint.insert("resolution"_L1, model.size());
+        hint.insert("fontScaleFactor"_L1, 1.0);
+        hint.insert("imageScaling"_L1, false);
+        hint.insert("makeCompact"_L1, false);
+        hint.insert("incremental"_L1, true);
+        return exporter->exportTo(&model, to, hint);
+    };
+
+    auto snapshot = [&]() {
+        QMap<QString, std::pair<QDateTime, QByteArray>> ret;
+        QDirIterator it(to, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QFileInfo info = it.nextFileInfo();
+            QFile file(info.absoluteFilePath());
+            if (file.open(QIODevice::ReadOnly))
+                ret.insert(info.absoluteFilePath(), { info.lastModified(), file.readAll() });
+        }
+        return ret;
+    };
+
+    QVERIFY(exportOnce());
+    QVERIFY(QFile::exists(psd + "_fingerprints"_L1));
+    const auto first = snapshot();
+    QVERIFY(!first.isEmpty());
+
+    // nothing changed, nothing is written again
+    QTest::qWait(1100);
+    QVERIFY(exportOnce());
+    QCOMPARE(snapshot(), first);
+
+    // only the image of an edited layer is written again, whether layers
+    // have ids of their own, none or share one
+    struct Document {
+        QString name;
+        QList<PsdWriter::Layer> layers;
+        QMap<QString, std::pair<QDateTime, QByteArray>> before;
+        QString green;
+    };
+    QList<Document> documents;
+    for (const auto &name : { "ids"_L1, "noids"_L1, "sharedids"_L1 }) {
+        Document document { name, {
+            { QRect(0, 0, 8, 8), QColor(255, 0, 0) },
+            { QRect(2, 2, 4, 4), QColor(0, 255, 0) },
+            { QRect(4, 4, 4, 4), QColor(0, 0, 255) },
+        }, {}, {} };
+        const QByteArrayList names { "red"_ba, "green"_ba, "blue"_ba };
+        for (int i = 0; i < document.layers.size(); i++) {
+            document.layers[i].name = names.at(i);
+            document.layers[i].id = name == "ids"_L1 ? i + 1 : name == "noids"_L1 ? 0 : 7;
+        }
+        documents.append(document);
+    }
+    auto writeDocument = [&](const Document &document) {
+        psd = temp.filePath(document.name + ".psd"_L1);
+        to = temp.filePath(document.name);
+        QFile file(psd);
+        return QDir().mkpath(to) && file.open(QIODevice::WriteOnly)
+            && file.write(PsdWriter::document(QSize(8, 8), document.layers)) > 0;
+    };
+
+    for (auto &document : documents) {
+        QVERIFY(writeDocument(document));
+        QVERIFY(exportOnce());
+        document.before = snapshot();
+        const auto files = document.before.keys();
+        const auto found = std::find_if(files.cbegin(), files.cend(), [](const QString &path) {
+            return path.endsWith("/green.png"_L1);
+        });
+        QVERIFY2(found != files.cend(), qPrintable(files.join(u' ')));
+        document.green = *found;
+    }
+
+    QTest::qWait(1100);
+    for (auto &document : documents) {
+        document.layers[1].color = QColor(255, 255, 0);
+        QVERIFY(writeDocument(document));
+        QVERIFY(exportOnce());
+        const auto after = snapshot();
+        QCOMPARE(after.keys(), document.before.keys());
+        for (auto it = document.before.cbegin(); it != document.before.cend(); ++it) {
+            if (it.key() == document.green) {
+                QVERIFY2(after.value(it.key()).first > it.value().first, qPrintable(document.name));
+                QVERIFY2(after.value(it.key()).second != it.value().second, qPrintable(document.name));
+            } else {
+                QVERIFY2(after.value(it.key()) == it.value(), qPrintable(it.key()));
+            }
+        }
+    }
+}
+
 QTEST_MAIN(tst_QPsdExporter_Regression)
 #include "tst_qpsdexporter_regression.moc"
@@ -0,0 +1,128 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QThread>
+#include <QtPsdCore/QPsdParser>
+#include <QtPsdGui/QPsdAbstractLayerItem>
+#include <QtPsdGui/QPsdGuiLayerTreeItemModel>
+#include <QtPsdGui/QPsdTextLayerItem>
+#include <QtTest/QtTest>
+
+#include <memory>
+
+class tst_ConcurrentParse : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void parse();
+
+private:
+    QStringList m_files;
+};
+
+void tst_ConcurrentParse::initTestCase()
+{
+    std::function<void(QDir *dir)> findPsd;
+    findPsd = [&](QDir *dir) {
+        for (const QString &subdir : dir->entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            dir->cd(subdir);
+            findPsd(dir);
+            dir->cdUp();
+        }
+        for (const QString &fileName : dir->entryList(QStringList() << "*.psd"))
+            m_files.append(dir->filePath(fileName));
+    };
+
+    QDir agPsd(QFINDTESTDATA("../../3rdparty/ag-psd/test/"));
+    findPsd(&agPsd);
+
+    QDir psdTools(QFINDTESTDATA("../../3rdparty/psd-tools/tests/psd_files/"));
+    findPsd(&psdTools);
+}
+
+static QByteArray hash(const QImage &image)
+{
+    if (image.isNull())
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArrayView(image.constBits(), image.sizeInBytes()));
+    return hash.result().toHex();
+}
+
+// what the GUI layer tree makes of a file, one line per layer
+static QStringList summary(const QString &fileName)
+{
+    QPsdParser parser;
+    parser.load(fileName);
+    QPsdGuiLayerTreeItemModel model;
+    model.fromParser(parser);
+
+    QStringList ret;
+    std::function<void(const QModelIndex &parent)> walk;
+    walk = [&](const QModelIndex &parent) {
+        for (int row = 0; row < model.rowCount(parent); row++) {
+            const auto index = model.index(row, 0, parent);
+            const auto *item = model.layerItem(index);
+            if (item) {
+                const auto rect = item->rect();
+                QStringList fields {
+                    item->name(),
+                    QString::number(int(item->type())),
+                    u"%1,%2 %3x%4"_s.arg(rect.x()).arg(rect.y()).arg(rect.width()).arg(rect.height()),
+                    QString::fromLatin1(hash(item->image())),
+                    QString::fromLatin1(hash(item->transparencyMask())),
+                };
+                if (item->type() == QPsdAbstractLayerItem::Text) {
+                    const auto runs = static_cast<const QPsdTextLayerItem *>(item)->runs();
+                    for (const auto &run : runs)
+                        fields << run.text << run.font.toString() << run.color.name(QColor::HexArgb);
+                }
+                ret.append(fields.join(u'|'));
+            }
+            walk(index);
+        }
+    };
+    walk({});
+    return ret;
+}
+
+void tst_ConcurrentParse::parse()
+{
+    if (m_files.isEmpty())
+        QSKIP("no test data");
+
+    QList<QStringList> expected;
+    for (const auto &fileName : std::as_const(m_files))
+        expected.append(summary(fileName));
+
+    // every thread parses the first file at the same time, then every
+    // threadCount-th file, so that the plugins, the font cache and the image
+    // cache are used by all of them at once
+    const int threadCount = qBound(2, QThread::idealThreadCount(), 8);
+    QList<QStringList> actual(m_files.size());
+    QList<QStringList> first(threadCount);
+    // each thread writes its own elements only
+    QStringList *actualData = actual.data();
+    QStringList *firstData = first.data();
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back(QThread::create([&, t]() {
+            firstData[t] = summary(m_files.first());
+            for (qsizetype i = t; i < m_files.size(); i += threadCount)
+                actualData[i] = summary(m_files.at(i));
+        }));
+        threads.back()->start();
+    }
+    for (const auto &thread : threads)
+        QVERIFY(thread->wait(QDeadlineTimer(QDeadlineTimer::Forever)));
+
+    for (int t = 0; t < threadCount; t++)
+        QCOMPARE(first.at(t), expected.first());
+    for (qsizetype i = 0; i < m_files.size(); i++)
+        QCOMPARE(actual.at(i), expected.at(i));
+}
+
+QTEST_MAIN(tst_ConcurrentParse)
+#include "tst_concurrentparse.moc"
@@ -1,6 +1,8 @@
 // Copyright (C) 2024 Signal Slot Inc.
 // SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QtEndian>
 #include <QtGui/QImage>
 #include <QtPsdCore/QPsdFileHeader>
 #include <QtPsdCore/QPsdImageData>
@@ -9,6 +11,73 @@
 #include <QtPsdGui/qpsdguiglobal.h>
 #include <QtTest/QtTest>
 
+#include <cmath>
+
+#include "psdwriter.h"
+
+// planar Lab samples, L, a and b in the first three channels
+class LabImage : public QPsdAbstractImage
+{
+public:
+    LabImage(int depth, int width, int height)
+    {
+        setHeader(PsdWriter::readFileHeader(PsdWriter::fileHeader(3, width, height, depth, QPsdFileHeader::Lab)));
+        setWidth(width);
+        setHeight(height);
+
+        m_planeSize = qsizetype(width) * height * depth / 8;
+        m_data = QByteArray(m_planeSize * 3, '\0');
+        QRandomGenerator random(42);
+        random.fillRange(reinterpret_cast<quint32 *>(m_data.data()), m_data.size() / sizeof(quint32));
+    }
+
+    // sample i of channel, big endian as stored in a file
+    int sample(int channel, qsizetype i) const
+    {
+        const auto *p = plane(channel);
+        return depth() == 8 ? p[i] : qFromBigEndian<quint16>(p + i * 2);
+    }
+
+    QByteArray imageData() const override { return m_data.left(m_planeSize); }
+
+protected:
+    const unsigned char *plane(int index) const {
+        return reinterpret_cast<const unsigned char *>(m_data.constData()) + m_planeSize * index;
+    }
+    const unsigned char *gray() const override { return plane(0); }
+    const unsigned char *r() const override { return plane(0); }
+    const unsigned char *g() const override { return plane(1); }
+    const unsigned char *b() const override { return plane(2); }
+
+private:
+    QByteArray m_data;
+    qsizetype m_planeSize = 0;
+};
+
+// CIE L*a*b* (D65) to sRGB in double precision
+static void referenceLabToRgb(double L, double a, double b, double *rgb)
+{
+    const double fy = (L + 16) / 116;
+    const double fx = a / 500 + fy;
+    const double fz = fy - b / 200;
+    auto finv = [](double t) {
+        const double delta = 6.0 / 29;
+        return t > delta ? t * t * t : 3 * delta * delta * (t - 4.0 / 29);
+    };
+    const double X = 0.95047 * finv(fx);
+    const double Y = finv(fy);
+    const double Z = 1.08883 * finv(fz);
+    const double linear[] = {
+        3.2404542 * X - 1.5371385 * Y - 0.4985314 * Z,
+        -0.9692660 * X + 1.8760108 * Y + 0.0415560 * Z,
+        0.0556434 * X - 0.2040259 * Y + 1.0572252 * Z,
+    };
+    for (int i = 0; i < 3; i++) {
+        const double c = linear[i];
+        rgb[i] = qBound(0.0, c <= 0.0031308 ? 12.92 * c : 1.055 * std::pow(c, 1 / 2.4) - 0.055, 1.0);
+    }
+}
+
 class tst_ImageDataToImage : public QObject
 {
     Q_OBJECT
@@ -17,6 +86,10 @@ private slots:
     void imageData();
     void layerImageData_data();
     void layerImageData();
+    void toImageStride_data();
+    void toImageStride();
+    void labToRgb_data();
+    void labToRgb();
 
 private:
     void addPsdFiles();
@@ -111,5 +184,90 @@ void tst_ImageDataToImage::layerImageData()
     }
 }
 
+void tst_ImageDataToImage::toImageStride_data()
+{
+    addPsdFiles();
+}
+
+void tst_ImageDataToImage::toImageStride()
+{
+    QFETCH(QString, psd);
+
+    QPsdParser parser;
+    parser.load(psd);
+
+    const auto colorMode = parser.fileHeader().colorMode();
+    const auto layers = parser.layerAndMaskInformation().layerInfo().records();
+
+    for (const auto &layer : layers) {
+        const auto imageData = layer.imageData();
+        const auto lineSize = imageData.toImageBytesPerLine(colorMode);
+        if (imageData.width() == 0 || imageData.height() == 0 || lineSize == 0)
+            continue;
+
+        // padded rows must hold the same pixels as the packed buffer
+        const auto packed = imageData.toImage(colorMode);
+        QCOMPARE(packed.size(), lineSize * imageData.height());
+        const qsizetype bytesPerLine = lineSize + 5;
+        QByteArray padded(bytesPerLine * imageData.height(), '\x5a');
+        QVERIFY(imageData.toImage(colorMode, reinterpret_cast<uchar *>(padded.data()), bytesPerLine));
+        for (quint32 y = 0; y < imageData.height(); ++y) {
+            QCOMPARE(padded.mid(y * bytesPerLine, lineSize), packed.mid(y * lineSize, lineSize));
+            QCOMPARE(padded.mid(y * bytesPerLine + lineSize, 5), QByteArray(5, '\x5a'));
+        }
+
+        // and so must a range of rows
+        const int firstRow = imageData.height() / 2;
+        const int rowCount = imageData.height() - firstRow;
+        QByteArray rows(lineSize * rowCount, Qt::Uninitialized);
+        QVERIFY(imageData.toImage(colorMode, reinterpret_cast<uchar *>(rows.data()), lineSize, firstRow, rowCount));
+        QCOMPARE(rows, packed.mid(firstRow * lineSize));
+    }
+}
+
+void tst_ImageDataToImage::labToRgb_data()
+{
+    QTest::addColumn<int>("depth");
+
+    QTest::newRow("8") << 8;
+    QTest::newRow("16") << 16;
+}
+
+void tst_ImageDataToImage::labToRgb()
+{
+    QFETCH(int, depth);
+
+    constexpr int width = 67;
+    constexpr int height = 45;
+    const LabImage lab(depth, width, height);
+    const QImage image = QtPsdGui::imageDataToImage(lab, lab.header());
+    QCOMPARE(image.format(), depth == 8 ? QImage::Format_RGB888 : QImage::Format_RGBA64);
+    QCOMPARE(image.size(), QSize(width, height));
+
+    // L: 0 to 100, a and b: -128 to 128, neutral at half the range
+    const double max = depth == 8 ? 255 : 65535;
+    const double offset = depth == 8 ? 128 : 32768;
+    const double scale = depth == 8 ? 1 : 256;
+    for (int y = 0; y < height; y++) {
+        const uchar *line = image.constScanLine(y);
+        for (int x = 0; x < width; x++) {
+            const qsizetype i = qsizetype(y) * width + x;
+            double rgb[3];
+            referenceLabToRgb(lab.sample(0, i) * 100 / max,
+                              (lab.sample(1, i) - offset) / scale,
+                              (lab.sample(2, i) - offset) / scale, rgb);
+            for (int c = 0; c < 3; c++) {
+                const double expected = rgb[c] * max;
+                const double actual = depth == 8 ? line[x * 3 + c] : reinterpret_cast<const quint16 *>(line)[x * 4 + c];
+                // within one step at 8-bit, and a couple at 16-bit
+                QVERIFY2(std::abs(actual - expected) <= (depth == 8 ? 1.0 : 2.0),
+                         qPrintable(u"pixel %1,%2 channel %3: %4, expected %5"_s.arg(x).arg(y).arg(c).arg(actual).arg(expected)));
+            }
+            if (depth == 16)
+                QCOMPARE(reinterpret_cast<const quint16 *>(line)[x * 4 + 3], quint16(0xffff));
+        }
+    }
+}
+
 QTEST_MAIN(tst_ImageDataToImage)
 #include "tst_image_data_to_image.moc"
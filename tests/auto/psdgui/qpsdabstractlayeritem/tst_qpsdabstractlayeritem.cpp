@@ -0,0 +1,169 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtCore/QTemporaryFile>
+#include <QtGui/QImage>
+#include <QtPsdCore/QPsdParser>
+#include <QtPsdGui/QPsdAbstractLayerItem>
+#include <QtPsdGui/QPsdGuiLayerTreeItemModel>
+#include <QtTest/QtTest>
+
+#include "psdwriter.h"
+
+using namespace Qt::StringLiterals;
+using PsdWriter::Layer;
+
+class tst_QPsdAbstractLayerItem : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void image();
+    void imageCacheLimit();
+    void channelCache();
+
+private:
+    static const QPsdAbstractLayerItem *layerItem(const QPsdGuiLayerTreeItemModel &model, const QString &name);
+};
+
+const QPsdAbstractLayerItem *tst_QPsdAbstractLayerItem::layerItem(const QPsdGuiLayerTreeItemModel &model, const QString &name)
+{
+    for (int row = 0; row < model.rowCount(); row++) {
+        const auto *item = model.layerItem(model.index(row, 0));
+        if (item->name() == name)
+            return item;
+    }
+    return nullptr;
+}
+
+void tst_QPsdAbstractLayerItem::cleanup()
+{
+    QPsdAbstractLayerItem::setImageCacheLimit(0);
+}
+
+void tst_QPsdAbstractLayerItem::image()
+{
+    QList<Layer> layers {
+        { QRect(0, 0, 6, 4), QColor(255, 0, 0) },
+        { QRect(1, 1, 3, 2), QColor(0, 0, 255) },
+    };
+    layers[0].name = "red";
+    layers[1].name = "blue";
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(PsdWriter::document(QSize(6, 4), layers));
+    file.close();
+
+    QPsdParser parser;
+    parser.load(file.fileName());
+    QPsdGuiLayerTreeItemModel model;
+    model.fromParser(parser);
+    // loading the tree does not decode any layer
+    QCOMPARE(QPsdAbstractLayerItem::imageCacheSize(), qint64(0));
+
+    const auto *red = layerItem(model, u"red"_s);
+    const auto *blue = layerItem(model, u"blue"_s);
+    QVERIFY(red && blue);
+
+    const QImage image = blue->image();
+    QCOMPARE(image.size(), QSize(3, 2));
+    QCOMPARE(image.pixelColor(2, 1), QColor(0, 0, 255));
+    QVERIFY(QPsdAbstractLayerItem::imageCacheSize() > 0);
+    // decoded once and shared
+    QCOMPARE(blue->image().cacheKey(), image.cacheKey());
+    QCOMPARE(red->image().pixelColor(5, 3), QColor(255, 0, 0));
+
+    // decoding leaves the channels of the record intact
+    const auto imageData = blue->record().imageData();
+    QCOMPARE(imageData.imageData(), QByteArray(6, '\0'));
+    QCOMPARE(imageData.transparencyMaskData(), QByteArray(6, char(255)));
+}
+
+void tst_QPsdAbstractLayerItem::imageCacheLimit()
+{
+    QList<Layer> layers {
+        { QRect(0, 0, 300, 200), QColor(20, 40, 60) },
+        { QRect(50, 30, 200, 150), QColor(200, 100, 50) },
+    };
+    layers[0].name = "background";
+    layers[1].name = "foreground";
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(PsdWriter::document(QSize(300, 200), layers));
+    file.close();
+
+    QPsdParser parser;
+    parser.load(file.fileName());
+    QPsdGuiLayerTreeItemModel model;
+    model.fromParser(parser);
+
+    const auto *background = layerItem(model, u"background"_s);
+    const auto *foreground = layerItem(model, u"foreground"_s);
+    QVERIFY(background && foreground);
+    const QImage backgroundImage = background->image();
+    const QImage foregroundImage = foreground->image();
+    QVERIFY(QPsdAbstractLayerItem::imageCacheSize() > 0);
+
+    // smaller than a single layer, every layer is decoded again when needed
+    QPsdAbstractLayerItem::setImageCacheLimit(1024);
+    QCOMPARE(QPsdAbstractLayerItem::imageCacheLimit(), qint64(1024));
+    QVERIFY(QPsdAbstractLayerItem::imageCacheSize() <= 1024);
+    const QImage decoded = background->image();
+    QVERIFY(decoded.cacheKey() != backgroundImage.cacheKey());
+    QCOMPARE(decoded, backgroundImage);
+    QCOMPARE(foreground->image(), foregroundImage);
+    QVERIFY(QPsdAbstractLayerItem::imageCacheSize() <= 1024);
+
+    QPsdAbstractLayerItem::setImageCacheLimit(0);
+    QCOMPARE(QPsdAbstractLayerItem::imageCacheLimit(), qint64(0));
+    QCOMPARE(background->image().cacheKey(), background->image().cacheKey());
+}
+
+void tst_QPsdAbstractLayerItem::channelCache()
+{
+    QList<Layer> layers {
+        { QRect(0, 0, 40, 30), QColor(255, 0, 0) },
+        { QRect(10, 10, 20, 10), QColor(0, 0, 255) },
+    };
+    layers[0].name = "red";
+    layers[1].name = "blue";
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(PsdWriter::document(QSize(40, 30), layers));
+    file.close();
+
+    // the layer items keep no decompressed channels next to their images
+    auto verify = [](const QPsdGuiLayerTreeItemModel &model) {
+        for (const auto &name : { u"red"_s, u"blue"_s }) {
+            const auto *item = layerItem(model, name);
+            QVERIFY(item);
+            QCOMPARE(item->record().imageData().decompressedSize(), qsizetype(0));
+            QVERIFY(!item->image().isNull());
+            QCOMPARE(item->record().imageData().decompressedSize(), qsizetype(0));
+        }
+    };
+
+    // loading the model leaves the channels compressed
+    {
+        QPsdGuiLayerTreeItemModel model;
+        model.load(file.fileName());
+        verify(model);
+    }
+
+    // channels decompressed by the parser are not held by the layer items
+    QPsdParser parser;
+    parser.load(file.fileName());
+    const auto channelImageData = parser.layerAndMaskInformation().layerInfo().channelImageData();
+    QCOMPARE(channelImageData.size(), 2);
+    QVERIFY(channelImageData.first().decompressedSize() > 0);
+    QPsdGuiLayerTreeItemModel model;
+    model.fromParser(parser);
+    verify(model);
+}
+
+QTEST_MAIN(tst_QPsdAbstractLayerItem)
+#include "tst_qpsdabstractlayeritem.moc"
@@ -0,0 +1,249 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtCore/QTemporaryFile>
+#include <QtGui/QImage>
+#include <QtPsdCore/QPsdParser>
+#include <QtPsdGui/QPsdCompositor>
+#include <QtPsdGui/QPsdGuiLayerTreeItemModel>
+#include <QtTest/QtTest>
+
+#include "psdwriter.h"
+
+using PsdWriter::Layer;
+
+class tst_QPsdCompositor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void normal();
+    void opacity();
+    void blendModes_data();
+    void blendModes();
+    void clipping();
+    void groups();
+    void layerMask();
+    void tiles();
+
+private:
+    QImage render(const QSize &size, const QList<Layer> &layers, int maxThreadCount = 1, const QRect &rect = {});
+};
+
+QImage tst_QPsdCompositor::render(const QSize &size, const QList<Layer> &layers, int maxThreadCount, const QRect &rect)
+{
+    QTemporaryFile file;
+    if (!file.open())
+        return {};
+    file.write(PsdWriter::document(size, layers));
+    file.close();
+
+    QPsdParser parser;
+    parser.load(file.fileName());
+    QPsdGuiLayerTreeItemModel model;
+    model.fromParser(parser);
+    QPsdCompositor compositor(&model);
+    compositor.setMaxThreadCount(maxThreadCount);
+    return rect.isNull() ? compositor.render() : compositor.render(rect);
+}
+
+static bool fuzzyCompare(const QColor &actual, const QColor &expected, int tolerance = 1)
+{
+    if (qAbs(actual.red() - expected.red()) <= tolerance
+        && qAbs(actual.green() - expected.green()) <= tolerance
+        && qAbs(actual.blue() - expected.blue()) <= tolerance
+        && qAbs(actual.alpha() - expected.alpha()) <= tolerance)
+        return true;
+    qWarning() << actual << "expected" << expected;
+    return false;
+}
+
+void tst_QPsdCompositor::normal()
+{
+    const QSize size(4, 2);
+    const auto image = render(size, {
+        { QRect(0, 0, 4, 2), QColor(200, 0, 0) },
+        { QRect(2, 0, 2, 2), QColor(0, 0, 255, 128) },
+        { QRect(3, 1, 1, 1), QColor(0, 255, 0), "norm", 255, -1, false, true },
+    });
+    QCOMPARE(image.size(), size);
+    QCOMPARE(image.format(), QImage::Format_ARGB32_Premultiplied);
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(200, 0, 0)));
+    QVERIFY(fuzzyCompare(image.pixelColor(2, 0), QColor(100, 0, 128)));
+    // hidden layers are left out
+    QVERIFY(fuzzyCompare(image.pixelColor(3, 1), QColor(100, 0, 128)));
+
+    // uncovered pixels stay transparent
+    const auto partial = render(size, { { QRect(1, 0, 1, 1), QColor(0, 0, 255) } });
+    QCOMPARE(partial.pixelColor(0, 0).alpha(), 0);
+    QVERIFY(fuzzyCompare(partial.pixelColor(1, 0), QColor(0, 0, 255)));
+}
+
+void tst_QPsdCompositor::opacity()
+{
+    const QSize size(3, 1);
+    const auto image = render(size, {
+        { QRect(0, 0, 3, 1), QColor(0, 0, 0) },
+        { QRect(0, 0, 1, 1), QColor(255, 255, 255), "norm", 128 },
+        { QRect(1, 0, 1, 1), QColor(255, 255, 255), "norm", 255, 128 },
+        { QRect(2, 0, 1, 1), QColor(255, 255, 255), "norm", 128, 128 },
+    });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(128, 128, 128)));
+    QVERIFY(fuzzyCompare(image.pixelColor(1, 0), QColor(128, 128, 128)));
+    // opacity and fill multiply
+    QVERIFY(fuzzyCompare(image.pixelColor(2, 0), QColor(64, 64, 64)));
+}
+
+void tst_QPsdCompositor::blendModes_data()
+{
+    QTest::addColumn<QByteArray>("mode");
+    QTest::addColumn<QColor>("expected");
+
+    // QColor(200, 100, 50) below QColor(100, 150, 250)
+    QTest::newRow("normal") << QByteArray("norm") << QColor(100, 150, 250);
+    QTest::newRow("darken") << QByteArray("dark") << QColor(100, 100, 50);
+    QTest::newRow("multiply") << QByteArray("mul ") << QColor(78, 59, 49);
+    QTest::newRow("colorBurn") << QByteArray("idiv") << QColor(115, 0, 46);
+    QTest::newRow("linearBurn") << QByteArray("lbrn") << QColor(45, 0, 45);
+    QTest::newRow("darkerColor") << QByteArray("dkCl") << QColor(200, 100, 50);
+    QTest::newRow("lighten") << QByteArray("lite") << QColor(200, 150, 250);
+    QTest::newRow("screen") << QByteArray("scrn") << QColor(222, 191, 251);
+    QTest::newRow("colorDodge") << QByteArray("div ") << QColor(255, 243, 255);
+    QTest::newRow("linearDodge") << QByteArray("lddg") << QColor(255, 250, 255);
+    QTest::newRow("lighterColor") << QByteArray("lgCl") << QColor(100, 150, 250);
+    QTest::newRow("overlay") << QByteArray("over") << QColor(188, 118, 98);
+    QTest::newRow("softLight") << QByteArray("sLit") << QColor(191, 111, 111);
+    QTest::newRow("hardLight") << QByteArray("hLit") << QColor(157, 127, 247);
+    QTest::newRow("vividLight") << QByteArray("vLit") << QColor(185, 121, 255);
+    QTest::newRow("linearLight") << QByteArray("lLit") << QColor(145, 145, 255);
+    QTest::newRow("pinLight") << QByteArray("pLit") << QColor(200, 100, 245);
+    QTest::newRow("hardMix") << QByteArray("hMix") << QColor(255, 0, 255);
+    QTest::newRow("difference") << QByteArray("diff") << QColor(100, 50, 200);
+    QTest::newRow("exclusion") << QByteArray("smud") << QColor(143, 132, 202);
+    QTest::newRow("subtract") << QByteArray("fsub") << QColor(100, 0, 0);
+    QTest::newRow("divide") << QByteArray("fdiv") << QColor(255, 170, 51);
+    QTest::newRow("hue") << QByteArray("hue ") << QColor(79, 129, 229);
+    QTest::newRow("color") << QByteArray("colr") << QColor(79, 129, 229);
+    QTest::newRow("luminosity") << QByteArray("lum ") << QColor(222, 122, 72);
+}
+
+void tst_QPsdCompositor::blendModes()
+{
+    QFETCH(QByteArray, mode);
+    QFETCH(QColor, expected);
+
+    const auto image = render(QSize(2, 1), {
+        { QRect(0, 0, 2, 1), QColor(200, 100, 50) },
+        { QRect(0, 0, 1, 1), QColor(100, 150, 250), mode },
+    });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), expected));
+    // nothing changes where the layer has no pixels
+    QVERIFY(fuzzyCompare(image.pixelColor(1, 0), QColor(200, 100, 50)));
+}
+
+void tst_QPsdCompositor::clipping()
+{
+    const QSize size(4, 1);
+    Layer clipped { QRect(0, 0, 4, 1), QColor(0, 0, 255) };
+    clipped.clipped = true;
+    const auto image = render(size, {
+        { QRect(0, 0, 4, 1), QColor(200, 0, 0) },
+        { QRect(0, 0, 2, 1), QColor(0, 255, 0) },
+        clipped,
+    });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(0, 0, 255)));
+    QVERIFY(fuzzyCompare(image.pixelColor(1, 0), QColor(0, 0, 255)));
+    QVERIFY(fuzzyCompare(image.pixelColor(2, 0), QColor(200, 0, 0)));
+
+    // the mode and opacity of the base apply to the clipped layers as well
+    Layer base { QRect(0, 0, 2, 1), QColor(0, 255, 0), "norm", 128 };
+    const auto faded = render(size, { { QRect(0, 0, 4, 1), QColor(0, 0, 0) }, base, clipped });
+    QVERIFY(fuzzyCompare(faded.pixelColor(0, 0), QColor(0, 0, 128)));
+    QVERIFY(fuzzyCompare(faded.pixelColor(3, 0), QColor(0, 0, 0)));
+
+    // hiding the base hides the clipped layers
+    base.hidden = true;
+    const auto hidden = render(size, { { QRect(0, 0, 4, 1), QColor(200, 0, 0) }, base, clipped });
+    QVERIFY(fuzzyCompare(hidden.pixelColor(0, 0), QColor(200, 0, 0)));
+}
+
+void tst_QPsdCompositor::groups()
+{
+    const QSize size(1, 1);
+    const Layer background { QRect(0, 0, 1, 1), QColor(200, 100, 50) };
+    const Layer multiply { QRect(0, 0, 1, 1), QColor(100, 150, 250), "mul " };
+    Layer divider;
+    divider.section = 3;
+    Layer folder;
+    folder.section = 1;
+
+    // children of a pass through group blend with what is below it
+    folder.mode = "pass";
+    auto image = render(size, { background, divider, multiply, folder });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(78, 59, 49)));
+
+    // an isolated group is flattened first, there is nothing to multiply with
+    folder.mode = "norm";
+    image = render(size, { background, divider, multiply, folder });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(100, 150, 250)));
+
+    // and then blends with its own mode
+    folder.mode = "mul ";
+    image = render(size, { background, divider, { QRect(0, 0, 1, 1), QColor(100, 150, 250) }, folder });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(78, 59, 49)));
+
+    // the opacity of a pass through group fades its children
+    folder.mode = "pass";
+    folder.opacity = 128;
+    image = render(size, { { QRect(0, 0, 1, 1), QColor(0, 0, 0) }, divider, { QRect(0, 0, 1, 1), QColor(255, 255, 255) }, folder });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(128, 128, 128)));
+
+    // hidden groups are left out with their children
+    folder.opacity = 255;
+    folder.hidden = true;
+    image = render(size, { background, divider, multiply, folder });
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(200, 100, 50)));
+}
+
+void tst_QPsdCompositor::layerMask()
+{
+    const QSize size(4, 1);
+    Layer masked { QRect(0, 0, 4, 1), QColor(255, 255, 255) };
+    masked.maskRect = QRect(1, 0, 2, 1);
+    masked.mask = QByteArray("\x00\x80", 2);
+    masked.maskDefault = 255;
+    const auto image = render(size, { { QRect(0, 0, 4, 1), QColor(0, 0, 0) }, masked });
+    // outside the mask rectangle the default color applies
+    QVERIFY(fuzzyCompare(image.pixelColor(0, 0), QColor(255, 255, 255)));
+    QVERIFY(fuzzyCompare(image.pixelColor(1, 0), QColor(0, 0, 0)));
+    QVERIFY(fuzzyCompare(image.pixelColor(2, 0), QColor(128, 128, 128)));
+    QVERIFY(fuzzyCompare(image.pixelColor(3, 0), QColor(255, 255, 255)));
+
+    masked.maskDefault = 0;
+    const auto hiddenOutside = render(size, { { QRect(0, 0, 4, 1), QColor(0, 0, 0) }, masked });
+    QVERIFY(fuzzyCompare(hiddenOutside.pixelColor(0, 0), QColor(0, 0, 0)));
+    QVERIFY(fuzzyCompare(hiddenOutside.pixelColor(2, 0), QColor(128, 128, 128)));
+}
+
+void tst_QPsdCompositor::tiles()
+{
+    // larger than a tile in both directions, with layers across tile boundaries
+    const QSize size(300, 200);
+    const QList<Layer> layers {
+        { QRect(0, 0, 300, 200), QColor(20, 40, 60) },
+        { QRect(50, 30, 200, 150), QColor(200, 100, 50, 160), "scrn" },
+        { QRect(120, 100, 170, 90), QColor(10, 200, 90, 200), "diss" },
+    };
+
+    const auto single = render(size, layers, 1);
+    QCOMPARE(single.size(), size);
+    QCOMPARE(render(size, layers, 4), single);
+
+    const QRect rect(100, 90, 150, 60);
+    QCOMPARE(render(size, layers, 4, rect), single.copy(rect));
+    // clipped to the document
+    QCOMPARE(render(size, layers, 4, QRect(250, 150, 100, 100)).size(), QSize(50, 50));
+}
+
+QTEST_MAIN(tst_QPsdCompositor)
+#include "tst_qpsdcompositor.moc"
@@ -0,0 +1,189 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtCore/QBuffer>
+#include <QtCore/QThread>
+#include <QtGui/QImage>
+#include <QtPsdGui/QPsdLinkedImageCache>
+#include <QtTest/QtTest>
+
+using namespace Qt::StringLiterals;
+
+class tst_QPsdLinkedImageCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanupTestCase();
+    void image();
+    void scaledImage();
+    void key();
+    void noUniqueId();
+    void invalidData();
+    void maxCost();
+    void threads();
+
+private:
+    static QPsdLinkedLayer::LinkedFile file(const QByteArray &uniqueId, const QSize &size, const QColor &color);
+
+    const qint64 defaultMaxCost = QPsdLinkedImageCache::maxCost();
+};
+
+QPsdLinkedLayer::LinkedFile tst_QPsdLinkedImageCache::file(const QByteArray &uniqueId, const QSize &size, const QColor &color)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(color);
+    QBuffer buffer;
+    buffer.open(QBuffer::WriteOnly);
+    image.save(&buffer, "PNG");
+
+    QPsdLinkedLayer::LinkedFile ret;
+    ret.uniqueId = uniqueId;
+    ret.name = QString::fromLatin1(uniqueId) + u".png"_s;
+    ret.type = "png ";
+    ret.data = buffer.data();
+    return ret;
+}
+
+void tst_QPsdLinkedImageCache::init()
+{
+    QPsdLinkedImageCache::clear();
+    QPsdLinkedImageCache::setMaxCost(defaultMaxCost);
+}
+
+void tst_QPsdLinkedImageCache::cleanupTestCase()
+{
+    QPsdLinkedImageCache::clear();
+}
+
+void tst_QPsdLinkedImageCache::image()
+{
+    const auto red = file("red", QSize(40, 30), Qt::red);
+    const QImage image = QPsdLinkedImageCache::image(red);
+    QCOMPARE(image.size(), QSize(40, 30));
+    QCOMPARE(image.pixelColor(10, 10), QColor(Qt::red));
+    QVERIFY(QPsdLinkedImageCache::totalCost() > 0);
+
+    // the second lookup shares the decoded image
+    const QImage cached = QPsdLinkedImageCache::image(red);
+    QCOMPARE(cached.cacheKey(), image.cacheKey());
+
+    // a file edited under the same unique id is decoded again
+    const auto edited = file("red", QSize(4, 4), Qt::blue);
+    const QImage editedImage = QPsdLinkedImageCache::image(edited);
+    QVERIFY(editedImage.cacheKey() != image.cacheKey());
+    QCOMPARE(editedImage.size(), QSize(4, 4));
+    QCOMPARE(editedImage.pixelColor(1, 1), QColor(Qt::blue));
+    QCOMPARE(QPsdLinkedImageCache::scaledImage(edited, QSize(2, 2)).pixelColor(1, 1), QColor(Qt::blue));
+    // and the same bytes still share the first image
+    QCOMPARE(QPsdLinkedImageCache::image(red).cacheKey(), image.cacheKey());
+
+    QPsdLinkedImageCache::clear();
+    QCOMPARE(QPsdLinkedImageCache::totalCost(), 0);
+    QVERIFY(QPsdLinkedImageCache::image(red).cacheKey() != image.cacheKey());
+}
+
+void tst_QPsdLinkedImageCache::scaledImage()
+{
+    const auto green = file("green", QSize(40, 20), Qt::green);
+    const QImage scaled = QPsdLinkedImageCache::scaledImage(green, QSize(20, 20));
+    QCOMPARE(scaled.size(), QSize(20, 10));
+    QCOMPARE(QPsdLinkedImageCache::scaledImage(green, QSize(20, 20)).cacheKey(), scaled.cacheKey());
+
+    const QImage ignored = QPsdLinkedImageCache::scaledImage(green, QSize(20, 20), Qt::IgnoreAspectRatio);
+    QCOMPARE(ignored.size(), QSize(20, 20));
+    QCOMPARE(QPsdLinkedImageCache::scaledImage(green, QSize(10, 10)).size(), QSize(10, 5));
+}
+
+void tst_QPsdLinkedImageCache::key()
+{
+    const auto red = file("red", QSize(40, 30), Qt::red);
+    const QByteArray key = QPsdLinkedImageCache::key(red);
+    QVERIFY(!key.isEmpty());
+    QCOMPARE(QPsdLinkedImageCache::key(file("red", QSize(40, 30), Qt::red)), key);
+    QVERIFY(QPsdLinkedImageCache::key(file("red", QSize(4, 4), Qt::blue)) != key);
+    QVERIFY(QPsdLinkedImageCache::key(file(QByteArray(), QSize(40, 30), Qt::red)).isEmpty());
+
+    // lookups with a precomputed key share the images of those without
+    const QImage image = QPsdLinkedImageCache::image(red, key);
+    QCOMPARE(QPsdLinkedImageCache::image(red).cacheKey(), image.cacheKey());
+    const QImage scaled = QPsdLinkedImageCache::scaledImage(red, key, QSize(20, 20));
+    QCOMPARE(scaled.size(), QSize(20, 15));
+    QCOMPARE(QPsdLinkedImageCache::scaledImage(red, QSize(20, 20)).cacheKey(), scaled.cacheKey());
+}
+
+void tst_QPsdLinkedImageCache::noUniqueId()
+{
+    const auto blue = file(QByteArray(), QSize(8, 8), Qt::blue);
+    QCOMPARE(QPsdLinkedImageCache::image(blue).size(), QSize(8, 8));
+    QCOMPARE(QPsdLinkedImageCache::scaledImage(blue, QSize(4, 4)).size(), QSize(4, 4));
+    QCOMPARE(QPsdLinkedImageCache::totalCost(), 0);
+}
+
+void tst_QPsdLinkedImageCache::invalidData()
+{
+    auto broken = file("broken", QSize(8, 8), Qt::black);
+    broken.data = "not an image";
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u".*"_s));
+    QVERIFY(QPsdLinkedImageCache::image(broken).isNull());
+    // the failure is remembered and does not warn again
+    QVERIFY(QPsdLinkedImageCache::image(broken).isNull());
+    QVERIFY(QPsdLinkedImageCache::scaledImage(broken, QSize(4, 4)).isNull());
+}
+
+void tst_QPsdLinkedImageCache::maxCost()
+{
+    // 100x100 ARGB32 is a little over 39 KiB
+    QPsdLinkedImageCache::setMaxCost(100 * 1024);
+    QCOMPARE(QPsdLinkedImageCache::maxCost(), 100 * 1024);
+
+    const auto a = file("a", QSize(100, 100), Qt::red);
+    const auto b = file("b", QSize(100, 100), Qt::green);
+    const auto c = file("c", QSize(100, 100), Qt::blue);
+    const qint64 keyA = QPsdLinkedImageCache::image(a).cacheKey();
+    const qint64 keyB = QPsdLinkedImageCache::image(b).cacheKey();
+    // a is used last, so b is dropped for c
+    QCOMPARE(QPsdLinkedImageCache::image(a).cacheKey(), keyA);
+    QPsdLinkedImageCache::image(c);
+    QVERIFY(QPsdLinkedImageCache::totalCost() <= QPsdLinkedImageCache::maxCost());
+    QCOMPARE(QPsdLinkedImageCache::image(a).cacheKey(), keyA);
+    QVERIFY(QPsdLinkedImageCache::image(b).cacheKey() != keyB);
+
+    QPsdLinkedImageCache::setMaxCost(0);
+    QCOMPARE(QPsdLinkedImageCache::totalCost(), 0);
+    QCOMPARE(QPsdLinkedImageCache::image(a).size(), QSize(100, 100));
+}
+
+void tst_QPsdLinkedImageCache::threads()
+{
+    QList<QPsdLinkedLayer::LinkedFile> files;
+    for (int i = 0; i < 8; i++)
+        files.append(file(QByteArray::number(i), QSize(32 + i, 32), QColor::fromHsv(i * 40, 255, 255)));
+
+    QAtomicInt failures;
+    QList<QThread *> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.append(QThread::create([&files, &failures, t]() {
+            for (int i = 0; i < 200; i++) {
+                const auto &file = files.at((i + t) % files.size());
+                const QImage image = QPsdLinkedImageCache::image(file);
+                const QImage scaled = QPsdLinkedImageCache::scaledImage(file, QSize(16, 16), Qt::IgnoreAspectRatio);
+                if (image.width() != 32 + (i + t) % files.size() || scaled.size() != QSize(16, 16))
+                    failures.ref();
+                if (i % 50 == 0)
+                    QPsdLinkedImageCache::setMaxCost(i % 100 == 0 ? 16 * 1024 : 1024 * 1024);
+            }
+        }));
+    }
+    for (auto *thread : threads)
+        thread->start();
+    for (auto *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    QCOMPARE(failures.loadRelaxed(), 0);
+}
+
+QTEST_MAIN(tst_QPsdLinkedImageCache)
+#include "tst_qpsdlinkedimagecache.moc"
@@ -18,6 +18,8 @@
 #include <cmath>
 #include <tuple>
 
+#include "psdwriter.h"
+
 class tst_QPsdView : public QObject
 {
     Q_OBJECT
@@ -25,6 +27,8 @@ private slots:
     void initTestCase();
     void compareRendering_data();
     void compareRendering();
+    void setItemVisible();
+    void clipping();
     void cleanupTestCase();
 
 private:
@@ -632,6 +636,93 @@ void tst_QPsdView::compareRendering()
     }
 }
 
+void tst_QPsdView::setItemVisible()
+{
+    const QString psd = QFINDTESTDATA("../../psdcore/qpsdlayertreeitemmodel/data/nested_layers.psd");
+    QVERIFY(!psd.isEmpty());
+
+    QPsdParser parser;
+    parser.load(psd);
+    QPsdWidgetTreeItemModel model;
+    model.fromParser(parser);
+    QPsdView view;
+    view.setModel(&model);
+    view.setShowChecker(false);
+
+    auto render = [&]() {
+        QImage image(model.size(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        view.render(&painter);
+        return image;
+    };
+
+    const QPsdAbstractLayerItem *layer = nullptr;
+    for (int row = 0; row < model.rowCount() && !layer; row++) {
+        const auto *item = model.layerItem(model.index(row, 0));
+        if (item->type() != QPsdAbstractLayerItem::Folder && item->isVisible() && !item->rect().isEmpty())
+            layer = item;
+    }
+    if (!layer)
+        QSKIP("No visible toplevel layer");
+
+    const QImage before = render();
+    // tiles are rendered once and reused
+    QCOMPARE(render(), before);
+
+    view.setItemVisible(layer->id(), false);
+    const QImage hidden = render();
+
+    // pixels outside the layer are left as they were
+    auto outside = [&](QImage image) {
+        QPainter painter(&image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(layer->rect(), Qt::transparent);
+        painter.end();
+        return image;
+    };
+    QCOMPARE(outside(hidden), outside(before));
+
+    view.setItemVisible(layer->id(), true);
+    QCOMPARE(render(), before);
+}
+
+void tst_QPsdView::clipping()
+{
+    // a blue layer clipped to a smaller red one
+    const QSize size(6, 5);
+    const QRect base(1, 1, 4, 3);
+    QTemporaryFile psd;
+    QVERIFY(psd.open());
+    psd.write(PsdWriter::document(size, {
+        { base, QColor(255, 0, 0) },
+        { QRect(QPoint(0, 0), size), QColor(0, 0, 255), "norm", 255, -1, true },
+    }));
+    psd.close();
+
+    QPsdParser parser;
+    parser.load(psd.fileName());
+    QPsdWidgetTreeItemModel model;
+    model.fromParser(parser);
+    QPsdView view;
+    view.setModel(&model);
+    view.setShowChecker(false);
+    view.resize(size);
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    view.render(&painter);
+    painter.end();
+
+    // the same as when the mask was a region, the clipped layer covers the
+    // opaque layer below it and nothing outside of it
+    for (int y = 0; y < size.height(); y++) {
+        for (int x = 0; x < size.width(); x++)
+            QCOMPARE(image.pixelColor(x, y), base.contains(x, y) ? QColor(0, 0, 255) : QColor(Qt::transparent));
+    }
+}
+
 void tst_QPsdView::cleanupTestCase()
 {
     if (!m_generateSummary || m_similarityResults.isEmpty()) {
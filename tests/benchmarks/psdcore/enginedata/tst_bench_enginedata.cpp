@@ -0,0 +1,181 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtTest/QTest>
+#include <QtCore/QCborArray>
+#include <QtCore/QCborMap>
+
+#include <QtPsdCore/qpsdenginedatadocument.h>
+#include <QtPsdCore/qpsdenginedataparser.h>
+#include <QtPsdCore/qpsdenginedatatokenizer.h>
+
+class tst_Bench_EngineData : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void tokenize();
+    void textLayer_data();
+    void textLayer();
+
+private:
+    static QByteArray string(QStringView text);
+    static QByteArray styleSheetData(int seed);
+
+    QByteArray m_engineData;
+};
+
+// a UTF-16 string the way Photoshop writes them
+QByteArray tst_Bench_EngineData::string(QStringView text)
+{
+    QByteArray ret("(\xFE\xFF");
+    for (const QChar ch : text) {
+        const char bytes[] = { char(ch.unicode() >> 8), char(ch.unicode() & 0xff) };
+        for (const char byte : bytes) {
+            if (byte == '(' || byte == ')' || byte == '\\')
+                ret.append('\\');
+            ret.append(byte);
+        }
+    }
+    ret.append(')');
+    return ret;
+}
+
+QByteArray tst_Bench_EngineData::styleSheetData(int seed)
+{
+    return "<< /Font " + QByteArray::number(seed % 8)
+           + " /FontSize " + QByteArray::number(12.0 + seed % 5, 'f', 1)
+           + " /FauxBold false /FauxItalic false /AutoLeading true /Leading 0.0"
+             " /HorizontalScale 1.0 /VerticalScale 1.0 /Tracking " + QByteArray::number(seed % 50)
+           + " /BaselineShift 0.0 /AutoKerning true /FontCaps 0 /FontBaseline 0 /Underline false"
+             " /Strikethrough false /Ligatures true /DLigatures false /BaselineDirection 2"
+             " /Tsume 0.0 /StyleRunAlignment 2 /Language 14 /NoBreak false"
+             " /FillColor << /Type 1 /Values [ 1.0 0.0 0.0 0.0 ] >>"
+             " /StrokeColor << /Type 1 /Values [ 1.0 0.0 0.0 0.0 ] >>"
+             " /FillFlag true /StrokeFlag false /FillFirst true /YUnderline 1 /OutlineWidth 1.0"
+             " /CharacterDirection 0 /HindiNumbers false /Kashida 1 /DiacriticPos 2 >>\n";
+}
+
+void tst_Bench_EngineData::initTestCase()
+{
+    // a paragraph of text with many style runs, and the resources Photoshop
+    // writes with every text layer, which are most of the data
+    constexpr int Runs = 64;
+    QString text;
+    for (int i = 0; i < Runs; i++)
+        text += u"Lorem ipsum dolor sit amet, consectetur adipiscing elit "_s;
+
+    QByteArray runArray;
+    QByteArray runLengthArray;
+    for (int i = 0; i < Runs; i++) {
+        runArray += "<< /StyleSheet << /StyleSheetData " + styleSheetData(i) + " >> >>\n";
+        runLengthArray += ' ' + QByteArray::number(text.size() / Runs);
+    }
+
+    QByteArray fontSet;
+    for (int i = 0; i < 8; i++)
+        fontSet += "<< /Name " + string(u"SourceHanSans-Regular%1"_s.arg(i)) + " /Script 0 /FontType 1 /Synthetic 0 >>\n";
+
+    QString kinsoku;
+    for (int i = 0; i < 256; i++)
+        kinsoku += QChar(0x3000 + i);
+    QByteArray kinsokuSet;
+    for (int i = 0; i < 4; i++) {
+        kinsokuSet += "<< /Name " + string(u"Kinsoku %1"_s.arg(i)) + " /NoStart " + string(kinsoku)
+                      + " /NoEnd " + string(kinsoku) + " /Keep " + string(kinsoku)
+                      + " /Hanging " + string(kinsoku) + " >>\n";
+    }
+
+    QByteArray mojiKumiTable;
+    for (int i = 0; i < 256; i++)
+        mojiKumiTable += " [ " + QByteArray::number(i % 3) + ".0 0.5 1.0 ]";
+    QByteArray mojiKumiSet;
+    for (int i = 0; i < 4; i++)
+        mojiKumiSet += "<< /InternalName " + string(u"Photoshop6MojiKumiSet%1"_s.arg(i)) + " /Table [" + mojiKumiTable + " ] >>\n";
+
+    QByteArray styleSheetSet;
+    for (int i = 0; i < 8; i++)
+        styleSheetSet += "<< /Name " + string(u"Normal RGB %1"_s.arg(i)) + " /StyleSheetData " + styleSheetData(i) + " >>\n";
+
+    const QByteArray resources =
+        "<< /KinsokuSet [ " + kinsokuSet + " ] /MojiKumiSet [ " + mojiKumiSet + " ]"
+        " /TheNormalStyleSheet 0 /TheNormalParagraphSheet 0"
+        " /ParagraphSheetSet [ << /Name " + string(u"Normal RGB") + " /DefaultStyleSheet 0"
+        " /Properties << /Justification 0 /FirstLineIndent 0.0 /StartIndent 0.0 /EndIndent 0.0 >> >> ]"
+        " /StyleSheetSet [ " + styleSheetSet + " ] /FontSet [ " + fontSet + " ]"
+        " /SuperscriptSize 0.583 /SuperscriptPosition 0.333 /SubscriptSize 0.583 /SubscriptPosition 0.333"
+        " /SmallCapSize 0.7 >>\n";
+
+    m_engineData =
+        "<<\n/EngineDict <<\n"
+        "/Editor << /Text " + string(text) + " >>\n"
+        "/ParagraphRun << /RunArray [ << /ParagraphSheet << /DefaultStyleSheet 0"
+        " /Properties << /Justification 2 >> >> /Adjustments << /Axis [ 1.0 0.0 1.0 ] /XY [ 0.0 0.0 ] >> >> ]"
+        " /RunLengthArray [ " + QByteArray::number(text.size()) + " ] /IsJoinable 1 >>\n"
+        "/StyleRun << /RunArray [ " + runArray + " ] /RunLengthArray [" + runLengthArray + " ] /IsJoinable 2 >>\n"
+        "/AntiAlias 4 /UseFractionalGlyphWidths true\n"
+        "/Rendered << /Version 1 /Shapes << /WritingDirection 0 /Children [ << /ShapeType 1 /Procession 0"
+        " /Lines << /WritingDirection 0 /Children [ ] >> /Cookie << /Photoshop << /ShapeType 1"
+        " /BoxBounds [ 0.0 0.0 400.0 300.0 ] /Base << /ShapeType 1 /TransformPoint0 [ 1.0 0.0 ]"
+        " /TransformPoint1 [ 0.0 1.0 ] /TransformPoint2 [ 0.0 0.0 ] >> >> >> >> ] >> >>\n"
+        ">>\n"
+        "/ResourceDict " + resources
+        + "/DocumentResources " + resources
+        + ">>\n";
+
+    QPsdEngineDataParser::ParseError error;
+    const auto engineData = QPsdEngineDataParser::parseEngineData(m_engineData, &error);
+    QVERIFY2(!error, qPrintable(error.errorMessage));
+    QCOMPARE(engineData.value("EngineDict"_L1).toMap().value("StyleRun"_L1).toMap().value("RunArray"_L1).toArray().size(), Runs);
+}
+
+void tst_Bench_EngineData::tokenize()
+{
+    // the tokenizer alone, the lower bound of any lookup
+    qsizetype tokens = 0;
+    QBENCHMARK {
+        QPsdEngineDataTokenizer tokenizer(m_engineData);
+        while (tokenizer.next().type > QPsdEngineDataTokenizer::End)
+            tokens++;
+    }
+    QVERIFY(tokens > 0);
+}
+
+void tst_Bench_EngineData::textLayer_data()
+{
+    QTest::addColumn<bool>("lazy");
+
+    QTest::newRow("parseEngineData") << false;
+    QTest::newRow("QPsdEngineDataDocument") << true;
+}
+
+void tst_Bench_EngineData::textLayer()
+{
+    QFETCH(bool, lazy);
+
+    // what QPsdTextLayerItem reads of every text layer
+    QCborArray fontSet;
+    QCborArray styleSheetSet;
+    QCborMap engineDict;
+    QBENCHMARK {
+        if (lazy) {
+            const QPsdEngineDataDocument engineData(m_engineData);
+            fontSet = engineData.value(u"DocumentResources/FontSet").toArray();
+            styleSheetSet = engineData.value(u"DocumentResources/StyleSheetSet").toArray();
+            engineDict = engineData.value(u"EngineDict").toMap();
+        } else {
+            const auto engineData = QPsdEngineDataParser::parseEngineData(m_engineData);
+            const auto documentResources = engineData.value("DocumentResources"_L1).toMap();
+            fontSet = documentResources.value("FontSet"_L1).toArray();
+            styleSheetSet = documentResources.value("StyleSheetSet"_L1).toArray();
+            engineDict = engineData.value("EngineDict"_L1).toMap();
+        }
+    }
+    QCOMPARE(fontSet.size(), 8);
+    QCOMPARE(styleSheetSet.size(), 8);
+    QVERIFY(engineDict.contains("Rendered"_L1));
+}
+
+QTEST_MAIN(tst_Bench_EngineData)
+#include "tst_bench_enginedata.moc"
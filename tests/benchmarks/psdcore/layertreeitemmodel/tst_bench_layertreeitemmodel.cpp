@@ -0,0 +1,129 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtTest/QTest>
+#include <QtCore/QTemporaryFile>
+
+#include <QtPsdCore/QPsdLayerTreeItemModel>
+#include <QtPsdCore/QPsdParser>
+
+#include "psdwriter.h"
+
+class tst_Bench_LayerTreeItemModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void walk();
+    void fromParser();
+
+private:
+    QTemporaryFile m_psd;
+    int m_layerCount = 0;
+};
+
+// a 1x1 RGB document of groups of layers without pixels, each holding a nested
+// group, 20 layer records per group counting the folders and their dividers
+void tst_Bench_LayerTreeItemModel::initTestCase()
+{
+    constexpr int groups = 500;
+
+    using namespace PsdWriter;
+
+    // records are stored bottom up, a divider comes before the contents of its folder
+    enum { Layer = 0, OpenFolder = 1, Divider = 3 };
+    QByteArray records;
+    auto record = [&](int type) {
+        for (int i = 0; i < 4; i++)
+            u32(&records, 0);
+        u16(&records, 0);
+        records.append("8BIMnorm");
+        records.append("\xff\x00\x00\x00", 4);
+        u32(&records, 28);
+        u32(&records, 0);
+        u32(&records, 0);
+        records.append("\x01" "a\x00\x00", 4);
+        records.append("8BIMlsct");
+        u32(&records, 4);
+        u32(&records, type);
+        m_layerCount++;
+    };
+    for (int g = 0; g < groups; g++) {
+        record(Divider);
+        for (int i = 0; i < 8; i++)
+            record(Layer);
+        record(Divider);
+        for (int i = 0; i < 8; i++)
+            record(Layer);
+        record(OpenFolder);
+        record(OpenFolder);
+    }
+
+    QByteArray layerInfo;
+    u16(&layerInfo, m_layerCount);
+    layerInfo.append(records);
+    if (layerInfo.size() % 2)
+        layerInfo.append('\0');
+
+    QByteArray layerAndMask;
+    u32(&layerAndMask, layerInfo.size());
+    layerAndMask.append(layerInfo);
+    u32(&layerAndMask, 0);
+
+    QByteArray file = fileHeader(3, 1, 1, 8, QPsdFileHeader::RGB);
+    u32(&file, 0);
+    u32(&file, 0);
+    u32(&file, layerAndMask.size());
+    file.append(layerAndMask);
+    u16(&file, 0);
+    file.append(3, '\0');
+
+    QVERIFY(m_psd.open());
+    m_psd.write(file);
+    m_psd.close();
+}
+
+// visits every index the way views and exporters do
+void tst_Bench_LayerTreeItemModel::walk()
+{
+    QPsdParser parser;
+    parser.load(m_psd.fileName());
+    QPsdLayerTreeItemModel model;
+    model.fromParser(parser);
+
+    int visited = 0;
+    std::function<void(const QModelIndex &)> visit = [&](const QModelIndex &parent) {
+        const int rows = model.rowCount(parent);
+        for (int row = 0; row < rows; row++) {
+            const auto index = model.index(row, 0, parent);
+            if (model.parent(index) != parent)
+                return;
+            visited++;
+            visit(index);
+        }
+    };
+
+    visit(QModelIndex());
+    // every record but the dividers is a row
+    QCOMPARE(visited, m_layerCount / 10 * 9);
+
+    QBENCHMARK {
+        visit(QModelIndex());
+    }
+}
+
+void tst_Bench_LayerTreeItemModel::fromParser()
+{
+    QPsdParser parser;
+    parser.load(m_psd.fileName());
+    QPsdLayerTreeItemModel model;
+
+    QBENCHMARK {
+        model.fromParser(parser);
+    }
+    QCOMPARE(model.rowCount(), m_layerCount / 20);
+}
+
+QTEST_MAIN(tst_Bench_LayerTreeItemModel)
+#include "tst_bench_layertreeitemmodel.moc"
@@ -0,0 +1,151 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtTest/QTest>
+#include <QtCore/QBuffer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtEndian>
+
+#include <QtPsdCore/qpsdabstractimage.h>
+
+class RleCodec : public QPsdAbstractImage
+{
+public:
+    using QPsdAbstractImage::readRLE;
+    using QPsdAbstractImage::decodeRLE;
+
+    // readRLE() as it was before decodeRLE(), for comparison
+    static QByteArray legacyReadRLE(QIODevice *source, int height, quint32 *length)
+    {
+        QByteArray ret;
+        QList<qint16> byteCounts;
+        for (int y = 0; y < height; y++) {
+            byteCounts.append(readS16(source, length));
+        }
+        for (qint16 byteCount : byteCounts) {
+            EnsureSeek es(source, byteCount);
+            while (es.bytesAvailable() > 0) {
+                auto size = readS8(source, length);
+                if (size == -128) {
+                } else if (size < 0) {
+                    ret.append(-size + 1, readByteArray(source, 1, length).at(0));
+                } else if (size >= 0) {
+                    ret.append(readByteArray(source, size + 1, length));
+                }
+            }
+        }
+        return ret;
+    }
+};
+
+class tst_Bench_Rle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void decode_data();
+    void decode();
+
+private:
+    static QByteArray packBits(QByteArrayView line);
+
+    static constexpr int Width = 4096;
+    static constexpr int Height = 4096;
+    QByteArray m_image;
+    QByteArray m_compressed;
+};
+
+QByteArray tst_Bench_Rle::packBits(QByteArrayView line)
+{
+    QByteArray ret;
+    qsizetype i = 0;
+    while (i < line.size()) {
+        qsizetype run = 1;
+        while (i + run < line.size() && run < 128 && line.at(i + run) == line.at(i))
+            run++;
+        if (run > 1) {
+            ret.append(char(1 - run));
+            ret.append(line.at(i));
+            i += run;
+            continue;
+        }
+        qsizetype literal = 1;
+        while (i + literal < line.size() && literal < 128
+               && (i + literal + 1 >= line.size() || line.at(i + literal) != line.at(i + literal + 1)))
+            literal++;
+        ret.append(char(literal - 1));
+        ret.append(line.sliced(i, literal));
+        i += literal;
+    }
+    return ret;
+}
+
+void tst_Bench_Rle::initTestCase()
+{
+    // flat areas with noisy edges, roughly what a layer with a few shapes compresses like
+    QRandomGenerator random(42);
+    m_image.resize(Width * Height);
+    for (int y = 0; y < Height; y++) {
+        char *line = m_image.data() + y * Width;
+        for (int x = 0; x < Width; x++) {
+            const bool flat = ((x / 256) + (y / 256)) % 2 == 0;
+            line[x] = flat ? char(y / 16) : char(random.bounded(256));
+        }
+    }
+
+    QByteArray byteCounts;
+    QByteArray lines;
+    for (int y = 0; y < Height; y++) {
+        const auto line = packBits(QByteArrayView(m_image).sliced(y * Width, Width));
+        const auto count = qToBigEndian<quint16>(line.size());
+        byteCounts.append(reinterpret_cast<const char *>(&count), sizeof(count));
+        lines.append(line);
+    }
+    m_compressed = byteCounts + lines;
+}
+
+void tst_Bench_Rle::decode_data()
+{
+    QTest::addColumn<QString>("method");
+
+    QTest::newRow("legacy readRLE") << u"legacy"_s;
+    QTest::newRow("readRLE") << u"readRLE"_s;
+    QTest::newRow("decodeRLE") << u"decodeRLE"_s;
+    QTest::newRow("decodeRLE threaded") << u"threaded"_s;
+}
+
+void tst_Bench_Rle::decode()
+{
+    QFETCH(QString, method);
+
+    auto run = [&]() -> QByteArray {
+        if (method == "threaded"_L1)
+            return RleCodec::decodeRLE(m_compressed, Height, Width, QThreadPool::globalInstance());
+        if (method == "decodeRLE"_L1)
+            return RleCodec::decodeRLE(m_compressed, Height, Width);
+
+        QBuffer buffer(&m_compressed);
+        buffer.open(QIODevice::ReadOnly);
+        quint32 length = m_compressed.size();
+        if (method == "legacy"_L1)
+            return RleCodec::legacyReadRLE(&buffer, Height, &length);
+        return RleCodec::readRLE(&buffer, Height, &length);
+    };
+
+    QCOMPARE(run(), m_image);
+
+    // report the decoded throughput rather than the time per iteration
+    constexpr int iterations = 10;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++)
+        run();
+    const auto seconds = timer.nsecsElapsed() / 1e9;
+    QTest::setBenchmarkResult(m_image.size() * iterations / seconds, QTest::BytesPerSecond);
+}
+
+QTEST_MAIN(tst_Bench_Rle)
+#include "tst_bench_rle.moc"
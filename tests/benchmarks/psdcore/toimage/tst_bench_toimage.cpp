@@ -0,0 +1,134 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <QtTest/QTest>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRandomGenerator>
+
+#include <QtPsdCore/qpsdabstractimage.h>
+
+#include "psdwriter.h"
+
+// planar image data held in memory, laid out like a layer's channels
+class PlanarImage : public QPsdAbstractImage
+{
+public:
+    PlanarImage(QPsdFileHeader::ColorMode colorMode, int depth, int channels, bool alpha, int width, int height)
+        : m_alpha(alpha)
+    {
+        setHeader(PsdWriter::readFileHeader(PsdWriter::fileHeader(channels, width, height, depth, colorMode)));
+        setWidth(width);
+        setHeight(height);
+        setOpacity(0xc0);
+
+        m_planeSize = qsizetype(width) * height * depth / 8;
+        m_data.resize(m_planeSize * (channels + (alpha ? 1 : 0)));
+        QRandomGenerator random(42);
+        random.fillRange(reinterpret_cast<quint32 *>(m_data.data()), m_data.size() / sizeof(quint32));
+    }
+
+    QByteArray imageData() const override { return m_data.left(m_planeSize); }
+    bool hasAlpha() const override { return m_alpha; }
+
+protected:
+    const unsigned char *plane(int index) const {
+        return reinterpret_cast<const unsigned char *>(m_data.constData()) + m_planeSize * index;
+    }
+    const unsigned char *gray() const override { return plane(0); }
+    const unsigned char *r() const override { return plane(0); }
+    const unsigned char *g() const override { return plane(1); }
+    const unsigned char *b() const override { return plane(2); }
+    const unsigned char *a() const override { return m_alpha ? plane(3) : nullptr; }
+    const unsigned char *c() const override { return plane(0); }
+    const unsigned char *m() const override { return plane(1); }
+    const unsigned char *y() const override { return plane(2); }
+    const unsigned char *k() const override { return plane(3); }
+
+private:
+    QByteArray m_data;
+    qsizetype m_planeSize = 0;
+    bool m_alpha = false;
+};
+
+class tst_Bench_ToImage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toImage_data();
+    void toImage();
+    void toImageInto_data() { toImage_data(); }
+    void toImageInto();
+};
+
+void tst_Bench_ToImage::toImage_data()
+{
+    QTest::addColumn<int>("colorMode");
+    QTest::addColumn<int>("depth");
+    QTest::addColumn<int>("channels");
+    QTest::addColumn<bool>("alpha");
+
+    QTest::newRow("RGB 8") << int(QPsdFileHeader::RGB) << 8 << 3 << false;
+    QTest::newRow("RGBA 8") << int(QPsdFileHeader::RGB) << 8 << 3 << true;
+    QTest::newRow("RGB 16") << int(QPsdFileHeader::RGB) << 16 << 3 << false;
+    QTest::newRow("RGBA 16") << int(QPsdFileHeader::RGB) << 16 << 3 << true;
+    QTest::newRow("RGB 32") << int(QPsdFileHeader::RGB) << 32 << 3 << false;
+    QTest::newRow("RGBA 32") << int(QPsdFileHeader::RGB) << 32 << 3 << true;
+    QTest::newRow("CMYK 8") << int(QPsdFileHeader::CMYK) << 8 << 4 << false;
+    QTest::newRow("CMYK 16") << int(QPsdFileHeader::CMYK) << 16 << 4 << false;
+    QTest::newRow("Lab 8") << int(QPsdFileHeader::Lab) << 8 << 3 << false;
+    QTest::newRow("Lab 16") << int(QPsdFileHeader::Lab) << 16 << 3 << false;
+    QTest::newRow("Multichannel 8") << int(QPsdFileHeader::Multichannel) << 8 << 1 << false;
+    QTest::newRow("Multichannel 16") << int(QPsdFileHeader::Multichannel) << 16 << 1 << false;
+}
+
+void tst_Bench_ToImage::toImage()
+{
+    QFETCH(int, colorMode);
+    QFETCH(int, depth);
+    QFETCH(int, channels);
+    QFETCH(bool, alpha);
+
+    constexpr int width = 2048;
+    constexpr int height = 2048;
+    const PlanarImage image(QPsdFileHeader::ColorMode(colorMode), depth, channels, alpha, width, height);
+    QVERIFY(!image.toImage(QPsdFileHeader::ColorMode(colorMode)).isEmpty());
+
+    // report megapixels per second, as events, rather than the time per iteration
+    constexpr int iterations = 5;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++)
+        image.toImage(QPsdFileHeader::ColorMode(colorMode));
+    const auto seconds = timer.nsecsElapsed() / 1e9;
+    QTest::setBenchmarkResult(width * height / 1e6 * iterations / seconds, QTest::Events);
+}
+
+void tst_Bench_ToImage::toImageInto()
+{
+    QFETCH(int, colorMode);
+    QFETCH(int, depth);
+    QFETCH(int, channels);
+    QFETCH(bool, alpha);
+
+    constexpr int width = 2048;
+    constexpr int height = 2048;
+    const PlanarImage image(QPsdFileHeader::ColorMode(colorMode), depth, channels, alpha, width, height);
+    // padded to 4 bytes like the scan lines of a QImage
+    const auto lineSize = image.toImageBytesPerLine(QPsdFileHeader::ColorMode(colorMode));
+    const qsizetype bytesPerLine = (lineSize + 3) & ~3;
+    QByteArray bits(bytesPerLine * height, Qt::Uninitialized);
+    auto *dst = reinterpret_cast<uchar *>(bits.data());
+    QVERIFY(image.toImage(QPsdFileHeader::ColorMode(colorMode), dst, bytesPerLine));
+
+    constexpr int iterations = 5;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++)
+        image.toImage(QPsdFileHeader::ColorMode(colorMode), dst, bytesPerLine);
+    const auto seconds = timer.nsecsElapsed() / 1e9;
+    QTest::setBenchmarkResult(width * height / 1e6 * iterations / seconds, QTest::Events);
+}
+
+QTEST_MAIN(tst_Bench_ToImage)
+#include "tst_bench_toimage.moc"
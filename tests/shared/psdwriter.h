@@ -0,0 +1,179 @@
+// Copyright (C) 2025 Signal Slot Inc.
+// SPDX-License-Identifier: LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef PSDWRITER_H
+#define PSDWRITER_H
+
+#include <QtCore/QBuffer>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QRect>
+#include <QtCore/QtEndian>
+#include <QtGui/QColor>
+#include <QtPsdCore/QPsdFileHeader>
+
+// writes the big-endian structures of PSD and PSB files for tests that build
+// their documents in memory
+namespace PsdWriter {
+
+inline void u8(QByteArray *data, quint8 value)
+{
+    data->append(char(value));
+}
+
+template <typename T>
+inline void bigEndian(QByteArray *data, T value)
+{
+    const auto be = qToBigEndian(value);
+    data->append(reinterpret_cast<const char *>(&be), sizeof(be));
+}
+
+inline void u16(QByteArray *data, quint16 value) { bigEndian(data, value); }
+inline void u32(QByteArray *data, quint32 value) { bigEndian(data, value); }
+inline void u64(QByteArray *data, quint64 value) { bigEndian(data, value); }
+
+// the file header section, version 2 for PSB
+inline QByteArray fileHeader(int channels, int width, int height, int depth, QPsdFileHeader::ColorMode colorMode, bool psb = false)
+{
+    QByteArray ret("8BPS");
+    u16(&ret, psb ? 2 : 1);
+    ret.append(6, '\0');
+    u16(&ret, channels);
+    u32(&ret, height);
+    u32(&ret, width);
+    u16(&ret, depth);
+    u16(&ret, colorMode);
+    return ret;
+}
+
+// the parsed file header, for images set up in memory
+inline QPsdFileHeader readFileHeader(QByteArray data)
+{
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    return QPsdFileHeader(&buffer);
+}
+
+// a layer of a single color, alpha goes to the transparency channel
+struct Layer
+{
+    QRect rect;
+    QColor color;
+    QByteArray mode = "norm";
+    quint8 opacity = 255;
+    int fill = -1;
+    bool clipped = false;
+    bool hidden = false;
+    // lsct type, 1 = open folder, 3 = section divider
+    int section = 0;
+    // user supplied layer mask, one byte per pixel of maskRect
+    QRect maskRect;
+    QByteArray mask;
+    quint8 maskDefault = 255;
+    QByteArray name = "a";
+    // lyid, none if 0
+    quint32 id = 0;
+};
+
+// an 8-bit RGB document of layers, listed bottom up as they are stored
+inline QByteArray document(const QSize &size, const QList<Layer> &layers)
+{
+    auto rect = [&](QByteArray *data, const QRect &r) {
+        u32(data, r.top());
+        u32(data, r.left());
+        u32(data, r.top() + r.height());
+        u32(data, r.left() + r.width());
+    };
+
+    QByteArray records;
+    QByteArray channels;
+    for (const auto &layer : layers) {
+        const qsizetype pixels = qsizetype(layer.rect.width()) * layer.rect.height();
+        QList<QPair<qint16, QByteArray>> planes;
+        if (pixels > 0) {
+            planes.append({ -1, QByteArray(pixels, char(layer.color.alpha())) });
+            planes.append({ 0, QByteArray(pixels, char(layer.color.red())) });
+            planes.append({ 1, QByteArray(pixels, char(layer.color.green())) });
+            planes.append({ 2, QByteArray(pixels, char(layer.color.blue())) });
+        }
+        if (!layer.mask.isEmpty())
+            planes.append({ -2, layer.mask });
+
+        rect(&records, layer.rect);
+        u16(&records, planes.size());
+        for (const auto &plane : planes) {
+            u16(&records, quint16(plane.first));
+            u32(&records, 2 + plane.second.size());
+            u16(&channels, 0);
+            channels.append(plane.second);
+        }
+        records.append("8BIM");
+        records.append(layer.mode);
+        u8(&records, layer.opacity);
+        u8(&records, layer.clipped ? 1 : 0);
+        // bit 1 hides the layer
+        u8(&records, layer.hidden ? 0x02 : 0);
+        u8(&records, 0);
+
+        QByteArray extra;
+        if (layer.mask.isEmpty()) {
+            u32(&extra, 0);
+        } else {
+            u32(&extra, 20);
+            rect(&extra, layer.maskRect);
+            u8(&extra, layer.maskDefault);
+            u8(&extra, 0);
+            u16(&extra, 0);
+        }
+        u32(&extra, 0);
+        // Pascal string padded to a multiple of 4 bytes
+        QByteArray name = char(layer.name.size()) + layer.name;
+        name.append((4 - name.size() % 4) % 4, '\0');
+        extra.append(name);
+        if (layer.id) {
+            extra.append("8BIMlyid");
+            u32(&extra, 4);
+            u32(&extra, layer.id);
+        }
+        if (layer.section) {
+            extra.append("8BIMlsct");
+            u32(&extra, 12);
+            u32(&extra, layer.section);
+            extra.append("8BIM");
+            extra.append(layer.mode);
+        }
+        if (layer.fill >= 0) {
+            extra.append("8BIMiOpa");
+            u32(&extra, 4);
+            u8(&extra, layer.fill);
+            extra.append(3, '\0');
+        }
+        u32(&records, extra.size());
+        records.append(extra);
+    }
+
+    QByteArray layerInfo;
+    u16(&layerInfo, layers.size());
+    layerInfo.append(records);
+    layerInfo.append(channels);
+    if (layerInfo.size() % 2)
+        layerInfo.append('\0');
+
+    QByteArray layerAndMask;
+    u32(&layerAndMask, layerInfo.size());
+    layerAndMask.append(layerInfo);
+    u32(&layerAndMask, 0);
+
+    QByteArray file = fileHeader(3, size.width(), size.height(), 8, QPsdFileHeader::RGB);
+    u32(&file, 0);
+    u32(&file, 0);
+    u32(&file, layerAndMask.size());
+    file.append(layerAndMask);
+    u16(&file, 0);
+    file.append(qsizetype(size.width()) * size.height() * 3, '\0');
+    return file;
+}
+
+} // namespace PsdWriter
+
+#endif // PSDWRITER_H